@@ -196,17 +196,108 @@ class VerifyingKey(BaseVerifier, _VerifyingKeyStruct):
             (neg(self.alpha), self.beta))
 
 
+def _int_bytes(x):
+    """Encode an integer as 32 bytes big-endian"""
+    return unhexlify('%064x' % (x,))
+
+
+def _proof_bytes(proof):
+    """Encode a proof as the native library expects, see `src/ethsnarks_verify.h`"""
+    A, B, C = proof.A, proof.B, proof.C
+    coords = [A[0].n, A[1].n,
+              B[0].coeffs[1].n, B[0].coeffs[0].n,
+              B[1].coeffs[1].n, B[1].coeffs[0].n,
+              C[0].n, C[1].n]
+    return b''.join(_int_bytes(_) for _ in coords)
+
+
+def _inputs_bytes(proof):
+    return b''.join(_int_bytes(_) for _ in proof.input)
+
+
+_NATIVE_LIBRARIES = dict()
+
+
+def _load_native_library(native_library_path):
+    """Load the native library once, declaring the types of its functions"""
+    lib = _NATIVE_LIBRARIES.get(native_library_path)
+    if lib is not None:
+        return lib
+
+    lib = ctypes.cdll.LoadLibrary(native_library_path)
+
+    lib.ethsnarks_verify.argtypes = [ctypes.c_char_p, ctypes.c_char_p]
+    lib.ethsnarks_verify.restype = ctypes.c_bool
+
+    lib.ethsnarks_load_vk.argtypes = [ctypes.c_char_p]
+    lib.ethsnarks_load_vk.restype = ctypes.c_void_p
+
+    lib.ethsnarks_vk_num_inputs.argtypes = [ctypes.c_void_p]
+    lib.ethsnarks_vk_num_inputs.restype = ctypes.c_size_t
+
+    lib.ethsnarks_verify_proof.argtypes = [ctypes.c_void_p, ctypes.c_char_p, ctypes.c_char_p, ctypes.c_size_t]
+    lib.ethsnarks_verify_proof.restype = ctypes.c_bool
+
+    lib.ethsnarks_verify_batch.argtypes = [ctypes.c_void_p, ctypes.c_size_t, ctypes.c_char_p, ctypes.c_char_p, ctypes.c_char_p]
+    lib.ethsnarks_verify_batch.restype = ctypes.c_size_t
+
+    lib.ethsnarks_free_vk.argtypes = [ctypes.c_void_p]
+    lib.ethsnarks_free_vk.restype = None
+
+    _NATIVE_LIBRARIES[native_library_path] = lib
+    return lib
+
+
+class PreparedVerifyingKey(object):
+    """
+    A verifying key loaded into the native library
+
+    The key is parsed and processed once, after which each proof is passed
+    as bytes and only the pairings which involve it are computed.
+    """
+    def __init__(self, vk_json, native_library_path):
+        self._lib = _load_native_library(native_library_path)
+        self._handle = self._lib.ethsnarks_load_vk(vk_json.encode('ascii'))
+        if not self._handle:
+            raise ValueError("Invalid verifying key")
+        self.num_inputs = self._lib.ethsnarks_vk_num_inputs(self._handle)
+
+    def __del__(self):
+        handle = getattr(self, '_handle', None)
+        if handle:
+            self._lib.ethsnarks_free_vk(handle)
+
+    def verify(self, proof):
+        inputs = _inputs_bytes(proof)
+        return self._lib.ethsnarks_verify_proof(self._handle, _proof_bytes(proof), inputs, len(proof.input))
+
+    def verify_batch(self, proofs):
+        """Verify many proofs at once, returns a list of whether each is valid"""
+        if any(len(_.input) != self.num_inputs for _ in proofs):
+            raise ValueError("Proofs must have %d inputs" % (self.num_inputs,))
+        proofs_buf = b''.join(_proof_bytes(_) for _ in proofs)
+        inputs_buf = b''.join(_inputs_bytes(_) for _ in proofs)
+        out_valid = ctypes.create_string_buffer(max(len(proofs), 1))
+        self._lib.ethsnarks_verify_batch(self._handle, len(proofs), proofs_buf, inputs_buf, out_valid)
+        return [bool(_) for _ in bytearray(out_valid.raw[:len(proofs)])]
+
+
 class NativeVerifier(VerifyingKey):
+    def prepare(self, native_library_path):
+        """Load the key into the native library, the result is kept for later calls"""
+        prepared = getattr(self, '_prepared', None)
+        if prepared is None:
+            prepared = self._prepared = dict()
+        if native_library_path not in prepared:
+            prepared[native_library_path] = PreparedVerifyingKey(self.to_json(), native_library_path)
+        return prepared[native_library_path]
+
     def verify(self, proof, native_library_path):
         if not isinstance(proof, Proof):
             raise TypeError("Invalid proof type")
+        return self.prepare(native_library_path).verify(proof)
 
-        vk_cstr = ctypes.c_char_p(self.to_json().encode('ascii'))
-        proof_cstr = ctypes.c_char_p(proof.to_json().encode('ascii'))
-
-        lib = ctypes.cdll.LoadLibrary(native_library_path)
-        lib_verify = lib.ethsnarks_verify
-        lib_verify.argtypes = [ctypes.c_char_p, ctypes.c_char_p]
-        lib_verify.restype = ctypes.c_bool
-
-        return lib_verify(vk_cstr, proof_cstr)
+    def verify_batch(self, proofs, native_library_path):
+        if not all(isinstance(_, Proof) for _ in proofs):
+            raise TypeError("Invalid proof type")
+        return self.prepare(native_library_path).verify_batch(proofs)
@@ -41,11 +41,17 @@ typedef libsnark::gadget<ethsnarks::FieldT> GadgetT;
 
 typedef libsnark::r1cs_gg_ppzksnark_zok_proof<ppT> ProofT;
 typedef libsnark::r1cs_gg_ppzksnark_zok_proving_key_nozk<ppT> ProvingKeyT;
+typedef libsnark::r1cs_gg_ppzksnark_zok_proving_key_mapped<ppT> MappedProvingKeyT;
+typedef libsnark::r1cs_gg_ppzksnark_zok_proving_key_stream<ppT> StreamProvingKeyT;
+typedef libsnark::r1cs_gg_ppzksnark_zok_precomputed_tables<ppT> PrecomputedTablesT;
 typedef libsnark::r1cs_gg_ppzksnark_zok_verification_key<ppT> VerificationKeyT;
+typedef libsnark::r1cs_gg_ppzksnark_zok_processed_verification_key<ppT> ProcessedVerificationKeyT;
+typedef libsnark::r1cs_gg_ppzksnark_zok_toxic_waste<ppT> ToxicWasteT;
 typedef libsnark::r1cs_gg_ppzksnark_zok_primary_input<ppT> PrimaryInputT;
 typedef libsnark::r1cs_gg_ppzksnark_zok_auxiliary_input<ppT> AuxiliaryInputT;
 
 typedef libsnark::ProverContext<ppT> ProverContextT;
+typedef libsnark::r1cs_compact_constraints<FieldT> CompactConstraintsT;
 
 }
 
@@ -0,0 +1,63 @@
+#ifndef ETHSNARKS_VERIFY_H_
+#define ETHSNARKS_VERIFY_H_
+
+/**
+* C interface of the libethsnarks_verify shared library
+*
+* Verification keys are loaded once into an opaque handle, which holds the
+* processed key (the Miller loop precomputations and e(alpha, beta)), then
+* any number of proofs can be verified with it without parsing JSON.
+*
+* Proofs and inputs are passed in the format used by the Ethereum verifier
+* contracts, every number being 32 bytes big-endian:
+*
+*   proof:  A.x, A.y, B.x.c1, B.x.c0, B.y.c1, B.y.c0, C.x, C.y   (256 bytes)
+*   inputs: input[0], input[1], ...                              (32 bytes each)
+*
+* Numbers which aren't reduced modulo their field, or points which aren't
+* on the curve, make the proof invalid.
+*
+* The handles may be used from several threads at the same time.
+*/
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ETHSNARKS_PROOF_SIZE 256
+#define ETHSNARKS_INPUT_SIZE 32
+
+typedef struct ethsnarks_vk ethsnarks_vk;
+
+/** Verify a proof in the JSON format against a key in the JSON format */
+bool ethsnarks_verify( const char *vk_json, const char *proof_json );
+
+/** Load a verification key in the JSON format, returns NULL if it is invalid */
+ethsnarks_vk *ethsnarks_load_vk( const char *vk_json );
+
+/** Number of inputs each proof must have for the key, 0 for a NULL key */
+size_t ethsnarks_vk_num_inputs( const ethsnarks_vk *vk );
+
+/** Verify a proof with `num_inputs` inputs, false for a NULL key or on any error */
+bool ethsnarks_verify_proof( const ethsnarks_vk *vk, const uint8_t *proof, const uint8_t *inputs, size_t num_inputs );
+
+/**
+* Verify `num_proofs` proofs as one batch, each with ethsnarks_vk_num_inputs
+* inputs, the proofs and inputs being consecutive. `out_valid[i]` is set to
+* 1 if proof `i` is valid, 0 otherwise. Returns the number of valid proofs,
+* 0 with every `out_valid` entry 0 for a NULL key or on any error.
+*/
+size_t ethsnarks_verify_batch( const ethsnarks_vk *vk, size_t num_proofs, const uint8_t *proofs, const uint8_t *inputs, uint8_t *out_valid );
+
+/** Release a key returned by ethsnarks_load_vk */
+void ethsnarks_free_vk( ethsnarks_vk *vk );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -5,11 +5,13 @@
 #include <iostream>
 #include <cassert>
 #include <iomanip>
+#include <unordered_map>
 
 
 #include "ethsnarks.hpp"
 #include "libff/algebra/curves/mcl_bn128/mcl_bn128_pp.hpp"
 #include "utils.hpp"
+#include "r1cs_gg_ppzksnark_zok/witness_map.hpp"
 #include <nlohmann/json.hpp>
 
 using json = nlohmann::json;
@@ -154,17 +156,30 @@ void vk2json_file(VerificationKeyT &vk, const std::string &path )
     fh.close();
 }
 
-void constraint2json(libsnark::linear_combination_light<FieldT> constraints, std::ofstream &fh)
+/**
+* Each distinct coefficient is only formatted once, circuits reuse a handful
+* of them across all of their terms
+*/
+typedef std::unordered_map<FieldT, std::string, libsnark::r1cs_compact_coefficient_hash<FieldT>> coefficient_strings;
+
+static void constraint2json(const libsnark::linear_combination_light<FieldT>& lc, coefficient_strings& coefficients, std::ofstream &fh)
 {
     fh << "{";
-    uint count = 0;
-    for (const libsnark::linear_term_light<FieldT>& lt : constraints.getTerms())
+    size_t count = 0;
+    for (const auto& lt : lc.getTerms())
     {
         if (count != 0)
         {
             fh << ",";
         }
-        fh << '"' << lt.index << '"' << ": " << '"' << bigintToString(lt.getCoeff().as_bigint(), 10) << '"';
+
+        const auto& coeff = lt.getCoeff();
+        auto it = coefficients.find(coeff);
+        if (it == coefficients.end())
+        {
+            it = coefficients.emplace(coeff, bigintToString(coeff.as_bigint(), 10)).first;
+        }
+        fh << '"' << lt.index << '"' << ": " << '"' << it->second << '"';
         count++;
     }
     fh << "}";
@@ -173,6 +188,8 @@ void constraint2json(libsnark::linear_combination_light<FieldT> constraints, std
 bool r1cs2json(libsnark::protoboard<FieldT>& pb, const std::string& path)
 {
     const libsnark::r1cs_constraint_system<FieldT>& constraints = pb.constraint_system;
+    coefficient_strings coefficients;
+
     std::ofstream fh(path);
     fh << "{\n";
     fh << " \"nPubInputs\": " << constraints.primary_input_size << ",\n";
@@ -183,11 +200,11 @@ bool r1cs2json(libsnark::protoboard<FieldT>& pb, const std::string& path)
     for (size_t c = 0; c < constraints.num_constraints(); ++c)
     {
         fh << "  [";
-        constraint2json(constraints.constraints[c]->getA(), fh);
+        constraint2json(constraints.constraints[c]->getA(), coefficients, fh);
         fh << ",";
-        constraint2json(constraints.constraints[c]->getB(), fh);
+        constraint2json(constraints.constraints[c]->getB(), coefficients, fh);
         fh << ",";
-        constraint2json(constraints.constraints[c]->getC(), fh);
+        constraint2json(constraints.constraints[c]->getC(), coefficients, fh);
         if (c == constraints.num_constraints() - 1)
         {
             fh << "]\n";
@@ -408,5 +425,24 @@ bool pk_mcl2nozk(const std::string& mcl_pk_file, const std::string& nozk_pk_file
 }
 
 
+bool pk_nozk2mapped(const std::string& nozk_pk_file, const std::string& mapped_pk_file)
+{
+    auto pk = ethsnarks::loadFromFile<ProvingKeyT>(nozk_pk_file);
+    return libsnark::write_proving_key_mapped<ppT>(pk, mapped_pk_file);
+}
+
+bool pk_precompute_tables(const std::string& pk_file, size_t expansion, size_t window_bits)
+{
+    const auto tables_file = libsnark::precomputed_tables_path(pk_file);
+    if( libsnark::is_mapped_proving_key(pk_file) )
+    {
+        MappedProvingKeyT pk(pk_file);
+        return libsnark::write_precomputed_tables<ppT>(pk, tables_file, expansion, window_bits);
+    }
+
+    auto pk = ethsnarks::loadFromFile<ProvingKeyT>(pk_file);
+    return libsnark::write_precomputed_tables<ppT>(pk, tables_file, expansion, window_bits);
+}
+
 }
 // namespace ethsnarks
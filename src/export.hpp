@@ -19,12 +19,23 @@ void vk2json_file( VerificationKeyT &vk, const std::string &path );
 
 bool r1cs2json(libsnark::protoboard<FieldT>& pb, const std::string& path);
 
+/**
+* Write the witness as decimal strings, see witness_binary.hpp for a format
+* which is much faster to write and load
+*/
 bool witness2json(libsnark::protoboard<FieldT>& pb, const std::string& path);
 
 bool pk_bellman2ethsnarks(const std::string& bellman_pk_file, const std::string& pk_file);
 
 bool pk_alt2mcl(const std::string& alt_pk_file, const std::string& mcl_pk_file);
 bool pk_mcl2nozk(const std::string& mcl_pk_file, const std::string& nozk_pk_file);
+bool pk_nozk2mapped(const std::string& nozk_pk_file, const std::string& mapped_pk_file);
+
+/**
+* Write precomputed H and L tables next to the proving key, with `expansion`
+* multiples per base (a key `expansion` times larger on disk)
+*/
+bool pk_precompute_tables(const std::string& pk_file, size_t expansion, size_t window_bits = 0);
 
 }
 
@@ -0,0 +1,67 @@
+#ifndef ETHSNARKS_PARALLEL_WITNESS_HPP_
+#define ETHSNARKS_PARALLEL_WITNESS_HPP_
+
+// Copyright (c) 2018 HarryR
+// License: LGPL-3.0+
+
+#include "ethsnarks.hpp"
+
+#ifdef MULTICORE
+#include <omp.h>
+#endif
+
+namespace ethsnarks {
+
+
+/**
+* Calls `fn(i)` for every `i` in [0, count) on all cores, where each call
+* generates the witness of one gadget instance.
+*
+* The gadgets which share a master gadget through an ITranslator only write
+* their own variables on the main protoboard: Poseidon_gadget_T generates
+* the master's witness straight into them, and the master protoboard of
+* sha256_compression_function_gadget_instance keeps its values in a buffer
+* per thread (`set_use_thread_values(true)`). So instances whose inputs are
+* known can be evaluated at the same time, e.g. all the hashes of one level
+* of a batch of Merkle paths.
+*
+* The instances must not depend on each other's outputs, those have to be
+* evaluated by successive calls, and no variables may be allocated on the
+* protoboard meanwhile. `num_threads` of 0 uses all of them.
+*/
+template<typename Fn>
+void generate_r1cs_witness_parallel_for( size_t count, Fn fn, int num_threads = 0 )
+{
+#ifdef MULTICORE
+	if( num_threads <= 0 ) {
+		num_threads = omp_get_max_threads();
+	}
+
+	// The instances cost about the same, small chunks keep the threads busy until the end
+	#pragma omp parallel for schedule(dynamic, 16) num_threads(num_threads)
+#endif
+	for( size_t i = 0; i < count; i++ )
+	{
+		fn(i);
+	}
+	libff::UNUSED(num_threads);
+}
+
+
+/**
+* Generate the witness of independent gadget instances in parallel, see above
+*/
+template<typename ContainerT>
+void generate_r1cs_witness_parallel( ContainerT& instances, int num_threads = 0 )
+{
+	generate_r1cs_witness_parallel_for(instances.size(), [&instances](size_t i) {
+		instances[i].generate_r1cs_witness();
+	}, num_threads);
+}
+
+
+// namespace ethsnarks
+}
+
+// ETHSNARKS_PARALLEL_WITNESS_HPP_
+#endif
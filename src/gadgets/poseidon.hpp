@@ -6,6 +6,7 @@
 
 #include "ethsnarks.hpp"
 #include "crypto/blake2b.h"
+#include "gadgets/translator.hpp"
 
 #include <mutex>
 
@@ -47,13 +48,19 @@ public:
 	}
 
 	void generate_r1cs_witness(const FieldT& val_x) const
+    {
+    	generate_r1cs_witness(pb_values(this->pb), val_x);
+    }
+
+	template<typename ValuesT>
+	void generate_r1cs_witness(const ValuesT& values, const FieldT& val_x) const
     {
     	const auto val_x2 = val_x * val_x;
     	const auto val_x4 = val_x2 * val_x2;
     	const auto val_x5 = val_x4 * val_x;
-    	this->pb.val(x2) = val_x2;
-    	this->pb.val(x4) = val_x4;
-    	this->pb.val(x5) = val_x5;
+    	values[x2.index] = val_x2;
+    	values[x4.index] = val_x4;
+    	values[x5.index] = val_x5;
     }
 
     const VariableT& result() const
@@ -239,14 +246,20 @@ public:
 	}
 
 	void generate_r1cs_witness() const
+	{
+		generate_r1cs_witness(pb_values(this->pb));
+	}
+
+	template<typename ValuesT>
+	void generate_r1cs_witness(const ValuesT& values) const
 	{
 		for( unsigned h = 0; h < nSBox; h++ )
 		{
 			auto value = C_i;
 			if( h < nInputs ) {
-				value += lc_val(this->pb, state[h]); // this->pb.val(state[h]);
+				value += values.lc_val(state[h]);
 			}
-			sboxes[h].generate_r1cs_witness( value );
+			sboxes[h].generate_r1cs_witness( values, value );
 		}
 	}
 
@@ -374,28 +387,38 @@ public:
 
 	void generate_r1cs_witness() const
 	{
-		first_round.generate_r1cs_witness();
+		generate_r1cs_witness(pb_values(this->pb));
+	}
+
+	/**
+	* Generate the witness into `values`, which is either this gadget's own
+	* protoboard or, for translated instances, the protoboard of an instance
+	*/
+	template<typename ValuesT>
+	void generate_r1cs_witness(const ValuesT& values) const
+	{
+		first_round.generate_r1cs_witness(values);
 
 		for( auto& prefix_round : prefix_full_rounds ) {
-			prefix_round.generate_r1cs_witness();
+			prefix_round.generate_r1cs_witness(values);
 		}
 
 		for( auto& partial_round : partial_rounds ) {
-			partial_round.generate_r1cs_witness();
+			partial_round.generate_r1cs_witness(values);
 		}
 
 		for( auto& suffix_round : suffix_full_rounds ) {
-			suffix_round.generate_r1cs_witness();
+			suffix_round.generate_r1cs_witness(values);
 		}
 
-		last_round.generate_r1cs_witness();
+		last_round.generate_r1cs_witness(values);
 
 		// When outputs are constrained, fill in the variable
 		if( constrainOutputs )
 		{
 			for (unsigned int n = 0; n < last_round.outputs.size(); n++)
 			{
-				pb.val(_output_vars[n]) = lc_val(pb, last_round.outputs[n]);
+				values[_output_vars[n].index] = values.lc_val(last_round.outputs[n]);
 			}
 		}
 	}
@@ -421,7 +444,6 @@ public:
 		std::call_once(flag, [](){
 			master = new Master(master_pb, make_var_array(master_pb, nInputs, ".dummy_inputs"), ".poseidon_master");
 			master->generate_r1cs_constraints();
-			master_pb.set_use_thread_values(true);
 		});
 		return *master;
 	}
@@ -465,19 +487,9 @@ public:
 
 	void generate_r1cs_witness() const
 	{
-		// TODO: this can be done smarter by replacing the variable indices in the background
-		// Set the input values
-		for (unsigned int i = 0; i < instance_inputs.size(); i++)
-		{
-			master.pb.val(1 + i) = pb.val(instance_inputs[i]);
-		}
-		// Calculate the funtion witnesses
-		master.generate_r1cs_witness();
-		// Copy variable values
-		for (unsigned int i = 0; i < master.pb.num_variables() - instance_inputs.size(); i++)
-		{
-			pb.val(instance_variables_offset + i) = master.pb.val(1 + instance_inputs.size() + i);
-		}
+		// The master reads the inputs and writes its variables through the translation,
+		// straight on this instance's protoboard
+		master.generate_r1cs_witness(translated_pb_values<Poseidon_gadget_T>(pb, *this));
 	}
 
 	template<bool x = constrainOutputs, unsigned n = nOutputs>
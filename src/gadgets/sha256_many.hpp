@@ -85,7 +85,8 @@ public:
 
 	void generate_r1cs_witness()
 	{
-		// TODO: this can be done smarter by replacing the variable indices in the background
+		// libsnark's gadget only generates its witness on its own protoboard, so the
+		// values are copied through the master's values for this thread
 		// Set the input values
 		for (unsigned int i = 0; i < prev_output.size(); i++)
 		{
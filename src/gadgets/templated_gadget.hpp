@@ -0,0 +1,201 @@
+#ifndef ETHSNARKS_TEMPLATED_GADGET_HPP_
+#define ETHSNARKS_TEMPLATED_GADGET_HPP_
+
+// Copyright (c) 2019 HarryR
+// License: LGPL-3.0+
+
+#include "ethsnarks.hpp"
+#include "utils.hpp"
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+
+namespace ethsnarks {
+
+
+/**
+* Instantiates any gadget from a master copy, the way Poseidon_gadget_T and
+* sha256_compression_function_gadget_instance do for their hashes.
+*
+* The master gadget is built once, with its constraints, on a protoboard of
+* its own whose first variables are its inputs. Each instance only allocates
+* variables for the rest of the master's variables on the caller's protoboard,
+* and adds constraints which refer to the master's constraints through the
+* `translate` mapping (see r1cs_constraint_light_instance), so the constraints
+* are stored once however many instances there are.
+*
+* Masters are shared by all instances with the same `shape`, which must
+* identify everything the builder does apart from the inputs: e.g. the depth
+* of a Merkle tree, or the base point of a fixed base multiplication. A shape
+* must always be built from the same number of inputs, `std::invalid_argument`
+* is thrown otherwise.
+*
+* To generate the witness the inputs are copied to the master, its witness is
+* generated, and its variables are copied back. The master protoboard keeps its
+* values per thread, so independent instances can be evaluated in parallel
+* (see generate_r1cs_witness_parallel). The master must not write its inputs.
+*
+* As for the other translated gadgets, instances must stay at the same address
+* once their constraints have been generated.
+*
+* Example:
+*
+*    typedef templated_gadget<MiMC_e7_gadget> TemplatedMiMC;
+*    TemplatedMiMC mimc(pb, {x, k}, "MiMC_e7", [](ProtoboardT& pb, const VariableArrayT& in) {
+*        return new MiMC_e7_gadget(pb, in[0], in[1], "mimc");
+*    }, "mimc");
+*    const VariableT result = mimc.variable(mimc.master().result());
+*/
+template<typename MasterT>
+class templated_gadget : public GadgetT, public libsnark::ITranslator
+{
+public:
+	/** Builds the master gadget on its protoboard, given its input variables */
+	typedef std::function<MasterT*(ProtoboardT& pb, const VariableArrayT& inputs)> BuilderT;
+
+	struct master_entry
+	{
+		ProtoboardT pb;
+		std::unique_ptr<MasterT> gadget;
+		size_t num_inputs;
+		std::once_flag swapped;
+	};
+
+	master_entry& m_master;
+	const VariableArrayT m_inputs;
+	unsigned int m_variables_offset;
+
+	static master_entry& get_master( const std::string& shape, size_t num_inputs, const BuilderT& builder )
+	{
+		static std::mutex lock;
+		static std::map<std::string, std::unique_ptr<master_entry> > masters;
+
+		std::lock_guard<std::mutex> guard(lock);
+		auto it = masters.find(shape);
+		if( it == masters.end() )
+		{
+			// Only a completely built master is kept, should the builder throw
+			std::unique_ptr<master_entry> entry(new master_entry);
+			const auto inputs = make_var_array(entry->pb, num_inputs, ".template_inputs");
+			entry->gadget.reset(builder(entry->pb, inputs));
+			entry->gadget->generate_r1cs_constraints();
+			entry->pb.set_use_thread_values(true);
+			entry->num_inputs = num_inputs;
+			it = masters.emplace(shape, std::move(entry)).first;
+		}
+
+		// Reusing the master of another number of inputs would translate to the wrong variables
+		if( it->second->num_inputs != num_inputs ) {
+			throw std::invalid_argument("templated_gadget: shape '" + shape + "' was built with another number of inputs");
+		}
+
+		return *it->second;
+	}
+
+	templated_gadget(
+		ProtoboardT& in_pb,
+		const VariableArrayT& in_inputs,
+		const std::string& shape,
+		const BuilderT& builder,
+		const std::string& annotation_prefix
+	) :
+		GadgetT(in_pb, annotation_prefix),
+		m_master(get_master(shape, in_inputs.size(), builder)),
+		m_inputs(in_inputs)
+	{
+		// Keep track of where the variables for this instance start
+		m_variables_offset = in_pb.num_variables() + 1;
+		// Allocate the variables on the pb needed for this instance
+		make_var_array(in_pb, m_master.pb.num_variables() - m_inputs.size(), FMT(annotation_prefix, ".instance_var"));
+	}
+
+	const MasterT& master() const
+	{
+		return *m_master.gadget;
+	}
+
+	/** The variable of this instance for a variable of the master */
+	VariableT variable( const VariableT& master_var ) const
+	{
+		return VariableT(translate(master_var.index));
+	}
+
+	VariableArrayT variables( const VariableArrayT& master_vars ) const
+	{
+		VariableArrayT result;
+		result.reserve(master_vars.size());
+		for( const auto& var : master_vars ) {
+			result.emplace_back(variable(var));
+		}
+		return result;
+	}
+
+	void generate_r1cs_constraints() const
+	{
+		const auto& constraints = m_master.pb.constraint_system.constraints;
+		for( unsigned int i = 0; i < constraints.size(); i++ )
+		{
+			pb.constraint_system.constraints.emplace_back(
+				libsnark::make_unique<libsnark::r1cs_constraint_light_instance<FieldT>>(
+					(libsnark::r1cs_constraint_light<FieldT>*) constraints[i].get(),
+					(libsnark::ITranslator*) this
+				)
+			);
+		}
+	}
+
+	void generate_r1cs_witness() const
+	{
+		ProtoboardT& master_pb = m_master.pb;
+		const size_t num_inputs = m_inputs.size();
+
+		for( size_t i = 0; i < num_inputs; i++ )
+		{
+			master_pb.val(VariableT(1 + i)) = pb.val(m_inputs[i]);
+		}
+
+		m_master.gadget->generate_r1cs_witness();
+
+		for( size_t i = 0; i < master_pb.num_variables() - num_inputs; i++ )
+		{
+			pb.val(VariableT(m_variables_offset + i)) = master_pb.val(VariableT(1 + num_inputs + i));
+		}
+	}
+
+	unsigned int translate( unsigned int index ) const override
+	{
+		if( index == 0 )
+		{
+			return 0;
+		}
+		else if( index <= m_inputs.size() )
+		{
+			return m_inputs[index - 1].index;
+		}
+		else
+		{
+			return m_variables_offset + (index - (1 + m_inputs.size()));
+		}
+	}
+
+	void swapAB() override
+	{
+		std::call_once(m_master.swapped, [&](){
+			const auto& constraints = m_master.pb.constraint_system.constraints;
+			for( unsigned int i = 0; i < constraints.size(); i++ )
+			{
+				constraints[i]->swapAB();
+			}
+		});
+	}
+};
+
+
+// namespace ethsnarks
+}
+
+// ETHSNARKS_TEMPLATED_GADGET_HPP_
+#endif
@@ -0,0 +1,82 @@
+#ifndef ETHSNARKS_TRANSLATOR_HPP_
+#define ETHSNARKS_TRANSLATOR_HPP_
+
+// Copyright (c) 2019 HarryR
+// License: LGPL-3.0+
+
+#include "ethsnarks.hpp"
+
+namespace ethsnarks {
+
+
+/**
+* Access to the values of a protoboard by variable index, for gadgets
+* whose witness can be generated either on their own protoboard or, as
+* the master of translated instances, on the protoboard of an instance.
+*/
+class pb_values
+{
+public:
+	ProtoboardT& pb;
+
+	pb_values( ProtoboardT& in_pb ) :
+		pb(in_pb)
+	{ }
+
+	FieldT& operator[]( size_t index ) const
+	{
+		return pb.val(VariableT(index));
+	}
+
+	FieldT lc_val( const libsnark::linear_combination<FieldT>& lc ) const
+	{
+		FieldT sum = 0;
+		for( const auto& term : lc.terms ) {
+			sum += term.coeff * (*this)[term.index];
+		}
+		return sum;
+	}
+};
+
+
+/**
+* The values of a master gadget's variables, as they are placed on the
+* protoboard of an instance by its `translate` mapping (see ITranslator).
+*
+* Generating the master's witness through this writes it straight into
+* the instance's variables, without copying values in and out of the
+* master protoboard.
+*/
+template<typename TranslatorT>
+class translated_pb_values
+{
+public:
+	ProtoboardT& pb;
+	const TranslatorT& translator;
+
+	translated_pb_values( ProtoboardT& in_pb, const TranslatorT& in_translator ) :
+		pb(in_pb),
+		translator(in_translator)
+	{ }
+
+	FieldT& operator[]( size_t index ) const
+	{
+		return pb.val(VariableT(translator.translate(index)));
+	}
+
+	FieldT lc_val( const libsnark::linear_combination<FieldT>& lc ) const
+	{
+		FieldT sum = 0;
+		for( const auto& term : lc.terms ) {
+			sum += term.coeff * (*this)[term.index];
+		}
+		return sum;
+	}
+};
+
+
+// namespace ethsnarks
+}
+
+// ETHSNARKS_TRANSLATOR_HPP_
+#endif
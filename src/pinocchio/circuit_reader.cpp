@@ -27,17 +27,23 @@ SOFTWARE.
 */
 
 #include "circuit_reader.hpp"
+#include "r1cs_binary.hpp"
 #include "utils.hpp"
+#include "crypto/sha256.h"
 #include "gadgets/lookup_1bit.cpp"
 #include "gadgets/lookup_2bit.cpp"
 #include "gadgets/lookup_3bit.cpp"
 #include "libsnark/gadgetlib1/gadgets/basic_gadgets.hpp"
 
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
 #include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <unordered_map>
 
 
-using std::istringstream;
-using std::ifstream;
 using std::string;
 using std::cout;
 using std::endl;
@@ -50,33 +56,134 @@ using libsnark::generate_boolean_r1cs_constraint;
 namespace ethsnarks {
 
 
-static void readIds(char* str, std::vector<unsigned int>& vec)
+static const FieldT readFieldElementFromHex(const char* inputStr){
+	char constStrDecimal[150];
+	mpz_t integ;
+	mpz_init_set_str(integ, inputStr, 16);
+	mpz_get_str(constStrDecimal, 10, integ);
+	mpz_clear(integ);
+	return FieldT(constStrDecimal);
+}
+
+
+/**
+* Tokenises a line of a memory mapped file in place, `pos` never passes `end`
+*/
+class LineTokens
 {
-	istringstream iss_i(str, istringstream::in);
-	unsigned int id;
-	while (iss_i >> id) {
-		vec.push_back(id);
+public:
+	const char *pos;
+	const char *end;
+
+	LineTokens( const char *in_begin, const char *in_end ) :
+		pos(in_begin), end(in_end)
+	{ }
+
+	void skipSpaces()
+	{
+		while( pos < end && (*pos == ' ' || *pos == '\t' || *pos == '\r') ) {
+			pos++;
+		}
+	}
+
+	/** The next run of characters up to a space, `<` or `>` */
+	bool word( const char *&out_begin, size_t &out_length )
+	{
+		skipSpaces();
+		out_begin = pos;
+		while( pos < end && *pos != ' ' && *pos != '\t' && *pos != '\r' && *pos != '<' && *pos != '>' ) {
+			pos++;
+		}
+		out_length = pos - out_begin;
+		return out_length > 0;
 	}
-}
 
+	bool keyword( const char *expected )
+	{
+		const char *begin;
+		size_t length;
+		return word(begin, length) && length == strlen(expected) && 0 == memcmp(begin, expected, length);
+	}
 
-static void readTable(char* str, std::vector<FieldT>& vec)
+	bool character( char expected )
+	{
+		skipSpaces();
+		if( pos < end && *pos == expected ) {
+			pos++;
+			return true;
+		}
+		return false;
+	}
+
+	bool number( unsigned int &out )
+	{
+		skipSpaces();
+		uint64_t value = 0;
+		const char *begin = pos;
+		while( pos < end && *pos >= '0' && *pos <= '9' ) {
+			value = (value * 10) + (*pos - '0');
+			if( value > UINT32_MAX ) {
+				return false;
+			}
+			pos++;
+		}
+		out = value;
+		return pos != begin;
+	}
+
+	/** `<id id ...>`, appending the ids to `out` */
+	bool wireList( std::vector<Wire> &out, uint32_t &out_count )
+	{
+		if( ! character('<') ) {
+			return false;
+		}
+		out_count = 0;
+		Wire id;
+		while( number(id) ) {
+			out.push_back(id);
+			out_count++;
+		}
+		return character('>');
+	}
+};
+
+
+/**
+* Calls `fn(line_begin, line_end)` for each line of the file
+*/
+template<typename Fn>
+static void forEachLine( const libsnark::mapped_file &file, Fn fn )
 {
-	istringstream iss_i(str, istringstream::in);
-	string token;
-	while (iss_i >> token) {
-		vec.push_back(FieldT(token.c_str()));
+	const char *pos = reinterpret_cast<const char*>(file.data());
+	const char *end = pos + file.size();
+	while( pos < end )
+	{
+		const char *eol = static_cast<const char*>(memchr(pos, '\n', end - pos));
+		if( eol == nullptr ) {
+			eol = end;
+		}
+		fn(pos, eol);
+		pos = eol + 1;
 	}
 }
 
 
-static const FieldT readFieldElementFromHex(const char* inputStr){
-	char constStrDecimal[150];
-	mpz_t integ;
-	mpz_init_set_str(integ, inputStr, 16);
-	mpz_get_str(constStrDecimal, 10, integ);
-	mpz_clear(integ);
-	return FieldT(constStrDecimal);
+CircuitInstruction CircuitInstructions::operator[]( size_t index ) const
+{
+	const auto &entry = entries[index];
+	const Wire *entry_wires = wires.data() + entry.wires_offset;
+
+	CircuitInstruction inst;
+	inst.opcode = static_cast<Opcode>(entry.opcode);
+	inst.inputs = InputWires(entry_wires, entry.num_inputs);
+	inst.outputs = OutputWires(entry_wires + entry.num_inputs, entry.num_outputs);
+	if( inst.opcode == TABLE_OPCODE ) {
+		inst.table = libsnark::array_view<FieldT>(constants.data() + entry.constants_offset, size_t(1) << entry.num_inputs);
+	}
+	else if( inst.opcode == CONST_MUL_OPCODE || inst.opcode == CONST_MUL_NEG_OPCODE ) {
+		inst.constant = constants[entry.constants_offset];
+	}
+	return inst;
 }
 
 
@@ -87,65 +194,345 @@ CircuitReader::CircuitReader(
 	bool in_traceEnabled
 ) :
 	GadgetT(in_pb, "CircuitReader"),
-	traceEnabled(in_traceEnabled)
+	traceEnabled(in_traceEnabled),
+	arithPath(arithFilepath)
 {
-	parseCircuit(arithFilepath);
+	const bool compiled = loadCompiled(arithFilepath);
+	if( ! compiled ) {
+		parseCircuit(arithFilepath);
+	}
+
+	// A compiled circuit has all its variables already
+	constrained = compiled;
 
 	if( inputsFilepath ) {
 		parseInputs(inputsFilepath);
+		evalInstructions();
+	}
+
+	if( ! compiled ) {
+		makeAllConstraints();
+	}
+	constrained = true;
+}
+
+
+/**
+* Evaluate the circuit again with other inputs, the variables and
+* constraints on the protoboard are kept, so a circuit can be parsed once
+* and used for many witnesses
+*/
+void CircuitReader::evaluate( const char *inputsFilepath )
+{
+	std::fill(this->pb.values.begin(), this->pb.values.end(), FieldT::zero());
+	parseInputs(inputsFilepath);
+	evalInstructions();
+}
+
+
+void CircuitReader::evalInstructions()
+{
+	if( traceEnabled ) {
+		enter_block("Evaluating instructions");
+	}
+
+	for( size_t i = 0; i < instructions.size(); i++ ) {
+		evalInstruction(instructions[i]);
+	}
+
+	if( traceEnabled ) {
+		leave_block("Evaluating instructions");
+	}
+}
+
+
+static const uint64_t CIRCUIT_BINARY_ALIGN = 64;
+
+
+static inline uint64_t circuit_binary_align( uint64_t offset )
+{
+	return (offset + CIRCUIT_BINARY_ALIGN - 1) & ~uint64_t(CIRCUIT_BINARY_ALIGN - 1);
+}
+
+
+bool CircuitReader::isCompiled( const char *filepath )
+{
+	if( ! is_r1cs_binary(filepath) ) {
+		return false;
+	}
+
+	// The circuit header follows the constraint system
+	std::ifstream fh(filepath, std::ios::binary);
+	r1cs_binary_header r1cs_header;
+	char magic[sizeof(CIRCUIT_BINARY_MAGIC)];
+	if( ! fh.read(reinterpret_cast<char*>(&r1cs_header), sizeof(r1cs_header))
+	 || ! fh.seekg(circuit_binary_align(r1cs_header.file_size))
+	 || ! fh.read(magic, sizeof(magic)) ) {
+		return false;
+	}
+	return 0 == memcmp(magic, CIRCUIT_BINARY_MAGIC, sizeof(magic));
+}
+
+
+const CircuitHash& CircuitReader::getArithHash()
+{
+	if( ! arithHashed )
+	{
+		libsnark::mapped_file file(arithPath);
+		SHA256_CTX ctx;
+		SHA256_Init(&ctx);
+		SHA256_Update(&ctx, file.data(), file.size());
+		SHA256_Final(arithHash.data(), &ctx);
+		arithHashed = true;
+	}
+	return arithHash;
+}
+
+
+/**
+* Load the circuit from its compiled form, either given instead of the
+* `.arith` file or next to it. The compiled form is ignored when tracing,
+* which shows the instructions as they are constrained.
+*/
+bool CircuitReader::loadCompiled( const char *arithFilepath )
+{
+	// The compiled constraint system must be the only one on the protoboard
+	if( pb.num_variables() != 0 || pb.num_constraints() != 0 ) {
+		return false;
+	}
+
+	if( isCompiled(arithFilepath) ) {
+		return readCompiled(arithFilepath, nullptr);
+	}
+
+	const string compiledFilepath = arithPath + ".compiled";
+	if( traceEnabled || ! isCompiled(compiledFilepath.c_str()) ) {
+		return false;
+	}
+
+	try {
+		getArithHash();
+	}
+	catch( const std::exception& ) {
+		// Parsing reports the missing circuit file
+		return false;
+	}
+
+	return readCompiled(compiledFilepath.c_str(), &arithHash);
+}
+
 
-		if( traceEnabled ) {
-			enter_block("Evaluating instructions");
+/**
+* Fills in the protoboard and the instructions from a compiled circuit.
+* Returns false, leaving both empty, if `expectedHash` is given and doesn't
+* match, or the file next to the `.arith` file can't be used.
+*/
+bool CircuitReader::readCompiled( const char *compiledFilepath, const CircuitHash *expectedHash )
+{
+	try {
+		const R1CSBinaryFile r1cs(compiledFilepath);
+		const libsnark::mapped_file file(compiledFilepath);
+
+		const uint64_t offset = circuit_binary_align(r1cs.header().file_size);
+		const auto &h = *file.at<circuit_binary_header>(offset, 1);
+		if( 0 != memcmp(h.magic, CIRCUIT_BINARY_MAGIC, sizeof(CIRCUIT_BINARY_MAGIC)) || h.version != CIRCUIT_BINARY_VERSION ) {
+			throw std::runtime_error("unsupported version");
+		}
+
+		if( expectedHash && h.arith_hash != *expectedHash ) {
+			return false;
+		}
+
+		if( h.num_inputs != r1cs.num_inputs() ) {
+			throw std::runtime_error("number of inputs does not match the constraint system");
+		}
+
+		const auto *entries = file.at<CircuitInstructions::Entry>(offset + h.entries_offset, h.num_entries);
+		const auto *entry_wires = file.at<Wire>(offset + h.wires_offset, h.num_entry_wires);
+		const auto *constants = file.at<FieldT>(offset + h.constants_offset, h.num_constants);
+		const auto *variables = file.at<uint32_t>(offset + h.variables_offset, h.num_wire_variables);
+		const auto *wire_ids = file.at<Wire>(offset + h.wire_ids_offset, h.num_inputs + h.num_nizk_inputs + h.num_outputs);
+
+		// The gates are used as views into the pools, so they must lie within them
+		for( uint64_t i = 0; i < h.num_entries; i++ )
+		{
+			const auto &entry = entries[i];
+			if( entry.opcode > TABLE_OPCODE || (entry.opcode == TABLE_OPCODE && (entry.num_inputs == 0 || entry.num_inputs > 3)) ) {
+				throw std::runtime_error("bad gate");
+			}
+
+			uint64_t num_constants = 0;
+			if( entry.opcode == TABLE_OPCODE ) {
+				num_constants = uint64_t(1) << entry.num_inputs;
+			}
+			else if( entry.opcode == CONST_MUL_OPCODE || entry.opcode == CONST_MUL_NEG_OPCODE ) {
+				num_constants = 1;
+			}
+
+			if( entry.wires_offset + entry.num_inputs + entry.num_outputs > h.num_entry_wires
+			 || uint64_t(entry.constants_offset) + num_constants > h.num_constants ) {
+				throw std::runtime_error("gate out of bounds");
+			}
+		}
+
+		for( uint64_t i = 0; i < h.num_wire_variables; i++ )
+		{
+			if( variables[i] > r1cs.num_variables() ) {
+				throw std::runtime_error("wire variable out of range");
+			}
 		}
 
-		for( const auto& inst : instructions ) {
-			evalInstruction(inst);
+		r1cs.load(this->pb);
+
+		instructions.entries.assign(entries, entries + h.num_entries);
+		instructions.wires.assign(entry_wires, entry_wires + h.num_entry_wires);
+		instructions.constants.assign(constants, constants + h.num_constants);
+
+		wireVariables.resize(h.num_wire_variables);
+		for( uint64_t i = 0; i < h.num_wire_variables; i++ ) {
+			wireVariables[i] = VariableT(variables[i]);
 		}
 
-		if( traceEnabled ) {
-			leave_block("Evaluating instructions");
+		numWires = h.num_wires;
+		numInputs = h.num_inputs;
+		numNizkInputs = h.num_nizk_inputs;
+		numOutputs = h.num_outputs;
+		inputWireIds.assign(wire_ids, wire_ids + numInputs);
+		nizkWireIds.assign(wire_ids + numInputs, wire_ids + numInputs + numNizkInputs);
+		outputWireIds.assign(wire_ids + numInputs + numNizkInputs, wire_ids + numInputs + numNizkInputs + numOutputs);
+
+		arithHash = h.arith_hash;
+		arithHashed = true;
+	}
+	catch( const std::exception& ex ) {
+		std::cerr << "Unable to load compiled circuit " << compiledFilepath << ": " << ex.what() << std::endl;
+
+		// A stale or damaged file next to the circuit is ignored, it is parsed instead
+		if( expectedHash && pb.num_variables() == 0 ) {
+			return false;
 		}
+		exit(-1);
 	}
 
-	makeAllConstraints();
+	return true;
+}
+
+
+bool CircuitReader::writeCompiled( const char *outputFilepath )
+{
+	circuit_binary_header h;
+	memset(&h, 0, sizeof(h));
+	memcpy(h.magic, CIRCUIT_BINARY_MAGIC, sizeof(CIRCUIT_BINARY_MAGIC));
+	h.version = CIRCUIT_BINARY_VERSION;
+	h.arith_hash = getArithHash();
+	h.num_wires = numWires;
+	h.num_inputs = numInputs;
+	h.num_nizk_inputs = numNizkInputs;
+	h.num_outputs = numOutputs;
+	h.num_entries = instructions.entries.size();
+	h.num_entry_wires = instructions.wires.size();
+	h.num_constants = instructions.constants.size();
+	h.num_wire_variables = wireVariables.size();
+
+	std::vector<uint32_t> variables;
+	variables.reserve(wireVariables.size());
+	for( const auto& var : wireVariables ) {
+		variables.push_back(var.index);
+	}
+
+	std::vector<Wire> wire_ids(inputWireIds);
+	wire_ids.insert(wire_ids.end(), nizkWireIds.begin(), nizkWireIds.end());
+	wire_ids.insert(wire_ids.end(), outputWireIds.begin(), outputWireIds.end());
+
+	h.entries_offset = circuit_binary_align(sizeof(h));
+	h.wires_offset = circuit_binary_align(h.entries_offset + (h.num_entries * sizeof(CircuitInstructions::Entry)));
+	h.constants_offset = circuit_binary_align(h.wires_offset + (h.num_entry_wires * sizeof(Wire)));
+	h.variables_offset = circuit_binary_align(h.constants_offset + (h.num_constants * sizeof(FieldT)));
+	h.wire_ids_offset = circuit_binary_align(h.variables_offset + (h.num_wire_variables * sizeof(uint32_t)));
+	h.size = h.wire_ids_offset + (wire_ids.size() * sizeof(Wire));
+
+	// Written aside then renamed, so a partial file is never loaded
+	const string tmp_path = string(outputFilepath) + ".tmp";
+	try {
+		if( ! r1cs2binary(this->pb, tmp_path) ) {
+			return false;
+		}
+	}
+	catch( const std::exception& ) {
+		return false;
+	}
+
+	std::fstream out(tmp_path, std::ios::binary | std::ios::in | std::ios::out);
+	r1cs_binary_header r1cs_header;
+	if( ! out.read(reinterpret_cast<char*>(&r1cs_header), sizeof(r1cs_header)) ) {
+		return false;
+	}
+	const uint64_t offset = circuit_binary_align(r1cs_header.file_size);
+
+	const auto writeAt = [&]( uint64_t section_offset, const void *data, size_t size ) {
+		out.seekp(offset + section_offset);
+		out.write(static_cast<const char*>(data), size);
+	};
+
+	// Extend the file to its full size first, the sections may be empty
+	writeAt(h.size - 1, "", 1);
+	writeAt(0, &h, sizeof(h));
+	writeAt(h.entries_offset, instructions.entries.data(), h.num_entries * sizeof(CircuitInstructions::Entry));
+	writeAt(h.wires_offset, instructions.wires.data(), h.num_entry_wires * sizeof(Wire));
+	writeAt(h.constants_offset, instructions.constants.data(), h.num_constants * sizeof(FieldT));
+	writeAt(h.variables_offset, variables.data(), variables.size() * sizeof(uint32_t));
+	writeAt(h.wire_ids_offset, wire_ids.data(), wire_ids.size() * sizeof(Wire));
+	out.flush();
+
+	const bool ok = out.good();
+	out.close();
+	if( ! ok || 0 != ::rename(tmp_path.c_str(), outputFilepath) ) {
+		::remove(tmp_path.c_str());
+		return false;
+	}
+	return true;
 }
 
 /**
 * Parse file containing inputs, one line at a time, each line is two numbers:
 *
 * 	<wire-id> <value>
+*
+* The value is in hex, separated from the wire id by spaces or `=`.
 */
 void CircuitReader::parseInputs( const char *inputsFilepath )
 {
-	ifstream inputfs(inputsFilepath, ifstream::in);
-	string line;
-
-	if (!inputfs.good()) {
+	std::unique_ptr<libsnark::mapped_file> file;
+	try {
+		file.reset(new libsnark::mapped_file(inputsFilepath));
+	}
+	catch( const std::exception& ) {
 		std::cerr << "Unable to open input file: " << inputsFilepath << std::endl;
 		exit(-1);
 	}
-	else {
-		char* inputStr;
-		while (getline(inputfs, line))
-		{
-			if (line.length() == 0) {
-				continue;
-			}
-			Wire wireId;
-			inputStr = new char[line.size()];
-			char separator[2];
-			if (3 == sscanf(line.c_str(), "%u%[= ]%s", &wireId, separator, inputStr)) {
-				const auto value = readFieldElementFromHex(inputStr);
-				varSet(wireId, value);
-			}
-			else {
-				std::cerr << "Error in Input" << endl;
-				exit(-1);
-			}
-			delete[] inputStr;
+
+	string value_hex;
+	forEachLine(*file, [&](const char *line_begin, const char *line_end) {
+		LineTokens tokens(line_begin, line_end);
+		tokens.skipSpaces();
+		if( tokens.pos == tokens.end ) {
+			return;
 		}
-		inputfs.close();
-	}
+
+		// The wire id is followed by spaces and/or '='
+		Wire wireId;
+		const char *value_begin;
+		size_t value_length;
+		const bool has_id = tokens.number(wireId) && tokens.pos < tokens.end && (*tokens.pos == ' ' || *tokens.pos == '\t' || *tokens.pos == '=');
+		tokens.character('=');
+		if( ! has_id || ! tokens.word(value_begin, value_length) ) {
+			std::cerr << "Error in Input" << endl;
+			exit(-1);
+		}
+
+		value_hex.assign(value_begin, value_length);
+		varSet(wireId, readFieldElementFromHex(value_hex.c_str()));
+	});
 }
 
 
@@ -215,171 +602,199 @@ void CircuitReader::evalInstruction( const CircuitInstruction &inst )
 }
 
 
+/**
+* Parse the circuit, the file is memory mapped and each line is tokenised in
+* place. The wire ids and constants of the gates are appended to the pools
+* of `instructions`, so no memory is allocated per gate.
+*/
 void CircuitReader::parseCircuit(const char* arithFilepath)
 {
 	if( traceEnabled ) {
 		enter_block("Parsing Circuit");
 	}
 
-	ifstream arithfs(arithFilepath, ifstream::in);
-	string line;
-
-	if (!arithfs.good()) {
-		std::cerr << "Unable to open circuit file" << arithFilepath << std::endl;
-		exit(-1);
+	std::unique_ptr<libsnark::mapped_file> file;
+	try {
+		file.reset(new libsnark::mapped_file(arithFilepath));
 	}
-
-	getline(arithfs, line);
-	int ret = sscanf(line.c_str(), "total %zu", &numWires);
-
-	if (ret != 1) {
-		std::cerr << "File Format Does not Match" << endl;;
+	catch( const std::exception& ) {
+		std::cerr << "Unable to open circuit file" << arithFilepath << std::endl;
 		exit(-1);
 	}
 
-	char type[200];	// XXX: buffer overflow!
-	char* inputStr;
-	char* outputStr;
-	char* tableStr;
-	unsigned int numGateInputs, numGateOutputs;
+	// Constants of const-mul gates, by their hex string (prefixed with '-' when negated)
+	std::unordered_map<string, uint32_t> constant_ids;
+
+	// Re-used for every line, so they only allocate for the longest token
+	string type_str;
+	string token_str;
+
+	bool first_line = true;
+	forEachLine(*file, [&](const char *line_begin, const char *line_end) {
+		LineTokens tokens(line_begin, line_end);
+		tokens.skipSpaces();
+
+		const auto lineError = [&]( const char *error ) {
+			std::cerr << "Error parsing line: " << string(line_begin, line_end) << std::endl;
+			std::cerr << " " << error << std::endl;
+			exit(6);
+		};
+
+		if( first_line ) {
+			first_line = false;
+			unsigned int total;
+			if( ! tokens.keyword("total") || ! tokens.number(total) ) {
+				std::cerr << "File Format Does not Match" << endl;
+				exit(-1);
+			}
+			numWires = total;
+			wireVariables.reserve(numWires);
+			return;
+		}
 
-	// Parse the circuit: few lines were imported from Pinocchio's code.
-	while (getline(arithfs, line))
-	{
-		if (line.length() == 0) {
-			continue;
+		if( tokens.pos == tokens.end || *tokens.pos == '#' ) {
+			return;
 		}
-		inputStr = new char[line.size()];
-		outputStr = new char[line.size()];
-		tableStr = new char[line.size()];
+
+		const char *type;
+		size_t type_length;
+		tokens.word(type, type_length);
+		type_str.assign(type, type_length);
 
 		Wire wireId;
-		if (line[0] == '#') {
-			continue;
-		}
-		else if (1 == sscanf(line.c_str(), "input %u", &wireId)) {
+		if( type_str == "input" && tokens.number(wireId) ) {
 			// XXX: public inputs need to go first!
 			numInputs++;
 			varNew(wireId, FMT("input_", "%zu", wireId));
 			inputWireIds.push_back(wireId);
+			return;
 		}
-		else if (1 == sscanf(line.c_str(), "nizkinput %u", &wireId)) {
+		else if( type_str == "nizkinput" && tokens.number(wireId) ) {
 			numNizkInputs++;
 			varNew(wireId, FMT("nizkinput_", "%zu", wireId));
 			nizkWireIds.push_back(wireId);
+			return;
 		}
-		else if (1 == sscanf(line.c_str(), "output %u", &wireId)) {
+		else if( type_str == "output" && tokens.number(wireId) ) {
 			numOutputs++;
 			varNew(wireId, FMT("output_", "%zu", wireId));
 			outputWireIds.push_back(wireId);
+			return;
 		}
-		else if (4 == sscanf(line.c_str(), "table %u <%[^>]> in <%[^>]> out <%[^>]>",
-							 &numGateInputs, tableStr, inputStr, outputStr)) {
-			InputWires inWires;
-			OutputWires outWires;
-			readIds(inputStr, inWires);
-			readIds(outputStr, outWires);
-			numGateOutputs = outWires.size();
-
-			if( numGateInputs != inWires.size() ) {
-				std::cerr << "Error parsing line: " << line << std::endl;
-				std::cerr << " input gate mismatch, expected " << numGateInputs << " got " << inWires.size() << std::endl;
-				exit(6);
-			}
 
-			if( outWires.size() != 1 ) {
-				std::cerr << "Error parsing line: " << line << std::endl;
-				std::cerr << " output gate mismatch, expected 1, got " << outWires.size() << std::endl;
-				exit(6);
+		CircuitInstructions::Entry entry;
+		entry.wires_offset = instructions.wires.size();
+		entry.constants_offset = 0;
+
+		unsigned int numGateInputs, numGateOutputs;
+		if( type_str == "table" )
+		{
+			if( ! tokens.number(numGateInputs) || ! tokens.character('<') ) {
+				lineError("unrecognized table");
 			}
 
 			if( numGateInputs <= 0 || numGateInputs > 3u ) {
-				std::cerr << "Error parsing line: " << line << std::endl;
-				std::cerr << " unsupported lookup table size: " << numGateInputs << std::endl;
-				exit(6);
+				lineError("unsupported lookup table size");
 			}
 
-			std::vector<FieldT> table;
-			readTable(tableStr, table);
-			if( table.size() != (1u<<numGateInputs) ) {
-				std::cerr << "Error parsing line: " << line << std::endl;
-				std::cerr << " bad number of table entries, got " << table.size() << " expected " << (1<<inWires.size()) << std::endl;
-				exit(6);
+			entry.constants_offset = instructions.constants.size();
+			const char *item;
+			size_t item_length;
+			while( tokens.word(item, item_length) ) {
+				token_str.assign(item, item_length);
+				instructions.constants.emplace_back(token_str.c_str());
 			}
-			instructions.push_back({TABLE_OPCODE, 0, inWires, outWires, table});
-		}
-		else if (5 == sscanf(line.c_str(), "%s in %u <%[^>]> out %u <%[^>]>",
-						type, &numGateInputs, inputStr, &numGateOutputs, outputStr)) {
-
-			OutputWires outWires;
-			InputWires inWires;
-			readIds(inputStr, inWires);
-			readIds(outputStr, outWires);
-
-			if( numGateInputs != inWires.size() ) {
-				std::cerr << "Error parsing line: " << line << std::endl;
-				std::cerr << " input gate mismatch, expected " << numGateInputs << " got " << inWires.size() << std::endl;
-				exit(6);
+			if( instructions.constants.size() - entry.constants_offset != (1u<<numGateInputs) ) {
+				lineError("bad number of table entries");
 			}
 
-			if( numGateOutputs != outWires.size() ) {
-				std::cerr << "Error parsing line: " << line << std::endl;
-				std::cerr << " output gate mismatch, expected " << numGateOutputs << " got " << outWires.size() << std::endl;
-				exit(6);
+			if( ! tokens.character('>') || ! tokens.keyword("in") || ! tokens.wireList(instructions.wires, entry.num_inputs)
+			 || ! tokens.keyword("out") || ! tokens.wireList(instructions.wires, entry.num_outputs) ) {
+				lineError("unrecognized table");
 			}
 
-			Opcode opcode;
-			FieldT constant;
-			if (strcmp(type, "add") == 0) {
-				opcode = ADD_OPCODE;
-			}
-			else if (strcmp(type, "mul") == 0) {
-				opcode = MUL_OPCODE;
-			}
-			else if (strcmp(type, "xor") == 0) {
-				opcode = XOR_OPCODE;
-			}
-			else if (strcmp(type, "or") == 0) {
-				opcode = OR_OPCODE;
-			}
-			else if (strcmp(type, "assert") == 0) {
-				opcode = ASSERT_OPCODE;
-			}
-			else if (strcmp(type, "pack") == 0) {
-				opcode = PACK_OPCODE;
-			}
-			else if (strcmp(type, "zerop") == 0) {
-				opcode = ZEROP_OPCODE;
-			}
-			else if (strcmp(type, "split") == 0) {
-				opcode = SPLIT_OPCODE;
-			}
-			else if (strstr(type, "const-mul-neg-")) {
-				opcode = CONST_MUL_NEG_OPCODE;
-				char* constStr = type + sizeof("const-mul-neg-") - 1;
-				constant = readFieldElementFromHex(constStr) * FieldT(-1);
+			if( numGateInputs != entry.num_inputs ) {
+				lineError("input gate mismatch");
 			}
-			else if (strstr(type, "const-mul-")) {
-				opcode = CONST_MUL_OPCODE;
-				char* constStr = type + sizeof("const-mul-") - 1;
-				constant = readFieldElementFromHex(constStr);
-			}
-			else {
-				printf("Error: unrecognized line: %s\n", line.c_str());
-				exit(-1);
+
+			if( entry.num_outputs != 1 ) {
+				lineError("output gate mismatch, expected 1");
 			}
 
-			instructions.push_back({opcode, constant, inWires, outWires});
+			entry.opcode = TABLE_OPCODE;
+			instructions.entries.push_back(entry);
+			return;
+		}
+
+		if( ! tokens.keyword("in") || ! tokens.number(numGateInputs) || ! tokens.wireList(instructions.wires, entry.num_inputs)
+		 || ! tokens.keyword("out") || ! tokens.number(numGateOutputs) || ! tokens.wireList(instructions.wires, entry.num_outputs) ) {
+			printf("Error: unrecognized line: %s\n", string(line_begin, line_end).c_str());
+			exit(-1);
+		}
+
+		if( numGateInputs != entry.num_inputs ) {
+			lineError("input gate mismatch");
+		}
+
+		if( numGateOutputs != entry.num_outputs ) {
+			lineError("output gate mismatch");
+		}
+
+		static const string const_mul_neg("const-mul-neg-");
+		static const string const_mul("const-mul-");
+
+		if (type_str == "add") {
+			entry.opcode = ADD_OPCODE;
+		}
+		else if (type_str == "mul") {
+			entry.opcode = MUL_OPCODE;
+		}
+		else if (type_str == "xor") {
+			entry.opcode = XOR_OPCODE;
+		}
+		else if (type_str == "or") {
+			entry.opcode = OR_OPCODE;
+		}
+		else if (type_str == "assert") {
+			entry.opcode = ASSERT_OPCODE;
+		}
+		else if (type_str == "pack") {
+			entry.opcode = PACK_OPCODE;
+		}
+		else if (type_str == "zerop") {
+			entry.opcode = ZEROP_OPCODE;
+		}
+		else if (type_str == "split") {
+			entry.opcode = SPLIT_OPCODE;
+		}
+		else if (type_str.compare(0, const_mul.size(), const_mul) == 0) {
+			const bool negate = type_str.compare(0, const_mul_neg.size(), const_mul_neg) == 0;
+			entry.opcode = negate ? CONST_MUL_NEG_OPCODE : CONST_MUL_OPCODE;
+
+			// Negated constants are keyed with the '-' before their hex
+			const size_t prefix_length = negate ? const_mul_neg.size() : const_mul.size();
+			token_str.assign(type_str, prefix_length - (negate ? 1 : 0), string::npos);
+
+			auto it = constant_ids.find(token_str);
+			if( it == constant_ids.end() ) {
+				const auto constant = readFieldElementFromHex(type_str.c_str() + prefix_length);
+				it = constant_ids.emplace(token_str, instructions.constants.size()).first;
+				instructions.constants.emplace_back(negate ? constant * FieldT(-1) : constant);
+			}
+			entry.constants_offset = it->second;
 		}
 		else {
-			printf("Error: unrecognized line: %s\n", line.c_str());
-			assert(0);
+			printf("Error: unrecognized line: %s\n", string(line_begin, line_end).c_str());
+			exit(-1);
 		}
-		delete[] inputStr;
-		delete[] outputStr;
-		delete[] tableStr;
+
+		instructions.entries.push_back(entry);
+	});
+
+	if( first_line ) {
+		std::cerr << "File Format Does not Match" << endl;
+		exit(-1);
 	}
-	arithfs.close();
 
 	this->pb.set_input_sizes(numInputs);
 
@@ -391,9 +806,9 @@ void CircuitReader::parseCircuit(const char* arithFilepath)
 
 void CircuitReader::makeAllConstraints( )
 {
-	for( const auto& inst : instructions )
+	for( size_t i = 0; i < instructions.size(); i++ )
 	{
-		makeConstraints( inst );
+		makeConstraints( instructions[i] );
 	}
 }
 
@@ -417,7 +832,7 @@ const char* CircuitInstruction::name( ) const
 }
 
 
-static void printWires( const std::vector<Wire> wire_id_list )
+static void printWires( const InputWires& wire_id_list )
 {
 	bool first = true;
 	cout << "<";
@@ -434,7 +849,7 @@ static void printWires( const std::vector<Wire> wire_id_list )
 }
 
 
-static void printTable( const std::vector<FieldT> &table ) {
+static void printTable( const libsnark::array_view<FieldT> &table ) {
 	bool first = true;
 	cout << "<";
 	for( const auto& item : table ) {
@@ -535,7 +950,7 @@ void CircuitReader::makeConstraints( const CircuitInstruction& inst )
 		addPackConstraint(inWires, outWires);
 	}
 	else if( opcode == TABLE_OPCODE ) {
-		addTableConstraint(inWires, outWires, inst.table);
+		addTableConstraint(inWires, outWires, std::vector<FieldT>(inst.table.begin(), inst.table.end()));
 	}
 
 	if( traceEnabled )
@@ -566,13 +981,17 @@ FieldT CircuitReader::varValue( Wire wire_id )
 
 void CircuitReader::varSet( Wire wire_id, const FieldT& value, const std::string& annotation )
 {
+	// Once constrained, only the wires used by constraints have variables
+	if( constrained && ! varExists(wire_id) ) {
+		return;
+	}
 	this->pb.val(varGet(wire_id, annotation)) = value;
 }
 
 
 bool CircuitReader::varExists( Wire wire_id )
 {
-	return variableMap.find(wire_id) != variableMap.end();
+	return wire_id < wireVariables.size() && wireVariables[wire_id].index != 0;
 }
 
 
@@ -580,8 +999,14 @@ const VariableT& CircuitReader::varNew( Wire wire_id, const std::string &annotat
 {
 	VariableT v;
 	v.allocate(this->pb, annotation);
-	variableMap.emplace(wire_id, v);
-	return variableMap[wire_id];
+	if( wire_id >= wireVariables.size() ) {
+		wireVariables.resize(wire_id + 1);
+	}
+	// A wire declared twice keeps its first variable
+	if( wireVariables[wire_id].index == 0 ) {
+		wireVariables[wire_id] = v;
+	}
+	return wireVariables[wire_id];
 }
 
 
@@ -590,11 +1015,11 @@ const VariableT& CircuitReader::varGet( Wire wire_id, const std::string &annotat
 	if ( ! varExists(wire_id) ) {
 		return varNew(wire_id, annotation);
 	}
-	return variableMap[wire_id];
+	return wireVariables[wire_id];
 }
 
 
-void CircuitReader::addTableConstraint(const InputWires& inputs, const OutputWires& outputs, const std::vector<FieldT> table)
+void CircuitReader::addTableConstraint(const InputWires& inputs, const OutputWires& outputs, const std::vector<FieldT>& table)
 {
 	if( table.size() == 2 ) {
 		lookup_1bit_constraints(pb, table, varGet(inputs[0]), varGet(outputs[0]), "lookup_1bit");
@@ -25,12 +25,15 @@ SOFTWARE.
 
 #include "ethsnarks.hpp"
 
+#include <array>
+#include <string>
+
 
 namespace ethsnarks {
 
 typedef unsigned int Wire;
-typedef std::vector<Wire> InputWires;
-typedef std::vector<Wire> OutputWires;
+typedef libsnark::array_view<Wire> InputWires;
+typedef libsnark::array_view<Wire> OutputWires;
 
 
 enum Opcode {
@@ -54,19 +57,97 @@ struct ZeroEqualityItem {
 };
 
 
+/**
+* One gate of the circuit, the wires and table are views into the pools of
+* the CircuitInstructions it was read from.
+*/
 class CircuitInstruction {
 public:
 	Opcode opcode;
 	FieldT constant;
 	InputWires inputs;
 	OutputWires outputs;
-	std::vector<FieldT> table;
+	libsnark::array_view<FieldT> table;
 
 	const char *name() const;
 	void print() const;
 };
 
 
+/**
+* The gates of a circuit, with the wire ids of all gates in one pool and
+* their constants in another, instead of vectors for each gate. The constants
+* of `const-mul-` gates are stored once however many gates use them.
+*/
+class CircuitInstructions {
+public:
+	struct Entry {
+		uint64_t wires_offset;		// inputs, then outputs
+		uint32_t num_inputs;
+		uint32_t num_outputs;
+		uint32_t constants_offset;	// the constant, or the first table entry
+		uint32_t opcode;
+	};
+
+	std::vector<Entry> entries;
+	std::vector<Wire> wires;
+	std::vector<FieldT> constants;
+
+	size_t size() const {
+		return entries.size();
+	}
+
+	CircuitInstruction operator[]( size_t index ) const;
+};
+
+
+/**
+* Compiled circuit format
+*
+* Written by `pinocchio <circuit.arith> compile`, so an unchanged circuit
+* doesn't have to be parsed and constrained again. The file starts with the
+* constraint system in the binary R1CS format (see r1cs_binary.hpp), so it can
+* be used wherever a binary R1CS is accepted, followed at the next 64 byte
+* boundary by:
+*
+*   header
+*   [entries]      CircuitInstructions::Entry[num_entries]
+*   [wires]        Wire[num_entry_wires], the wire pool of the gates
+*   [constants]    FieldT[num_constants]
+*   [variables]    uint32[num_wire_variables], the variable index of each wire, or 0
+*   [wire ids]     the input, nizk input and output wire ids
+*
+* Offsets are from the start of the header. The header holds the SHA-256 of
+* the `.arith` file, a compiled circuit next to it as `<circuit.arith>.compiled`
+* is only loaded while they match.
+*/
+static const char CIRCUIT_BINARY_MAGIC[8] = {'E', 'S', 'A', 'R', 'I', 'T', 'H', '\0'};
+static const uint32_t CIRCUIT_BINARY_VERSION = 1;
+
+typedef std::array<uint8_t, 32> CircuitHash;
+
+struct circuit_binary_header {
+	char magic[8];
+	uint32_t version;
+	uint32_t reserved;
+	CircuitHash arith_hash;
+	uint64_t num_wires;
+	uint64_t num_inputs;
+	uint64_t num_nizk_inputs;
+	uint64_t num_outputs;
+	uint64_t num_entries;
+	uint64_t num_entry_wires;
+	uint64_t num_constants;
+	uint64_t num_wire_variables;
+	uint64_t entries_offset;
+	uint64_t wires_offset;
+	uint64_t constants_offset;
+	uint64_t variables_offset;
+	uint64_t wire_ids_offset;
+	uint64_t size;
+};
+
+
 class CircuitReader : public GadgetT {
 public:
 	CircuitReader(ProtoboardT& in_pb, const char* arithFilepath, const char* inputsFilepath, bool in_traceEnabled=false);
@@ -79,16 +160,30 @@ public:
 		return numOutputs;
 	}
 
-	const InputWires& getInputWireIds() const {
+	const std::vector<Wire>& getInputWireIds() const {
 		return inputWireIds;
 	}
 
-	const OutputWires& getOutputWireIds() const {
+	const std::vector<Wire>& getOutputWireIds() const {
 		return outputWireIds;
 	}
 
 	void parseInputs( const char *inputsFilepath );
 
+	void evaluate( const char *inputsFilepath );
+
+	/**
+	* Write the circuit with its constraints in the compiled form, the
+	* reader must have been created without inputs. Returns false on any
+	* write error.
+	*/
+	bool writeCompiled( const char *outputFilepath );
+
+	/** SHA-256 of the `.arith` file, which its compiled form is keyed by */
+	const CircuitHash& getArithHash();
+
+	static bool isCompiled( const char *filepath );
+
 	void varSet( Wire wire_id, const FieldT& value, const std::string &annotation="" );
 	FieldT varValue( Wire wire_id );
 	bool varExists( Wire wire_id );
@@ -98,11 +193,12 @@ public:
 	bool traceEnabled;
 
 protected:
-	std::map<Wire,VariableT> variableMap;
+	// Indexed by wire id, wires without a variable yet have index 0
+	std::vector<VariableT> wireVariables;
 
 	std::vector<ZeroEqualityItem> zerop_items;
 
-	std::vector<CircuitInstruction> instructions;
+	CircuitInstructions instructions;
 
 	std::vector<Wire> inputWireIds;
 	std::vector<Wire> nizkWireIds;
@@ -113,7 +209,17 @@ protected:
 	size_t numNizkInputs {0};
 	size_t numOutputs{0};
 
+	std::string arithPath;
+	CircuitHash arithHash;
+	bool arithHashed {false};
+
+	// The variables and constraints are all on the protoboard
+	bool constrained {false};
+
+	bool loadCompiled( const char *arithFilepath );
+	bool readCompiled( const char *compiledFilepath, const CircuitHash *expectedHash );
 	void parseCircuit(const char* arithFilepath);
+	void evalInstructions();
 	void evalInstruction( const CircuitInstruction &inst );
 	void makeAllConstraints( );
 	void makeConstraints( const CircuitInstruction& inst );
@@ -130,7 +236,7 @@ protected:
 	void addPackConstraint(const InputWires& inputs, const OutputWires& outputs);
 	void addNonzeroCheckConstraint(const InputWires& inputs, const OutputWires& outputs);
 
-	void addTableConstraint(const InputWires& inputs, const OutputWires& outputs, const std::vector<FieldT> table);
+	void addTableConstraint(const InputWires& inputs, const OutputWires& outputs, const std::vector<FieldT>& table);
 
 	void handleAddition(const InputWires& inputs, const OutputWires& outputs);
 	void handleMulConst(const InputWires& inputs, const OutputWires& outputs, const FieldT& constant);
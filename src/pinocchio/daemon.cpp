@@ -0,0 +1,215 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+* Resident prover for Pinocchio circuits
+*
+* Reads one command per line from stdin and writes one response line per
+* command to stdout. Proving keys stay loaded between commands, along with
+* the FFT domain and prover buffers, and each circuit is parsed and
+* constrained once, so repeated proofs only pay for evaluating the circuit,
+* the witness map and the multi-exponentiations.
+*
+* Usage: pinocchio_daemon [-m <megabytes>] [proving-key ...]
+*
+* With `-m` proving keys in the mapped format are streamed from disk during
+* each proof, holding at most that much of the key in memory.
+*
+* Commands:
+*
+*   load <proving-key>
+*   prove <circuit.arith> <circuit.inputs> <proving-key> <output-proof.json>
+*   unload <proving-key|circuit.arith>
+*   quit
+*
+* Responses are `ok` or `error <message>`. Anything else the prover prints
+* (profiling, diagnostics) is sent to stderr so it can't corrupt the stream.
+*/
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+
+#ifdef _WIN32
+#include <io.h>
+#define dup _dup
+#define dup2 _dup2
+#define fdopen _fdopen
+#else
+#include <unistd.h>
+#endif
+
+#include "circuit_reader.hpp"
+#include "prover_service.hpp"
+#include "utils.hpp"
+
+using ethsnarks::ppT;
+using ethsnarks::CircuitReader;
+using ethsnarks::ProtoboardT;
+using ethsnarks::ProverService;
+
+using std::ofstream;
+using std::cerr;
+using std::endl;
+using std::string;
+
+
+/**
+* The byte count of a whole number of megabytes, false if `arg` is not one or
+* the bytes don't fit in a size_t
+*/
+static bool parse_megabytes( const char *arg, size_t& bytes )
+{
+	if( arg[0] < '0' || arg[0] > '9' ) {
+		return false;
+	}
+
+	char *end = nullptr;
+	errno = 0;
+	const unsigned long long megabytes = strtoull(arg, &end, 10);
+	if( errno != 0 || *end != '\0' || megabytes > (SIZE_MAX >> 20) ) {
+		return false;
+	}
+
+	bytes = size_t(megabytes) << 20;
+	return true;
+}
+
+
+static void respond( FILE *out, const string& message )
+{
+	fprintf(out, "%s\n", message.c_str());
+	fflush(out);
+}
+
+
+/**
+* A circuit with its constraints, kept between proofs, only the values of
+* its protoboard change
+*/
+struct LoadedCircuit {
+	ProtoboardT pb;
+	std::unique_ptr<CircuitReader> reader;
+};
+
+
+typedef std::map<string, std::unique_ptr<LoadedCircuit> > CircuitMap;
+
+
+static LoadedCircuit& get_circuit( CircuitMap& circuits, const string& arith_file )
+{
+	auto& entry = circuits[arith_file];
+	if( ! entry ) {
+		entry.reset(new LoadedCircuit);
+		entry->reader.reset(new CircuitReader(entry->pb, arith_file.c_str(), nullptr));
+	}
+	return *entry;
+}
+
+
+static string handle_prove( ProverService& service, CircuitMap& circuits, const string& arith_file, const string& circuit_inputs, const string& pk_file, const string& proof_json )
+{
+	auto& circuit = get_circuit(circuits, arith_file);
+	circuit.reader->evaluate(circuit_inputs.c_str());
+	ProtoboardT& pb = circuit.pb;
+
+	if( ! ethsnarks::check_satisfied(pb) ) {
+		return "error not satisfied";
+	}
+
+	auto json = service.prove_json(pk_file, pb);
+
+	ofstream fh;
+	fh.open(proof_json, std::ios::binary);
+	fh << json;
+	fh.flush();
+	fh.close();
+	if( fh.fail() ) {
+		return "error cannot write " + proof_json;
+	}
+
+	return "ok";
+}
+
+
+int main( int argc, char **argv )
+{
+	ppT::init_public_params();
+
+	// Keep the real stdout for responses, everything else goes to stderr
+	FILE *out = fdopen(dup(1), "w");
+	if( out == nullptr ) {
+		cerr << "Error: cannot duplicate stdout" << endl;
+		return 1;
+	}
+	dup2(2, 1);
+
+	// With `-m <megabytes>` mapped keys are streamed from disk within that budget
+	libsnark::Config config;
+	int first_key = 1;
+	if( argc > 1 && string(argv[1]) == "-m" ) {
+		if( argc < 3 || ! parse_megabytes(argv[2], config.stream_memory_budget) ) {
+			cerr << "Usage: " << argv[0] << " [-m <megabytes>] [proving-key ...]" << endl;
+			return 1;
+		}
+		first_key = 3;
+	}
+
+	ProverService service(config);
+	CircuitMap circuits;
+
+	// Keys given on the command line are loaded up-front
+	for( int i = first_key; i < argc; i++ ) {
+		if( ! service.load(argv[i]) ) {
+			return 2;
+		}
+	}
+
+	string line;
+	while( std::getline(std::cin, line) )
+	{
+		std::istringstream cmdline(line);
+		string cmd;
+		if( ! (cmdline >> cmd) ) {
+			continue;
+		}
+
+		std::vector<string> args;
+		string arg;
+		while( cmdline >> arg ) {
+			args.emplace_back(arg);
+		}
+
+		try {
+			if( cmd == "prove" && args.size() == 4 ) {
+				respond(out, handle_prove(service, circuits, args[0], args[1], args[2], args[3]));
+			}
+			else if( cmd == "load" && args.size() == 1 ) {
+				respond(out, service.load(args[0]) ? "ok" : "error cannot load " + args[0]);
+			}
+			else if( cmd == "unload" && args.size() == 1 ) {
+				service.unload(args[0]);
+				circuits.erase(args[0]);
+				respond(out, "ok");
+			}
+			else if( cmd == "quit" ) {
+				respond(out, "ok");
+				break;
+			}
+			else {
+				respond(out, "error unknown command: " + line);
+			}
+		}
+		catch( const std::exception& ex ) {
+			respond(out, string("error ") + ex.what());
+		}
+	}
+
+	fclose(out);
+	return 0;
+}
@@ -1,14 +1,25 @@
 // This is an open source non-commercial project. Dear PVS-Studio, please check it.
 // PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
 
+#include <cstdlib>
+
 #include "circuit_reader.hpp"
+#include "r1cs_binary.hpp"
 #include "stubs.hpp"
+#include "witness_binary.hpp"
 
 using ethsnarks::ppT;
 using ethsnarks::CircuitReader;
 using ethsnarks::ProtoboardT;
+using ethsnarks::CompactConstraintsT;
+using ethsnarks::FieldT;
 using ethsnarks::stub_prove_from_pb;
+using ethsnarks::stub_prove_from_compact;
 using ethsnarks::stub_genkeys_from_pb;
+using ethsnarks::stub_genkeys_from_compact;
+using ethsnarks::stub_genkeys_mapped_from_pb;
+using ethsnarks::stub_genkeys_mapped_from_compact;
+using ethsnarks::stub_genkeys_incremental_from_pb;
 using ethsnarks::stub_main_verify;
 
 using std::ofstream;
@@ -18,27 +29,169 @@ using std::endl;
 using std::string;
 
 
-static int main_genkeys( ProtoboardT& pb, const char *arith_file, const char *pk_raw, const char *vk_json )
+/**
+* A binary R1CS holds only the constraints. A compiled circuit (see the
+* 'compile' command) is a binary R1CS followed by the circuit, so it can
+* still be evaluated and goes through CircuitReader like a .arith file.
+*/
+static bool is_constraints_only( const char *arith_file )
+{
+	return ethsnarks::is_r1cs_binary(arith_file) && ! CircuitReader::isCompiled(arith_file);
+}
+
+
+/**
+* A binary R1CS goes straight into the compact form used by the key
+* generators and the prover, without building the constraint objects
+*/
+static void load_r1cs_compact( const char *r1cs_file, CompactConstraintsT& constraints )
+{
+	ethsnarks::R1CSBinaryFile(r1cs_file).load_compact(constraints, libsnark::Config());
+}
+
+
+static int main_genkeys( ProtoboardT& pb, const char *arith_file, const char *pk_raw, const char *vk_json, const char *toxic_waste )
 {
+	// A binary R1CS only holds the constraints, there is no witness to check
+	if( is_constraints_only(arith_file) ) {
+		CompactConstraintsT constraints;
+		load_r1cs_compact(arith_file, constraints);
+		return stub_genkeys_from_compact(constraints, pk_raw, vk_json, toxic_waste);
+	}
+
 	CircuitReader circuit(pb, arith_file, nullptr);
 
-	if( ! pb.is_satisfied() ) {
+	if( ! ethsnarks::check_satisfied(pb) ) {
 		cerr << "Error: not satisfied!" << endl;
 	}
 
-	return stub_genkeys_from_pb(pb, pk_raw, vk_json);
+	return stub_genkeys_from_pb(pb, pk_raw, vk_json, toxic_waste);
 }
 
 
-static int main_prove( ProtoboardT& pb, const char *arith_file, const char *circuit_inputs, const char* pk_raw, const char *proof_json )
+static int main_r1cs( ProtoboardT& pb, const char *arith_file, const char *r1cs_file )
+{
+	CircuitReader circuit(pb, arith_file, nullptr);
+
+	if( ! ethsnarks::r1cs2binary(pb, r1cs_file) ) {
+		cerr << "Error: cannot write " << r1cs_file << endl;
+		return 2;
+	}
+
+	return 0;
+}
+
+
+static int main_compile( ProtoboardT& pb, const char *arith_file, const char *compiled_file )
+{
+	CircuitReader circuit(pb, arith_file, nullptr);
+
+	if( ! circuit.writeCompiled(compiled_file) ) {
+		cerr << "Error: cannot write " << compiled_file << endl;
+		return 2;
+	}
+
+	return 0;
+}
+
+
+static int main_genkeys_update( ProtoboardT& pb, const char *arith_file, const char *previous_arith_file, const char *toxic_waste, const char *previous_pk_raw, const char *pk_raw, const char *vk_json )
+{
+	CircuitReader circuit(pb, arith_file, nullptr);
+
+	ProtoboardT previous_pb;
+	CircuitReader previous_circuit(previous_pb, previous_arith_file, nullptr);
+
+	return stub_genkeys_incremental_from_pb(previous_pb, pb, toxic_waste, previous_pk_raw, pk_raw, vk_json);
+}
+
+
+static int main_genkeys_mapped( ProtoboardT& pb, const char *arith_file, const char *pk_mapped, const char *vk_json, size_t memory_budget )
+{
+	if( is_constraints_only(arith_file) ) {
+		CompactConstraintsT constraints;
+		load_r1cs_compact(arith_file, constraints);
+		return stub_genkeys_mapped_from_compact(constraints, pk_mapped, vk_json, memory_budget);
+	}
+
+	CircuitReader circuit(pb, arith_file, nullptr);
+
+	return stub_genkeys_mapped_from_pb(pb, pk_mapped, vk_json, memory_budget);
+}
+
+
+static int main_witness( ProtoboardT& pb, const char *arith_file, const char *circuit_inputs, const char *witness_file )
 {
 	CircuitReader circuit(pb, arith_file, circuit_inputs);
 
-	if( ! pb.is_satisfied() ) {
+	if( ! ethsnarks::check_satisfied(pb) ) {
+		cerr << "Error: not satisfied!" << endl;
+	}
+
+	if( ! ethsnarks::witness2binary(pb, witness_file) ) {
+		cerr << "Error: cannot write " << witness_file << endl;
+		return 2;
+	}
+
+	return 0;
+}
+
+
+static int main_prove_compact( const char *r1cs_file, const char *witness_file, const char* pk_raw, string& json )
+{
+	CompactConstraintsT constraints;
+	load_r1cs_compact(r1cs_file, constraints);
+
+	const ethsnarks::WitnessBinaryFile witness(witness_file);
+	std::vector<FieldT> values;
+	witness.load(values);
+	if( values.size() != constraints.num_variables + 1 || witness.num_inputs() != constraints.num_inputs ) {
+		cerr << "Error: the witness " << witness_file << " does not match the circuit " << r1cs_file << endl;
+		return 2;
+	}
+
+	if( ! ethsnarks::check_satisfied(constraints, values) ) {
 		cerr << "Error: not satisfied!" << endl;
 	}
 
-    auto json = stub_prove_from_pb(pb, pk_raw);
+	json = stub_prove_from_compact(constraints, values, pk_raw);
+	return 0;
+}
+
+
+static int main_prove( ProtoboardT& pb, const char *arith_file, const char *circuit_inputs, const char* pk_raw, const char *proof_json )
+{
+	const bool is_witness = ethsnarks::is_witness_binary(circuit_inputs);
+	string json;
+
+	if( is_constraints_only(arith_file) ) {
+		// Only the circuit can compute the witness from its inputs
+		if( ! is_witness ) {
+			cerr << "Error: " << arith_file << " is a binary R1CS, which needs a witness written by the 'witness' command rather than the inputs " << circuit_inputs << endl;
+			return 5;
+		}
+
+		const int result = main_prove_compact(arith_file, circuit_inputs, pk_raw, json);
+		if( result != 0 ) {
+			return result;
+		}
+	}
+	else {
+		// A witness written by the 'witness' command only needs the constraints
+		if( is_witness ) {
+			CircuitReader circuit(pb, arith_file, nullptr);
+			ethsnarks::WitnessBinaryFile(circuit_inputs).load(pb);
+		}
+		else {
+			CircuitReader circuit(pb, arith_file, circuit_inputs);
+		}
+
+		if( ! ethsnarks::check_satisfied(pb) ) {
+			cerr << "Error: not satisfied!" << endl;
+		}
+
+		json = stub_prove_from_pb(pb, pk_raw);
+	}
 
     ofstream fh;
     fh.open(proof_json, std::ios::binary);
@@ -67,7 +220,7 @@ static int main_eval( ProtoboardT& pb, const char *arith_file, const char *circu
 {
 	CircuitReader circuit(pb, arith_file, circuit_inputs, traceEnabled);
 
-	if( ! pb.is_satisfied() ) {
+	if( ! ethsnarks::check_satisfied(pb) ) {
 		cerr << "Error: not satisfied!" << endl;
 	}
 
@@ -90,7 +243,7 @@ int main(int argc, char **argv)
 	const string progname(argv[0]);
 	const string usage_prefix(string("Usage: ") + progname + " <circuit.arith> ");
 	if( argc < 3 ) {
-		cerr << usage_prefix << "<genkeys|prove|verify|eval|trace|test>" << endl;
+		cerr << usage_prefix << "<compile|genkeys|genkeys-mapped|genkeys-update|r1cs|witness|prove|verify|eval|trace|test>" << endl;
 		return 1;
 	}
 
@@ -100,18 +253,61 @@ int main(int argc, char **argv)
 	int sub_argc = argc - 3;
 	const char **sub_argv = (const char**)&argv[3];
 
+	// The other commands evaluate the circuit, which a binary R1CS does not hold
+	if( cmd != "genkeys" && cmd != "genkeys-mapped" && cmd != "prove" && cmd != "verify" && is_constraints_only(arith_file) ) {
+		cerr << "Error: " << arith_file << " is a binary R1CS, '" << cmd << "' needs the .arith circuit" << endl;
+		return 5;
+	}
+
 	if( cmd == "genkeys" ) {
 		if( sub_argc < 2 ) {
-			cerr << usage_prefix << cmd << " <proving-key.raw> <verification-key.json>" << endl;
+			cerr << usage_prefix << cmd << " <proving-key.raw> <verification-key.json> [toxic-waste.txt]" << endl;
 			return 5;
 		}
 		const char *pk_raw = sub_argv[0];
 		const char *vk_json = sub_argv[1];
-		return main_genkeys(pb, arith_file, pk_raw, vk_json );
+		const char *toxic_waste = sub_argc > 2 ? sub_argv[2] : nullptr;
+		return main_genkeys(pb, arith_file, pk_raw, vk_json, toxic_waste );
+	}
+	else if( cmd == "genkeys-update" ) {
+		if( sub_argc < 5 ) {
+			cerr << usage_prefix << cmd << " <previous-circuit.arith> <toxic-waste.txt> <previous-proving-key.raw> <proving-key.raw> <verification-key.json>" << endl;
+			return 5;
+		}
+		return main_genkeys_update(pb, arith_file, sub_argv[0], sub_argv[1], sub_argv[2], sub_argv[3], sub_argv[4] );
+	}
+	else if( cmd == "genkeys-mapped" ) {
+		if( sub_argc < 2 ) {
+			cerr << usage_prefix << cmd << " <proving-key.map> <verification-key.json> [memory-megabytes]" << endl;
+			return 5;
+		}
+		const char *pk_mapped = sub_argv[0];
+		const char *vk_json = sub_argv[1];
+		const size_t memory_budget = sub_argc > 2 ? (size_t(atoll(sub_argv[2])) << 20) : 0;
+		return main_genkeys_mapped(pb, arith_file, pk_mapped, vk_json, memory_budget );
+	}
+	else if( cmd == "compile" ) {
+		// Next to the circuit it is used instead of parsing it, while the circuit is unchanged
+		const string compiled_file = sub_argc > 0 ? string(sub_argv[0]) : (string(arith_file) + ".compiled");
+		return main_compile(pb, arith_file, compiled_file.c_str());
+	}
+	else if( cmd == "r1cs" ) {
+		if( sub_argc < 1 ) {
+			cerr << usage_prefix << cmd << " <output.r1cs>" << endl;
+			return 5;
+		}
+		return main_r1cs(pb, arith_file, sub_argv[0]);
+	}
+	else if( cmd == "witness" ) {
+		if( sub_argc < 2 ) {
+			cerr << usage_prefix << cmd << " <circuit.inputs> <output.witness>" << endl;
+			return 5;
+		}
+		return main_witness(pb, arith_file, sub_argv[0], sub_argv[1]);
 	}
 	else if( cmd == "prove" ) {
 		if( sub_argc < 3 ) {
-			cerr << usage_prefix << cmd << " <circuit.inputs> <proving-key.raw> <output-proof.json>" << endl;
+			cerr << usage_prefix << cmd << " <circuit.inputs|circuit.witness> <proving-key.raw> <output-proof.json>" << endl;
 			return 5;
 		}
 		const char *circuit_inputs = sub_argv[0];
@@ -121,10 +317,10 @@ int main(int argc, char **argv)
 	}
 	else if( cmd == "verify" ) {
 		if( sub_argc < 2 ) {
-			cerr << usage_prefix << cmd << " <verification-key.json> <proof.json>" << endl;
+			cerr << usage_prefix << cmd << " <verification-key.json> <proof.json> [proof.json ...]" << endl;
 			return 5;
 		}
-		return stub_main_verify("", 3, (const char**)&argv[2]);
+		return stub_main_verify("", sub_argc + 1, (const char**)&argv[2]);
 	}
 	else if( cmd == "test" ) {
 		if( sub_argc == 0 ) {
@@ -1,6 +1,7 @@
 #ifndef ETHSNARKS_PROVER_CONFIG_HPP_
 #define ETHSNARKS_PROVER_CONFIG_HPP_
 
+#include <string>
 #include <vector>
 
 namespace libsnark {
@@ -21,17 +22,31 @@ struct Config
         multi_exp_prefetch_locality = 0;
         prefetch_stride = 128;
         multi_exp_look_ahead = 1;
+        task_scheduler = false;
+        multi_exp_A = "BDLO12";
+        multi_exp_B = "BDLO12";
+        multi_exp_H = "BDLO12";
+        multi_exp_L = "BDLO12";
+        multi_exp_batch_affine = true;
+        stream_memory_budget = 0;
     }
 
     unsigned int num_threads;
     bool smt;
-    std::string fft;
+    std::string fft;                            // "recursive", "basic_radix2" or "stockham"
     std::vector<unsigned int> radixes;
     bool swapAB;
     unsigned int multi_exp_c;
     unsigned int multi_exp_prefetch_locality;   // 4 == no prefetching, [0, 3] prefetch locality
     unsigned int prefetch_stride;               // 4 * L1_CACHE_BYTES
     unsigned int multi_exp_look_ahead;
+    bool task_scheduler;                        // run the prover MSMs and H computation as concurrent tasks, in chunks for the "pippenger" queries
+    std::string multi_exp_A;                    // multi-exp engine per query, "BDLO12" or "pippenger" (keys used in place always use "pippenger")
+    std::string multi_exp_B;
+    std::string multi_exp_H;
+    std::string multi_exp_L;
+    bool multi_exp_batch_affine;                // accumulate G1 buckets in affine form, with batched inversions
+    size_t stream_memory_budget;                // bytes of key held in memory when streaming a mapped key from or to disk, 0 = map the whole key
 };
 
 static std::ostream &operator<<(std::ostream &os, const Config& c)
@@ -51,7 +66,11 @@ static std::ostream &operator<<(std::ostream &os, const Config& c)
     "exp_c: " << c.multi_exp_c << ", " <<
     "pre_stride: " << c.prefetch_stride << ", " <<
     "exp_preloc: " << c.multi_exp_prefetch_locality << ", " <<
-    "exp_lookahead: " << c.multi_exp_look_ahead;
+    "exp_lookahead: " << c.multi_exp_look_ahead << ", " <<
+    "tasks: " << c.task_scheduler << ", " <<
+    "multi_exp: [" << c.multi_exp_A << "," << c.multi_exp_B << "," << c.multi_exp_H << "," << c.multi_exp_L << "], " <<
+    "batch_affine: " << c.multi_exp_batch_affine << ", " <<
+    "stream_budget: " << c.stream_memory_budget;
 }
 
 static inline std::vector<std::pair<unsigned int, unsigned int>> get_cpu_ranges(unsigned int startIdx, unsigned int length, unsigned int num_threads = 0)
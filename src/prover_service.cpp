@@ -0,0 +1,188 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+#include <stdexcept>
+
+#include "prover_service.hpp"
+#include "stubs.hpp"
+#include "utils.hpp"
+
+#include "r1cs_gg_ppzksnark_zok/r1cs_gg_ppzksnark_zok.hpp"
+
+
+namespace ethsnarks {
+
+
+/**
+* Points a context at the constraint system of one proof and clears the
+* pointer again when it goes out of scope, also when the prover throws, so
+* a cached context never keeps a pointer to a freed constraint system
+*/
+template<typename PointerT>
+class ScopedContextPointer
+{
+public:
+    ScopedContextPointer( PointerT& in_pointer, PointerT value ) :
+        m_pointer(in_pointer)
+    {
+        m_pointer = value;
+    }
+
+    ~ScopedContextPointer()
+    {
+        m_pointer = nullptr;
+    }
+
+private:
+    PointerT& m_pointer;
+};
+
+
+ProverService::ProverService( const libsnark::Config& in_config ) :
+    m_config(in_config)
+{ }
+
+
+ProverService::LoadedKey& ProverService::get( const std::string& pk_file )
+{
+    auto it = m_keys.find(pk_file);
+    if( it != m_keys.end() ) {
+        return it->second;
+    }
+
+    LoadedKey entry;
+    const bool is_mapped = libsnark::is_mapped_proving_key(pk_file);
+    if( is_mapped && m_config.stream_memory_budget > 0 )
+    {
+        // Read from disk in chunks during each proof, precomputed tables aren't used
+        entry.stream_key.reset(new StreamProvingKeyT(pk_file));
+        entry.context.reset(new ProverContextT(*entry.stream_key));
+        entry.context->config = m_config;
+        entry.context->constraint_system = nullptr;
+        return m_keys.emplace(pk_file, std::move(entry)).first->second;
+    }
+    else if( is_mapped )
+    {
+        entry.mapped_key.reset(new MappedProvingKeyT(pk_file));
+        entry.mapped_key->prefetch();
+        entry.context.reset(new ProverContextT(*entry.mapped_key));
+    }
+    else {
+        entry.key.reset(new ProvingKeyT(loadFromFile<ProvingKeyT>(pk_file)));
+        entry.context.reset(new ProverContextT(*entry.key));
+    }
+    entry.context->config = m_config;
+    entry.context->constraint_system = nullptr;
+
+    const auto tables_file = libsnark::precomputed_tables_path(pk_file);
+    if( std::ifstream(tables_file).good() )
+    {
+        entry.tables.reset(new PrecomputedTablesT(tables_file));
+
+        // Tables left over from a previous key are ignored
+        const bool matches = entry.mapped_key ? entry.tables->matches(*entry.mapped_key) : entry.tables->matches(*entry.key);
+        if( matches ) {
+            entry.tables->prefetch();
+            entry.context->precomputedTables = entry.tables.get();
+        }
+        else {
+            std::cerr << "Warning: ignoring " << tables_file << ", it was not computed from " << pk_file << std::endl;
+            entry.tables.reset();
+        }
+    }
+
+    return m_keys.emplace(pk_file, std::move(entry)).first->second;
+}
+
+
+bool ProverService::load( const std::string& pk_file )
+{
+    try {
+        get(pk_file);
+    }
+    catch( const std::exception& ex ) {
+        std::cerr << "Error: cannot load " << pk_file << ": " << ex.what() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+
+void ProverService::unload( const std::string& pk_file )
+{
+    m_keys.erase(pk_file);
+}
+
+
+ProverContextT& ProverService::prepare( const std::string& pk_file, size_t domain_size )
+{
+    auto& context = *get(pk_file).context;
+
+    // The domain depends only on the circuit size, so it is built once per key
+    if( ! context.domain || context.domain->m != domain_size ) {
+        context.domain = get_domain(domain_size, context.config);
+    }
+
+    return context;
+}
+
+
+ProofT ProverService::prove( const std::string& pk_file, ProtoboardT& pb )
+{
+    auto& context = prepare(pk_file, get_domain_size(pb));
+    ScopedContextPointer<decltype(context.constraint_system)> constraint_system(context.constraint_system, &pb.constraint_system);
+
+    return libsnark::r1cs_gg_ppzksnark_zok_prover<ppT>(context, pb.values);
+}
+
+
+ProofT ProverService::prove( const std::string& pk_file, const CompactConstraintsT& constraints, const std::vector<FieldT>& values )
+{
+    if( values.size() != constraints.num_variables + 1 ) {
+        throw std::invalid_argument("Assignment does not match the constraint system");
+    }
+
+    auto& context = prepare(pk_file, get_domain_size(constraints));
+    ScopedContextPointer<decltype(context.compact_constraint_system)> constraint_system(context.compact_constraint_system, &constraints);
+
+    return libsnark::r1cs_gg_ppzksnark_zok_prover<ppT>(context, values);
+}
+
+
+std::vector<ProofT> ProverService::prove_batch( const std::string& pk_file, const std::vector<ProtoboardT*>& pbs )
+{
+    if( pbs.empty() ) {
+        return std::vector<ProofT>();
+    }
+
+    auto& context = prepare(pk_file, get_domain_size(*pbs[0]));
+    ScopedContextPointer<decltype(context.constraint_system)> constraint_system(context.constraint_system, &pbs[0]->constraint_system);
+
+    std::vector<std::vector<FieldT>> assignments;
+    assignments.reserve(pbs.size());
+    for( const auto pb : pbs ) {
+        assignments.emplace_back(pb->values);
+    }
+
+    return libsnark::r1cs_gg_ppzksnark_zok_prover_batch<ppT>(context, assignments);
+}
+
+
+std::string ProverService::prove_json( const std::string& pk_file, ProtoboardT& pb )
+{
+    auto proof = prove(pk_file, pb);
+    auto primary_input = pb.primary_input();
+    return proof_to_json(proof, primary_input);
+}
+
+
+std::string ProverService::prove_json( const std::string& pk_file, const CompactConstraintsT& constraints, const std::vector<FieldT>& values )
+{
+    auto proof = prove(pk_file, constraints, values);
+    PrimaryInputT primary_input(values.begin() + 1, values.begin() + 1 + constraints.num_inputs);
+    return proof_to_json(proof, primary_input);
+}
+
+
+// namespace ethsnarks
+}
@@ -0,0 +1,87 @@
+#ifndef ETHSNARKS_PROVER_SERVICE_HPP_
+#define ETHSNARKS_PROVER_SERVICE_HPP_
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ethsnarks.hpp"
+
+
+namespace ethsnarks {
+
+
+/**
+* Keeps proving keys resident between proofs.
+*
+* Each proving key is loaded once (memory mapped if it is in the mapped
+* format), along with its precomputed tables if there is a tables file
+* next to it, and owns a `ProverContext`, so the evaluation domain and the
+* `aA`, `aB`, `aH` and `scratch_exponents` buffers are re-used by every
+* proof made with that key. The per-proof cost is then only the witness
+* map and the multi-exponentiations.
+*
+* When `stream_memory_budget` is set in the config, keys in the mapped
+* format are instead read from disk in chunks during each proof, so keys
+* larger than the available memory can be used.
+*
+* Not thread-safe, each context is used by one proof at a time.
+*/
+class ProverService
+{
+public:
+    ProverService( const libsnark::Config& in_config = libsnark::Config() );
+
+    /** Prove the protoboard using the key at `pk_file`, loading it if necessary */
+    ProofT prove( const std::string& pk_file, ProtoboardT& pb );
+
+    /**
+    * Prove several protoboards of the same circuit in one pass over the key,
+    * the constraint system of the first protoboard is used for all of them.
+    */
+    std::vector<ProofT> prove_batch( const std::string& pk_file, const std::vector<ProtoboardT*>& pbs );
+
+    /**
+    * Prove an assignment of a constraint system in compact form, e.g. from
+    * `R1CSBinaryFile::load_compact`, without any constraint objects
+    */
+    ProofT prove( const std::string& pk_file, const CompactConstraintsT& constraints, const std::vector<FieldT>& values );
+
+    /** Prove, returning the proof and public inputs as JSON */
+    std::string prove_json( const std::string& pk_file, ProtoboardT& pb );
+
+    std::string prove_json( const std::string& pk_file, const CompactConstraintsT& constraints, const std::vector<FieldT>& values );
+
+    /** Load the key in advance, returns false if it cannot be loaded */
+    bool load( const std::string& pk_file );
+
+    /** Release the key and its buffers */
+    void unload( const std::string& pk_file );
+
+    size_t num_loaded() const {
+        return m_keys.size();
+    }
+
+protected:
+    struct LoadedKey {
+        std::unique_ptr<ProvingKeyT> key;
+        std::unique_ptr<MappedProvingKeyT> mapped_key;
+        std::unique_ptr<StreamProvingKeyT> stream_key;
+        std::unique_ptr<PrecomputedTablesT> tables;
+        std::unique_ptr<ProverContextT> context;
+    };
+
+    LoadedKey& get( const std::string& pk_file );
+
+    ProverContextT& prepare( const std::string& pk_file, size_t domain_size );
+
+    const libsnark::Config m_config;
+    std::map<std::string, LoadedKey> m_keys;
+};
+
+
+// namespace ethsnarks
+}
+
+#endif
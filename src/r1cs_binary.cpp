@@ -0,0 +1,380 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <stdexcept>
+
+#include "r1cs_binary.hpp"
+
+namespace ethsnarks {
+
+
+static const size_t R1CS_BINARY_ALIGN = 64;
+
+
+static inline uint64_t r1cs_binary_align( uint64_t offset )
+{
+    return (offset + R1CS_BINARY_ALIGN - 1) & ~uint64_t(R1CS_BINARY_ALIGN - 1);
+}
+
+
+static inline void append_bytes( std::vector<uint8_t> &out, const void *data, size_t size )
+{
+    const auto *bytes = static_cast<const uint8_t*>(data);
+    out.insert(out.end(), bytes, bytes + size);
+}
+
+
+size_t R1CSBinaryWriter::CoefficientHash::operator()( const CoefficientKey &key ) const
+{
+    // FNV-1a
+    uint64_t hash = 14695981039346656037ULL;
+    for( const auto byte : key ) {
+        hash = (hash ^ byte) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+
+R1CSBinaryWriter::R1CSBinaryWriter( const std::string &path, bool compress_coefficients )
+{
+    m_out.open(path, std::ios::binary | std::ios::trunc);
+    if( ! m_out.is_open() ) {
+        throw std::runtime_error("Cannot open file: " + path);
+    }
+
+    ::memset(&m_header, 0, sizeof(m_header));
+    ::memcpy(m_header.magic, R1CS_BINARY_MAGIC, sizeof(R1CS_BINARY_MAGIC));
+    m_header.version = R1CS_BINARY_VERSION;
+    m_header.byte_order = libsnark::MAPPED_PK_BYTE_ORDER;
+    m_header.field_size = sizeof(FieldT);
+    m_header.flags = compress_coefficients ? R1CS_BINARY_COMPRESSED : 0;
+    m_header.constraints_offset = r1cs_binary_align(sizeof(m_header));
+
+    m_out.seekp(m_header.constraints_offset);
+}
+
+
+void R1CSBinaryWriter::add_terms( const libsnark::linear_combination_light<FieldT> &lc )
+{
+    const bool compressed = (m_header.flags & R1CS_BINARY_COMPRESSED) != 0;
+    for( const auto &term : lc.getTerms() )
+    {
+        const uint32_t index = term.index;
+        append_bytes(m_record, &index, sizeof(index));
+
+        const FieldT coeff = term.getCoeff();
+        if( ! compressed ) {
+            append_bytes(m_record, &coeff, sizeof(coeff));
+            continue;
+        }
+
+        CoefficientKey key;
+        ::memcpy(key.data(), &coeff, sizeof(coeff));
+        auto it = m_coefficient_ids.find(key);
+        if( it == m_coefficient_ids.end() ) {
+            if( m_coefficients.size() >= UINT32_MAX ) {
+                throw std::runtime_error("Binary R1CS: too many distinct coefficients");
+            }
+            it = m_coefficient_ids.emplace(key, m_coefficients.size()).first;
+            m_coefficients.emplace_back(coeff);
+        }
+        append_bytes(m_record, &it->second, sizeof(it->second));
+    }
+}
+
+
+void R1CSBinaryWriter::add( const libsnark::linear_combination_light<FieldT> &A,
+                            const libsnark::linear_combination_light<FieldT> &B,
+                            const libsnark::linear_combination_light<FieldT> &C )
+{
+    const uint32_t counts[3] = {
+        uint32_t(A.getTerms().size()),
+        uint32_t(B.getTerms().size()),
+        uint32_t(C.getTerms().size())
+    };
+
+    m_record.clear();
+    append_bytes(m_record, counts, sizeof(counts));
+    add_terms(A);
+    add_terms(B);
+    add_terms(C);
+    m_out.write(reinterpret_cast<const char*>(m_record.data()), m_record.size());
+
+    m_header.num_constraints += 1;
+    m_header.num_terms += counts[0] + counts[1] + counts[2];
+}
+
+
+bool R1CSBinaryWriter::finish( size_t num_inputs, size_t num_variables )
+{
+    m_header.num_inputs = num_inputs;
+    m_header.num_variables = num_variables;
+    m_header.num_coefficients = m_coefficients.size();
+    m_header.coefficients_offset = r1cs_binary_align(m_out.tellp());
+    m_header.file_size = m_header.coefficients_offset + (m_coefficients.size() * sizeof(FieldT));
+
+    m_out.seekp(m_header.coefficients_offset);
+    if( ! m_coefficients.empty() ) {
+        m_out.write(reinterpret_cast<const char*>(m_coefficients.data()), m_coefficients.size() * sizeof(FieldT));
+    }
+    else if( m_header.coefficients_offset > 0 ) {
+        // Extend the file to the aligned size
+        m_out.seekp(m_header.coefficients_offset - 1);
+        m_out.put(0);
+    }
+
+    m_out.seekp(0);
+    m_out.write(reinterpret_cast<const char*>(&m_header), sizeof(m_header));
+    m_out.flush();
+    return m_out.good();
+}
+
+
+bool r1cs2binary( const ProtoboardT &pb, const std::string &path, bool compress_coefficients )
+{
+    const auto &cs = pb.constraint_system;
+    R1CSBinaryWriter writer(path, compress_coefficients);
+    for( size_t i = 0; i < cs.num_constraints(); i++ )
+    {
+        const auto &constraint = cs.constraints[i];
+        writer.add(constraint->getA(), constraint->getB(), constraint->getC());
+    }
+    return writer.finish(cs.num_inputs(), cs.num_variables());
+}
+
+
+bool is_r1cs_binary( const std::string &path )
+{
+    std::ifstream fh(path, std::ios::binary);
+    char magic[sizeof(R1CS_BINARY_MAGIC)];
+    if( ! fh.read(magic, sizeof(magic)) ) {
+        return false;
+    }
+    return 0 == ::memcmp(magic, R1CS_BINARY_MAGIC, sizeof(magic));
+}
+
+
+R1CSBinaryFile::R1CSBinaryFile( const std::string &path ) :
+    m_file(path)
+{
+    if( m_file.size() < sizeof(r1cs_binary_header) ) {
+        throw std::runtime_error("Binary R1CS: file too small");
+    }
+    m_header = m_file.at<r1cs_binary_header>(0, 1);
+
+    const auto &h = *m_header;
+    const char *error = nullptr;
+    if( 0 != ::memcmp(h.magic, R1CS_BINARY_MAGIC, sizeof(R1CS_BINARY_MAGIC)) ) {
+        error = "Binary R1CS: bad magic";
+    }
+    else if( h.version != R1CS_BINARY_VERSION ) {
+        error = "Binary R1CS: unsupported version";
+    }
+    else if( h.byte_order != libsnark::MAPPED_PK_BYTE_ORDER ) {
+        error = "Binary R1CS: byte order mismatch";
+    }
+    else if( h.field_size != sizeof(FieldT) ) {
+        error = "Binary R1CS: field element size does not match this build";
+    }
+    else if( h.file_size > m_file.size() || h.coefficients_offset > h.file_size || h.constraints_offset > h.coefficients_offset ) {
+        error = "Binary R1CS: truncated file";
+    }
+    else if( h.num_variables >= UINT32_MAX || h.num_inputs > h.num_variables ) {
+        error = "Binary R1CS: bad variable counts";
+    }
+    else if( h.num_constraints > (h.coefficients_offset - h.constraints_offset) / (3 * sizeof(uint32_t)) ) {
+        error = "Binary R1CS: bad constraint count";
+    }
+    if( error ) {
+        throw std::runtime_error(error);
+    }
+
+    // Check the coefficient table is within the file
+    m_file.at<FieldT>(h.coefficients_offset, h.num_coefficients);
+
+    const bool compressed = (h.flags & R1CS_BINARY_COMPRESSED) != 0;
+    m_term_size = sizeof(uint32_t) + (compressed ? sizeof(uint32_t) : sizeof(FieldT));
+
+    // Find where each record starts, checking they lie within the constraints section
+    m_offsets.resize(h.num_constraints + 1);
+    uint64_t offset = h.constraints_offset;
+    uint64_t num_terms = 0;
+    for( size_t i = 0; i < h.num_constraints; i++ )
+    {
+        m_offsets[i] = offset;
+        if( offset + (3 * sizeof(uint32_t)) > h.coefficients_offset ) {
+            throw std::runtime_error("Binary R1CS: constraint out of bounds");
+        }
+        uint32_t record_counts[3];
+        ::memcpy(record_counts, m_file.data() + offset, sizeof(record_counts));
+        const uint64_t record_terms = uint64_t(record_counts[0]) + record_counts[1] + record_counts[2];
+        offset += sizeof(record_counts) + (record_terms * m_term_size);
+        num_terms += record_terms;
+    }
+    m_offsets[h.num_constraints] = offset;
+    if( offset > h.coefficients_offset || num_terms != h.num_terms ) {
+        throw std::runtime_error("Binary R1CS: constraint out of bounds");
+    }
+}
+
+
+const uint32_t *R1CSBinaryFile::counts( size_t constraint ) const
+{
+    return m_file.at<uint32_t>(m_offsets[constraint], 3);
+}
+
+
+const uint8_t *R1CSBinaryFile::terms( size_t constraint ) const
+{
+    return m_file.data() + m_offsets[constraint] + (3 * sizeof(uint32_t));
+}
+
+
+bool R1CSBinaryFile::decode( const uint8_t *term, uint32_t &index, FieldT &coeff ) const
+{
+    ::memcpy(&index, term, sizeof(index));
+    if( index > m_header->num_variables ) {
+        return false;
+    }
+
+    if( (m_header->flags & R1CS_BINARY_COMPRESSED) != 0 )
+    {
+        uint32_t id;
+        ::memcpy(&id, term + sizeof(uint32_t), sizeof(id));
+        if( id >= m_header->num_coefficients ) {
+            return false;
+        }
+        ::memcpy(&coeff, m_file.data() + m_header->coefficients_offset + (id * sizeof(FieldT)), sizeof(FieldT));
+    }
+    else {
+        ::memcpy(&coeff, term + sizeof(uint32_t), sizeof(FieldT));
+    }
+    return true;
+}
+
+
+void R1CSBinaryFile::load( ProtoboardT &pb ) const
+{
+    if( pb.num_variables() != 0 || pb.num_constraints() != 0 ) {
+        throw std::runtime_error("Binary R1CS: protoboard is not empty");
+    }
+
+    make_var_array(pb, num_variables(), "r1cs");
+    pb.set_input_sizes(num_inputs());
+
+    for( size_t i = 0; i < num_constraints(); i++ )
+    {
+        const uint32_t *record_counts = counts(i);
+        const uint8_t *term = terms(i);
+
+        libsnark::linear_combination<FieldT> lcs[3];
+        for( size_t j = 0; j < 3; j++ )
+        {
+            for( uint32_t k = 0; k < record_counts[j]; k++, term += m_term_size )
+            {
+                uint32_t index;
+                FieldT coeff;
+                if( ! decode(term, index, coeff) ) {
+                    throw std::runtime_error("Binary R1CS: term out of range");
+                }
+                lcs[j].add_term(libsnark::variable<FieldT>(index), coeff);
+            }
+        }
+
+        pb.add_r1cs_constraint(ConstraintT(lcs[0], lcs[1], lcs[2]), "");
+    }
+}
+
+
+void R1CSBinaryFile::load_compact( libsnark::r1cs_compact_constraints<FieldT> &result, const libsnark::Config &config ) const
+{
+    libff::enter_block("Load the binary constraint system");
+
+    const size_t n = num_constraints();
+    result.num_constraints = n;
+    result.num_inputs = num_inputs();
+    result.num_variables = num_variables();
+
+    libsnark::r1cs_compact_matrix<FieldT>* matrices[3] = {&result.A, &result.B, &result.C};
+    for( auto *matrix : matrices ) {
+        matrix->row_offsets.assign(n + 1, 0);
+    }
+    for( size_t i = 0; i < n; i++ )
+    {
+        const uint32_t *record_counts = counts(i);
+        for( size_t j = 0; j < 3; j++ ) {
+            matrices[j]->row_offsets[i + 1] = matrices[j]->row_offsets[i] + record_counts[j];
+        }
+    }
+    for( auto *matrix : matrices )
+    {
+        matrix->indices.resize(matrix->row_offsets[n]);
+        matrix->coeff_ids.resize(matrix->row_offsets[n]);
+    }
+
+    // With a coefficient table in the file its ids are used as they are,
+    // otherwise the distinct coefficients are found after decoding
+    const bool compressed = (m_header->flags & R1CS_BINARY_COMPRESSED) != 0;
+    std::vector<FieldT> term_coeffs[3];
+    if( ! compressed ) {
+        for( size_t j = 0; j < 3; j++ ) {
+            term_coeffs[j].resize(matrices[j]->indices.size());
+        }
+    }
+
+    // The records are independent, decode them in parallel
+    std::atomic<bool> valid(true);
+    libsnark::witness_map_for_blocks(n, 4096, false, config, [&](size_t begin, size_t end) {
+        for( size_t i = begin; i < end; i++ )
+        {
+            const uint8_t *term = terms(i);
+            for( size_t j = 0; j < 3; j++ )
+            {
+                auto &matrix = *matrices[j];
+                for( size_t k = matrix.row_offsets[i]; k < matrix.row_offsets[i + 1]; k++, term += m_term_size )
+                {
+                    uint32_t &index = matrix.indices[k];
+                    ::memcpy(&index, term, sizeof(index));
+                    if( index > m_header->num_variables ) {
+                        valid = false;
+                    }
+
+                    if( compressed ) {
+                        uint32_t &id = matrix.coeff_ids[k];
+                        ::memcpy(&id, term + sizeof(uint32_t), sizeof(id));
+                        if( id >= m_header->num_coefficients ) {
+                            valid = false;
+                        }
+                    }
+                    else {
+                        ::memcpy(&term_coeffs[j][k], term + sizeof(uint32_t), sizeof(FieldT));
+                    }
+                }
+            }
+        }
+    });
+    if( ! valid ) {
+        throw std::runtime_error("Binary R1CS: term out of range");
+    }
+
+    if( compressed )
+    {
+        const auto *table = m_file.at<FieldT>(m_header->coefficients_offset, m_header->num_coefficients);
+        result.coefficients.assign(table, table + m_header->num_coefficients);
+        const auto one = std::find(result.coefficients.begin(), result.coefficients.end(), FieldT::one());
+        result.one_id = one == result.coefficients.end() ? UINT32_MAX : uint32_t(one - result.coefficients.begin());
+    }
+    else
+    {
+        const std::vector<FieldT>* coeffs[3] = {&term_coeffs[0], &term_coeffs[1], &term_coeffs[2]};
+        result.intern_coefficients(coeffs, config);
+    }
+
+    libff::leave_block("Load the binary constraint system");
+}
+
+// namespace ethsnarks
+}
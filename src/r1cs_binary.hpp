@@ -0,0 +1,155 @@
+#ifndef ETHSNARKS_R1CS_BINARY_HPP_
+#define ETHSNARKS_R1CS_BINARY_HPP_
+
+#include <array>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "ethsnarks.hpp"
+#include "r1cs_gg_ppzksnark_zok/r1cs_gg_ppzksnark_zok_mmap.hpp"
+#include "r1cs_gg_ppzksnark_zok/witness_map.hpp"
+
+namespace ethsnarks {
+
+/**
+* Binary R1CS format
+*
+* A constraint system is written one constraint at a time, so it can be
+* streamed out while the gadgets generate it, and loaded back by mapping the
+* file instead of running the constraint generation again.
+*
+*   header
+*   [constraints]    for each constraint the uint32 term counts of A, B and C,
+*                    followed by the terms of A, B and C. Each term is a uint32
+*                    variable index and a coefficient, which is either the field
+*                    element as it is in memory, or with R1CS_BINARY_COMPRESSED
+*                    a uint32 index into the coefficient table
+*   [coefficients]   FieldT[num_coefficients], the distinct coefficients
+*
+* Circuits use few distinct coefficients (mostly 1, -1 and powers of two), so
+* the compressed form is usually much smaller. As with the mapped proving key
+* the field elements are stored as they are in memory, the element size and
+* byte order are checked on load.
+*/
+
+static const char R1CS_BINARY_MAGIC[8] = {'E', 'S', 'R', '1', 'C', 'S', '\0', '\0'};
+static const uint32_t R1CS_BINARY_VERSION = 1;
+static const uint32_t R1CS_BINARY_COMPRESSED = 1;
+
+struct r1cs_binary_header
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint32_t field_size;
+    uint32_t flags;
+    uint64_t num_constraints;
+    uint64_t num_inputs;
+    uint64_t num_variables;
+    uint64_t num_terms;
+    uint64_t constraints_offset;
+    uint64_t coefficients_offset;
+    uint64_t num_coefficients;
+    uint64_t file_size;
+};
+
+
+/**
+* Writes a constraint system in the binary format, one constraint at a time.
+*
+* Only the table of distinct coefficients is kept in memory. The header is
+* written by `finish`, once the number of variables is known.
+*
+* Throws `std::runtime_error` if the file cannot be opened.
+*/
+class R1CSBinaryWriter
+{
+public:
+    R1CSBinaryWriter( const std::string &path, bool compress_coefficients = true );
+
+    void add( const libsnark::linear_combination_light<FieldT> &A,
+              const libsnark::linear_combination_light<FieldT> &B,
+              const libsnark::linear_combination_light<FieldT> &C );
+
+    /** Write the coefficient table and the header, returns false on any write error */
+    bool finish( size_t num_inputs, size_t num_variables );
+
+private:
+    typedef std::array<uint8_t, sizeof(FieldT)> CoefficientKey;
+
+    struct CoefficientHash
+    {
+        size_t operator()( const CoefficientKey &key ) const;
+    };
+
+    std::ofstream m_out;
+    r1cs_binary_header m_header;
+    std::unordered_map<CoefficientKey, uint32_t, CoefficientHash> m_coefficient_ids;
+    std::vector<FieldT> m_coefficients;
+    std::vector<uint8_t> m_record;
+
+    void add_terms( const libsnark::linear_combination_light<FieldT> &lc );
+};
+
+
+/**
+* Write all constraints of the protoboard in the binary format
+*/
+bool r1cs2binary( const ProtoboardT &pb, const std::string &path, bool compress_coefficients = true );
+
+
+/**
+* A constraint system in the binary format, mapped from disk.
+*
+* Opening the file validates the header and walks the constraint records
+* once to find where each starts, after which they can be decoded in
+* parallel.
+*
+* Throws `std::runtime_error` if the file cannot be opened or is not a
+* binary R1CS written by a build with the same field.
+*/
+class R1CSBinaryFile
+{
+public:
+    explicit R1CSBinaryFile( const std::string &path );
+
+    const r1cs_binary_header &header() const { return *m_header; }
+    size_t num_constraints() const { return m_header->num_constraints; }
+    size_t num_inputs() const { return m_header->num_inputs; }
+    size_t num_variables() const { return m_header->num_variables; }
+
+    /**
+    * Allocate the variables on an empty protoboard and fill in its
+    * constraint system, the witness still has to be set separately
+    */
+    void load( ProtoboardT &pb ) const;
+
+    /**
+    * Decode straight into the compact form used by the prover's witness map
+    * and the key generators, without building the constraint objects
+    */
+    void load_compact( libsnark::r1cs_compact_constraints<FieldT> &result, const libsnark::Config &config ) const;
+
+private:
+    libsnark::mapped_file m_file;
+    const r1cs_binary_header *m_header;
+    std::vector<uint64_t> m_offsets;    // byte offset of each constraint record, plus the end
+    size_t m_term_size;
+
+    const uint32_t *counts( size_t constraint ) const;
+    const uint8_t *terms( size_t constraint ) const;
+
+    /** Decode a term, false if its variable or coefficient is out of range */
+    bool decode( const uint8_t *term, uint32_t &index, FieldT &coeff ) const;
+};
+
+
+bool is_r1cs_binary( const std::string &path );
+
+// namespace ethsnarks
+}
+
+#endif
@@ -0,0 +1,1130 @@
+#ifndef ETHSNARKS_MULTIEXP_HPP_
+#define ETHSNARKS_MULTIEXP_HPP_
+
+#include <algorithm>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <gmp.h>
+
+#include <libff/algebra/fields/bigint.hpp>
+#include <libff/common/utils.hpp>
+#include <libff/algebra/curves/alt_bn128/alt_bn128_pp.hpp>
+#include <libff/algebra/curves/mcl_bn128/mcl_bn128_pp.hpp>
+
+#ifdef MULTICORE
+#include <omp.h>
+#endif
+
+#include "prover_config.hpp"
+
+namespace libsnark {
+
+/**
+* Multi-exponentiation over plain arrays of bases.
+*
+* libff's multi_exp only accepts std::vector iterators, which rules it out
+* for keys that are used in place (e.g. memory mapped from disk). These
+* routines implement the bucket method (Pippenger) over raw pointers, so
+* any contiguous storage can be used as the source of bases.
+*/
+
+
+/**
+* Access to the affine coordinates of a group element, for accumulating
+* buckets in affine form. Only specialised for the G1 groups, where the
+* saving over mixed addition is worth it, other groups use the projective
+* bucket method.
+*
+* The bases must be in special form (Z = 1), as produced by `batch_to_special`.
+*/
+template<typename T>
+struct multi_exp_affine_traits
+{
+    static const bool supported = false;
+};
+
+template<>
+struct multi_exp_affine_traits<libff::alt_bn128_G1>
+{
+    typedef libff::alt_bn128_Fq field_type;
+    static const bool supported = true;
+
+    static const field_type& x(const libff::alt_bn128_G1& p) { return p.X; }
+    static const field_type& y(const libff::alt_bn128_G1& p) { return p.Y; }
+    static field_type inverse(const field_type& a) { return a.inverse(); }
+    static bool is_zero(const field_type& a) { return a.is_zero(); }
+    static field_type from_int(long v) { return field_type(v); }
+
+    static libff::alt_bn128_G1 from_affine(const field_type& x, const field_type& y)
+    {
+        return libff::alt_bn128_G1(x, y, field_type::one());
+    }
+};
+
+template<>
+struct multi_exp_affine_traits<libff::mcl_bn128_G1>
+{
+    typedef mcl::bn::Fp field_type;
+    static const bool supported = true;
+
+    static const field_type& x(const libff::mcl_bn128_G1& p) { return p.pt.x; }
+    static const field_type& y(const libff::mcl_bn128_G1& p) { return p.pt.y; }
+    static field_type inverse(const field_type& a) { field_type r; field_type::inv(r, a); return r; }
+    static bool is_zero(const field_type& a) { return a.isZero(); }
+    static field_type from_int(long v) { return field_type(v); }
+
+    static libff::mcl_bn128_G1 from_affine(const field_type& x, const field_type& y)
+    {
+        libff::mcl_bn128_G1 result;
+        result.pt.x = x;
+        result.pt.y = y;
+        result.pt.z = 1;
+        return result;
+    }
+};
+
+
+/**
+* Extract `c` bits of the exponent, starting at bit `offset`
+*/
+template<mp_size_t n>
+static inline size_t multi_exp_get_window(const libff::bigint<n>& exponent, size_t offset, size_t c)
+{
+    const size_t limb = offset / GMP_NUMB_BITS;
+    const size_t shift = offset % GMP_NUMB_BITS;
+    if (limb >= n)
+    {
+        return 0;
+    }
+    mp_limb_t v = exponent.data[limb] >> shift;
+    if (shift + c > GMP_NUMB_BITS && limb + 1 < n)
+    {
+        v |= exponent.data[limb + 1] << (GMP_NUMB_BITS - shift);
+    }
+    return v & ((mp_limb_t(1) << c) - 1);
+}
+
+
+/**
+* Signed digit `w` of the exponent, in [-2^(c-1), 2^(c-1)]
+*
+* When the top bit of a window is set the window is taken as negative and
+* a carry is added to the next one. The carry only depends on the top bit
+* of the previous window, so each digit can be computed independently.
+* The exponent is fully represented by `multi_exp_num_signed_windows` digits.
+*/
+template<mp_size_t n>
+static inline long multi_exp_get_signed_digit(const libff::bigint<n>& exponent, size_t w, size_t c)
+{
+    const size_t offset = w * c;
+    long digit = multi_exp_get_window(exponent, offset, c);
+    if (offset > 0)
+    {
+        digit += multi_exp_get_window(exponent, offset - 1, 1);
+    }
+    if (multi_exp_get_window(exponent, offset + c - 1, 1))
+    {
+        digit -= long(1) << c;
+    }
+    return digit;
+}
+
+
+static inline size_t multi_exp_num_signed_windows(size_t num_bits, size_t c)
+{
+    // One extra bit for the carry out of the top window
+    return (num_bits + c) / c;
+}
+
+
+/**
+* Window size for the bucket method, ~ln(n) + 2 bits plus one more as the
+* signed digits halve the number of buckets for a given window size.
+*/
+static inline size_t multi_exp_window_size(size_t length, const Config& config)
+{
+    if (config.multi_exp_c != 0)
+    {
+        return config.multi_exp_c;
+    }
+    if (length < 32)
+    {
+        return 3;
+    }
+    size_t log2_length = 0;
+    while ((size_t(1) << (log2_length + 1)) <= length)
+    {
+        log2_length++;
+    }
+    return ((log2_length * 69) / 100) + 3;
+}
+
+
+template<typename T>
+static inline void multi_exp_bucket_add(T& bucket, const T& base)
+{
+#ifdef USE_MIXED_ADDITION
+    bucket = bucket.mixed_add(base);
+#else
+    bucket = bucket + base;
+#endif
+}
+
+
+template<typename T>
+static inline void multi_exp_bucket_add_digit(T* buckets, long digit, const T& base)
+{
+    if (digit > 0)
+    {
+        multi_exp_bucket_add(buckets[digit - 1], base);
+    }
+    else if (digit < 0)
+    {
+        multi_exp_bucket_add(buckets[-digit - 1], -base);
+    }
+}
+
+
+/**
+* sum_j (j + 1) * buckets[j] via running sums
+*/
+template<typename T>
+static inline T multi_exp_sum_buckets(const T* buckets, size_t num_buckets)
+{
+    T running = T::zero();
+    T window_sum = T::zero();
+    for (size_t j = num_buckets; j-- > 0; )
+    {
+        running = running + buckets[j];
+        window_sum = window_sum + running;
+    }
+    return window_sum;
+}
+
+
+/**
+* Bucket method over bases[begin, end), with exponents already in bigint form.
+*
+* Exponents are split into signed digits, so a base with a negative digit
+* is subtracted from the bucket of its magnitude. This halves the number of
+* buckets (2^(c-1)) compared to unsigned windows of the same size.
+*/
+template<typename T, mp_size_t n>
+T multi_exp_pippenger_range(
+    const T* bases,
+    const libff::bigint<n>* exponents,
+    size_t begin,
+    size_t end,
+    size_t c,
+    size_t num_bits)
+{
+    const size_t num_windows = multi_exp_num_signed_windows(num_bits, c);
+    std::vector<T> buckets(size_t(1) << (c - 1));
+
+    T result = T::zero();
+    for (size_t w = num_windows; w-- > 0; )
+    {
+        if (!result.is_zero())
+        {
+            for (size_t k = 0; k < c; k++)
+            {
+                result = result.dbl();
+            }
+        }
+
+        std::fill(buckets.begin(), buckets.end(), T::zero());
+        bool any = false;
+        for (size_t i = begin; i < end; i++)
+        {
+            const long digit = multi_exp_get_signed_digit(exponents[i], w, c);
+            if (digit != 0)
+            {
+                multi_exp_bucket_add_digit(buckets.data(), digit, bases[i]);
+                any = true;
+            }
+        }
+        if (any)
+        {
+            result = result + multi_exp_sum_buckets(buckets.data(), buckets.size());
+        }
+    }
+
+    return result;
+}
+
+
+/**
+* Affine buckets for one window, additions are queued and done in batches
+* which share a single field inversion (Montgomery's trick).
+*
+* An affine addition costs one inversion (amortised to 3 multiplications)
+* plus 3 multiplications, compared to ~11 for a mixed projective addition.
+* Two additions to the same bucket can't be in the same batch, while one is
+* queued the others go to a projective overflow for that bucket. Repeated
+* digits (e.g. the bits of a witness) then cost one mixed addition each,
+* rather than a batch and an inversion each.
+*/
+template<typename T>
+class multi_exp_affine_buckets
+{
+public:
+    typedef multi_exp_affine_traits<T> traits;
+    typedef typename traits::field_type field_type;
+
+    multi_exp_affine_buckets(size_t num_buckets, size_t max_batch) :
+        x(num_buckets), y(num_buckets), state(num_buckets, EMPTY), overflow(num_buckets, T::zero()), max_batch(max_batch)
+    {
+        pending.reserve(max_batch);
+        products.reserve(max_batch);
+    }
+
+    void clear()
+    {
+        std::fill(state.begin(), state.end(), EMPTY);
+        for (const auto index : overflowed)
+        {
+            overflow[index] = T::zero();
+        }
+        overflowed.clear();
+    }
+
+    /** Queue bucket[index] += (negate ? -base : base) */
+    void add(size_t index, const T& base, bool negate)
+    {
+        const field_type& bx = traits::x(base);
+        const field_type base_y = negate ? -traits::y(base) : traits::y(base);
+
+        if (state[index] == EMPTY)
+        {
+            x[index] = bx;
+            y[index] = base_y;
+            state[index] = FULL;
+            return;
+        }
+
+        if (state[index] == BUSY)
+        {
+            if (overflow[index].is_zero())
+            {
+                overflowed.emplace_back(index);
+            }
+            multi_exp_bucket_add(overflow[index], negate ? -base : base);
+            return;
+        }
+
+        if (x[index] == bx)
+        {
+            add_same_x(index, base_y);
+            return;
+        }
+
+        state[index] = BUSY;
+        pending.emplace_back(index, &base, negate);
+        if (pending.size() == max_batch)
+        {
+            flush();
+        }
+    }
+
+    /** Finish all queued additions */
+    void finish()
+    {
+        flush();
+    }
+
+    /** acc += bucket[index], after `finish` */
+    void accumulate(T& acc, size_t index) const
+    {
+        if (state[index] != EMPTY)
+        {
+            acc = acc.mixed_add(traits::from_affine(x[index], y[index]));
+        }
+        if (!overflow[index].is_zero())
+        {
+            acc = acc + overflow[index];
+        }
+    }
+
+private:
+    enum bucket_state : uint8_t { EMPTY, FULL, BUSY };
+
+    struct entry
+    {
+        size_t index;
+        const T* base;
+        bool negate;
+        entry(size_t index, const T* base, bool negate) : index(index), base(base), negate(negate) {}
+    };
+
+    std::vector<field_type> x;
+    std::vector<field_type> y;
+    std::vector<bucket_state> state;
+    std::vector<T> overflow;
+    std::vector<size_t> overflowed;     // buckets with a non-zero overflow
+    const size_t max_batch;
+    std::vector<entry> pending;
+    std::vector<field_type> products;
+
+    /* Doubling or cancellation, these are rare enough to pay for an inversion */
+    void add_same_x(size_t index, const field_type& base_y)
+    {
+        if (!(y[index] == base_y) || traits::is_zero(base_y))
+        {
+            state[index] = EMPTY;
+            return;
+        }
+
+        const field_type x_squared = x[index] * x[index];
+        const field_type lambda = (x_squared + x_squared + x_squared) * traits::inverse(base_y + base_y);
+        const field_type x3 = (lambda * lambda) - x[index] - x[index];
+        y[index] = (lambda * (x[index] - x3)) - y[index];
+        x[index] = x3;
+    }
+
+    void flush()
+    {
+        if (pending.empty())
+        {
+            return;
+        }
+
+        // products[i] = prod_{j <= i} (x2_j - x1_j)
+        products.clear();
+        field_type acc = traits::from_int(1);
+        for (const auto& e : pending)
+        {
+            acc = acc * (traits::x(*e.base) - x[e.index]);
+            products.emplace_back(acc);
+        }
+
+        field_type inv = traits::inverse(acc);
+        for (size_t i = pending.size(); i-- > 0; )
+        {
+            const auto& e = pending[i];
+            const field_type& bx = traits::x(*e.base);
+            const field_type by = e.negate ? -traits::y(*e.base) : traits::y(*e.base);
+            const field_type dx = bx - x[e.index];
+
+            // 1/dx_i = inv(prod_{j <= i}) * prod_{j < i}
+            const field_type dx_inv = (i > 0) ? inv * products[i - 1] : inv;
+            inv = inv * dx;
+
+            const field_type lambda = (by - y[e.index]) * dx_inv;
+            const field_type x3 = (lambda * lambda) - x[e.index] - bx;
+            y[e.index] = (lambda * (x[e.index] - x3)) - y[e.index];
+            x[e.index] = x3;
+            state[e.index] = FULL;
+        }
+        pending.clear();
+    }
+};
+
+
+/**
+* Signed digit bucket method over bases[begin, end) with affine buckets.
+*
+* Falls back to `multi_exp_pippenger_range` for groups without affine traits.
+*/
+template<typename T, mp_size_t n>
+typename std::enable_if<multi_exp_affine_traits<T>::supported, T>::type
+multi_exp_pippenger_range_affine(
+    const T* bases,
+    const libff::bigint<n>* exponents,
+    size_t begin,
+    size_t end,
+    size_t c,
+    size_t num_bits)
+{
+    const size_t max_batch = 1024;
+    const size_t num_windows = multi_exp_num_signed_windows(num_bits, c);
+    const size_t num_buckets = size_t(1) << (c - 1);
+    multi_exp_affine_buckets<T> buckets(num_buckets, max_batch);
+
+    T result = T::zero();
+    for (size_t w = num_windows; w-- > 0; )
+    {
+        if (!result.is_zero())
+        {
+            for (size_t k = 0; k < c; k++)
+            {
+                result = result.dbl();
+            }
+        }
+
+        buckets.clear();
+        bool any = false;
+        for (size_t i = begin; i < end; i++)
+        {
+            const long digit = multi_exp_get_signed_digit(exponents[i], w, c);
+            if (digit != 0 && !bases[i].is_zero())
+            {
+                buckets.add((digit > 0 ? digit : -digit) - 1, bases[i], digit < 0);
+                any = true;
+            }
+        }
+        if (!any)
+        {
+            continue;
+        }
+        buckets.finish();
+
+        T running = T::zero();
+        T window_sum = T::zero();
+        for (size_t j = num_buckets; j-- > 0; )
+        {
+            buckets.accumulate(running, j);
+            window_sum = window_sum + running;
+        }
+        result = result + window_sum;
+    }
+
+    return result;
+}
+
+template<typename T, mp_size_t n>
+typename std::enable_if<!multi_exp_affine_traits<T>::supported, T>::type
+multi_exp_pippenger_range_affine(
+    const T* bases,
+    const libff::bigint<n>* exponents,
+    size_t begin,
+    size_t end,
+    size_t c,
+    size_t num_bits)
+{
+    return multi_exp_pippenger_range(bases, exponents, begin, end, c, num_bits);
+}
+
+
+/**
+* Bucket method over bases[begin, end), using affine buckets when enabled
+* in the config. Affine buckets require bases in special form, so they are
+* only available with USE_MIXED_ADDITION.
+*/
+template<typename T, mp_size_t n>
+T multi_exp_pippenger_chunk(
+    const T* bases,
+    const libff::bigint<n>* exponents,
+    size_t begin,
+    size_t end,
+    size_t num_bits,
+    const Config& config)
+{
+    const size_t c = multi_exp_window_size(end - begin, config);
+#ifdef USE_MIXED_ADDITION
+    if (config.multi_exp_batch_affine)
+    {
+        return multi_exp_pippenger_range_affine(bases, exponents, begin, end, c, num_bits);
+    }
+#endif
+    return multi_exp_pippenger_range(bases, exponents, begin, end, c, num_bits);
+}
+
+
+/**
+* Projective buckets with the same interface as `multi_exp_affine_buckets`
+*/
+template<typename T>
+class multi_exp_projective_buckets
+{
+public:
+    multi_exp_projective_buckets(size_t num_buckets) : buckets(num_buckets) {}
+
+    void clear()
+    {
+        std::fill(buckets.begin(), buckets.end(), T::zero());
+    }
+
+    void add(size_t index, const T& base, bool negate)
+    {
+        multi_exp_bucket_add(buckets[index], negate ? -base : base);
+    }
+
+    void finish() {}
+
+    void accumulate(T& acc, size_t index) const
+    {
+        if (!buckets[index].is_zero())
+        {
+            acc = acc + buckets[index];
+        }
+    }
+
+private:
+    std::vector<T> buckets;
+};
+
+
+/**
+* Bucket method over bases[begin, end) using precomputed multiples, see
+* `r1cs_gg_ppzksnark_zok_precomputed_tables` for the table layout.
+*
+* `table[k * count + i]` is `bases[i] * 2^(k * round_windows * c)`, the
+* accumulator is doubled only between rounds.
+*/
+template<typename T, mp_size_t n, typename BucketsT>
+T multi_exp_precomputed_range(
+    BucketsT& buckets,
+    const T* table,
+    size_t count,
+    size_t expansion,
+    size_t round_windows,
+    size_t c,
+    const libff::bigint<n>* exponents,
+    size_t begin,
+    size_t end,
+    size_t num_bits)
+{
+    const size_t num_windows = multi_exp_num_signed_windows(num_bits, c);
+    const size_t num_buckets = size_t(1) << (c - 1);
+
+    T result = T::zero();
+    for (size_t j = round_windows; j-- > 0; )
+    {
+        if (!result.is_zero())
+        {
+            for (size_t k = 0; k < c; k++)
+            {
+                result = result.dbl();
+            }
+        }
+
+        buckets.clear();
+        bool any = false;
+        for (size_t k = 0; k < expansion; k++)
+        {
+            const size_t w = (k * round_windows) + j;
+            if (w >= num_windows)
+            {
+                break;
+            }
+
+            const T* multiples = table + (k * count);
+            for (size_t i = begin; i < end; i++)
+            {
+                const long digit = multi_exp_get_signed_digit(exponents[i], w, c);
+                if (digit != 0 && !multiples[i].is_zero())
+                {
+                    buckets.add((digit > 0 ? digit : -digit) - 1, multiples[i], digit < 0);
+                    any = true;
+                }
+            }
+        }
+        if (!any)
+        {
+            continue;
+        }
+        buckets.finish();
+
+        T running = T::zero();
+        T window_sum = T::zero();
+        for (size_t b = num_buckets; b-- > 0; )
+        {
+            buckets.accumulate(running, b);
+            window_sum = window_sum + running;
+        }
+        result = result + window_sum;
+    }
+
+    return result;
+}
+
+
+template<typename T, mp_size_t n>
+typename std::enable_if<multi_exp_affine_traits<T>::supported, T>::type
+multi_exp_precomputed_buckets(const T* table, size_t count, size_t expansion, size_t round_windows, size_t c,
+                              const libff::bigint<n>* exponents, size_t begin, size_t end, size_t num_bits, const Config& config)
+{
+    // The tables are always in special form, so affine buckets can be used
+    if (config.multi_exp_batch_affine)
+    {
+        multi_exp_affine_buckets<T> buckets(size_t(1) << (c - 1), 1024);
+        return multi_exp_precomputed_range(buckets, table, count, expansion, round_windows, c, exponents, begin, end, num_bits);
+    }
+    multi_exp_projective_buckets<T> buckets(size_t(1) << (c - 1));
+    return multi_exp_precomputed_range(buckets, table, count, expansion, round_windows, c, exponents, begin, end, num_bits);
+}
+
+template<typename T, mp_size_t n>
+typename std::enable_if<!multi_exp_affine_traits<T>::supported, T>::type
+multi_exp_precomputed_buckets(const T* table, size_t count, size_t expansion, size_t round_windows, size_t c,
+                              const libff::bigint<n>* exponents, size_t begin, size_t end, size_t num_bits, const Config& config)
+{
+    libff::UNUSED(config);
+    multi_exp_projective_buckets<T> buckets(size_t(1) << (c - 1));
+    return multi_exp_precomputed_range(buckets, table, count, expansion, round_windows, c, exponents, begin, end, num_bits);
+}
+
+
+/**
+* Convert scalars[begin, end) into `exponents`, except that scalars equal to
+* one are summed into the result instead (their exponent is zero, as for zero
+* scalars). Witnesses are mostly bits, which would otherwise all go into the
+* same bucket.
+*/
+template<typename T, typename FieldT>
+T multi_exp_split_ones(
+    const T* bases,
+    const FieldT* scalars,
+    libff::bigint<FieldT::num_limbs>* exponents,
+    size_t begin,
+    size_t end)
+{
+    const FieldT one = FieldT::one();
+    const libff::bigint<FieldT::num_limbs> bigint_zero = FieldT::zero().as_bigint();
+
+    T ones = T::zero();
+    for (size_t i = begin; i < end; i++)
+    {
+        if (scalars[i] == one)
+        {
+            multi_exp_bucket_add(ones, bases[i]);
+            exponents[i] = bigint_zero;
+        }
+        else
+        {
+            exponents[i] = scalars[i].as_bigint();
+        }
+    }
+    return ones;
+}
+
+
+/**
+* Dense multi-exponentiation of scalars[begin, end) with precomputed
+* tables, single threaded. The scalars are converted into `exponents`.
+*/
+template<typename T, typename FieldT>
+T multi_exp_precomputed_chunk(
+    const T* table,
+    size_t count,
+    size_t expansion,
+    size_t round_windows,
+    size_t c,
+    const FieldT* scalars,
+    libff::bigint<FieldT::num_limbs>* exponents,
+    size_t begin,
+    size_t end,
+    const Config& config)
+{
+    // The first multiples of the table are the bases
+    const T ones = multi_exp_split_ones(table, scalars, exponents, begin, end);
+    return ones + multi_exp_precomputed_buckets(table, count, expansion, round_windows, c, exponents, begin, end, FieldT::size_in_bits(), config);
+}
+
+
+/**
+* Dense multi-exponentiation with precomputed tables over `count` scalars
+*/
+template<typename T, typename FieldT>
+T multi_exp_precomputed(
+    const T* table,
+    size_t count,
+    size_t expansion,
+    size_t round_windows,
+    size_t c,
+    const FieldT* scalars,
+    std::vector<libff::bigint<FieldT::num_limbs>>& scratch_exponents,
+    const Config& config)
+{
+    if (scratch_exponents.size() < count)
+    {
+        scratch_exponents.resize(count);
+    }
+
+    const auto ranges = get_cpu_ranges(0, count, config.num_threads);
+    std::vector<T> partial(ranges.size(), T::zero());
+#ifdef MULTICORE
+    #pragma omp parallel for num_threads(ranges.size())
+#endif
+    for (size_t i = 0; i < ranges.size(); i++)
+    {
+        partial[i] = multi_exp_precomputed_chunk(table, count, expansion, round_windows, c, scalars, scratch_exponents.data(), ranges[i].first, ranges[i].second, config);
+    }
+
+    T result = T::zero();
+    for (const auto& p : partial)
+    {
+        result = result + p;
+    }
+    return result;
+}
+
+
+/**
+* Dense multi-exponentiation of bases[begin, end), single threaded.
+*
+* The scalars in the range are converted into `exponents`, which must have
+* room for at least `end` elements. As for the sparse form, scalars equal to
+* one are added directly rather than going through the buckets.
+*/
+template<typename T, typename FieldT>
+T multi_exp_array_chunk(
+    const T* bases,
+    const FieldT* scalars,
+    libff::bigint<FieldT::num_limbs>* exponents,
+    size_t begin,
+    size_t end,
+    const Config& config)
+{
+    const T ones = multi_exp_split_ones(bases, scalars, exponents, begin, end);
+    return ones + multi_exp_pippenger_chunk(bases, exponents, begin, end, FieldT::size_in_bits(), config);
+}
+
+
+/**
+* Sparse multi-exponentiation of values[begin, end), single threaded.
+*
+* This matches the semantics of libsnark's `kc_multi_exp_with_mixed_addition`:
+* `indices[i]` selects the scalar for `values[i]`, zero scalars are skipped
+* and scalars equal to one are added directly rather than going through
+* the buckets.
+*/
+template<typename T, typename FieldT>
+T sparse_multi_exp_array_chunk(
+    const T* values,
+    const size_t* indices,
+    const FieldT* scalars,
+    size_t scalars_length,
+    libff::bigint<FieldT::num_limbs>* exponents,
+    size_t begin,
+    size_t end,
+    const Config& config)
+{
+    const FieldT zero = FieldT::zero();
+    const FieldT one = FieldT::one();
+    const libff::bigint<FieldT::num_limbs> bigint_zero = zero.as_bigint();
+
+    T ones = T::zero();
+    for (size_t i = begin; i < end; i++)
+    {
+        const size_t idx = indices[i];
+        if (idx >= scalars_length || scalars[idx] == zero)
+        {
+            exponents[i] = bigint_zero;
+        }
+        else if (scalars[idx] == one)
+        {
+            multi_exp_bucket_add(ones, values[i]);
+            exponents[i] = bigint_zero;
+        }
+        else
+        {
+            exponents[i] = scalars[idx].as_bigint();
+        }
+    }
+
+    return ones + multi_exp_pippenger_chunk(values, exponents, begin, end, FieldT::size_in_bits(), config);
+}
+
+
+/**
+* Dense multi-exponentiation: sum_i scalars[i] * bases[i]
+*
+* Each thread handles a contiguous chunk with its own buckets and the
+* partial results are summed. `scratch_exponents` is resized as necessary
+* and can be re-used between calls.
+*/
+template<typename T, typename FieldT>
+T multi_exp_array(
+    const T* bases,
+    const FieldT* scalars,
+    size_t length,
+    std::vector<libff::bigint<FieldT::num_limbs>>& scratch_exponents,
+    const Config& config)
+{
+    if (scratch_exponents.size() < length)
+    {
+        scratch_exponents.resize(length);
+    }
+
+    const auto ranges = get_cpu_ranges(0, length, config.num_threads);
+    std::vector<T> partial(ranges.size(), T::zero());
+#ifdef MULTICORE
+    #pragma omp parallel for num_threads(ranges.size())
+#endif
+    for (size_t i = 0; i < ranges.size(); i++)
+    {
+        partial[i] = multi_exp_array_chunk(bases, scalars, scratch_exponents.data(), ranges[i].first, ranges[i].second, config);
+    }
+
+    T result = T::zero();
+    for (const auto& p : partial)
+    {
+        result = result + p;
+    }
+    return result;
+}
+
+
+/**
+* Sparse multi-exponentiation, see `sparse_multi_exp_array_chunk`
+*/
+template<typename T, typename FieldT>
+T sparse_multi_exp_array(
+    const T* values,
+    const size_t* indices,
+    size_t count,
+    const FieldT* scalars,
+    size_t scalars_length,
+    std::vector<libff::bigint<FieldT::num_limbs>>& scratch_exponents,
+    const Config& config)
+{
+    if (scratch_exponents.size() < count)
+    {
+        scratch_exponents.resize(count);
+    }
+
+    const auto ranges = get_cpu_ranges(0, count, config.num_threads);
+    std::vector<T> partial(ranges.size(), T::zero());
+#ifdef MULTICORE
+    #pragma omp parallel for num_threads(ranges.size())
+#endif
+    for (size_t i = 0; i < ranges.size(); i++)
+    {
+        partial[i] = sparse_multi_exp_array_chunk(values, indices, scalars, scalars_length, scratch_exponents.data(), ranges[i].first, ranges[i].second, config);
+    }
+
+    T result = T::zero();
+    for (const auto& p : partial)
+    {
+        result = result + p;
+    }
+    return result;
+}
+
+
+/**
+* Split [0, length) into chunks of roughly equal cost, for scheduling the
+* chunks of several multi-exponentiations as independent tasks.
+*
+* `element_cost` is the relative cost of one element (e.g. a G2 addition
+* compared to a G1 addition), chunks are at least `min_chunk` elements so
+* the bucket method stays efficient.
+*/
+static inline std::vector<std::pair<size_t, size_t>> multi_exp_cost_chunks(size_t length, size_t element_cost, size_t chunk_cost, size_t min_chunk)
+{
+    std::vector<std::pair<size_t, size_t>> chunks;
+    if (length == 0)
+    {
+        return chunks;
+    }
+
+    const size_t chunk_length = std::max(min_chunk, chunk_cost / std::max<size_t>(element_cost, 1));
+    const size_t num_chunks = std::max<size_t>(1, (length + (chunk_length / 2)) / chunk_length);
+    const size_t base_length = length / num_chunks;
+    const size_t remainder = length % num_chunks;
+
+    size_t begin = 0;
+    for (size_t i = 0; i < num_chunks; i++)
+    {
+        const size_t end = begin + base_length + ((i < remainder) ? 1 : 0);
+        chunks.emplace_back(begin, end);
+        begin = end;
+    }
+    return chunks;
+}
+
+
+/**
+* Bucket method for several exponent vectors over the same bases.
+*
+* Each window makes one pass over bases[begin, end), adding every base to
+* a bucket of each batch, so the bases are read from memory once per window
+* regardless of the number of exponent vectors.
+*/
+template<typename T, mp_size_t n>
+std::vector<T> multi_exp_pippenger_batch_range(
+    const T* bases,
+    const std::vector<const libff::bigint<n>*>& exponents,
+    size_t begin,
+    size_t end,
+    size_t c,
+    size_t num_bits)
+{
+    const size_t batch_size = exponents.size();
+    const size_t num_buckets = size_t(1) << (c - 1);
+    const size_t num_windows = multi_exp_num_signed_windows(num_bits, c);
+    std::vector<T> buckets(batch_size * num_buckets);
+
+    std::vector<T> results(batch_size, T::zero());
+    for (size_t w = num_windows; w-- > 0; )
+    {
+        for (auto& result : results)
+        {
+            if (!result.is_zero())
+            {
+                for (size_t k = 0; k < c; k++)
+                {
+                    result = result.dbl();
+                }
+            }
+        }
+
+        std::fill(buckets.begin(), buckets.end(), T::zero());
+        for (size_t i = begin; i < end; i++)
+        {
+            for (size_t b = 0; b < batch_size; b++)
+            {
+                const long digit = multi_exp_get_signed_digit(exponents[b][i], w, c);
+                multi_exp_bucket_add_digit(&buckets[b * num_buckets], digit, bases[i]);
+            }
+        }
+
+        for (size_t b = 0; b < batch_size; b++)
+        {
+            results[b] = results[b] + multi_exp_sum_buckets(&buckets[b * num_buckets], num_buckets);
+        }
+    }
+
+    return results;
+}
+
+
+template<typename T, mp_size_t n>
+std::vector<T> multi_exp_pippenger_batch(
+    const T* bases,
+    const std::vector<const libff::bigint<n>*>& exponents,
+    size_t length,
+    size_t num_bits,
+    const Config& config)
+{
+    const auto ranges = get_cpu_ranges(0, length, config.num_threads);
+    std::vector<std::vector<T>> partial(ranges.size());
+#ifdef MULTICORE
+    #pragma omp parallel for num_threads(ranges.size())
+#endif
+    for (size_t i = 0; i < ranges.size(); i++)
+    {
+        const size_t c = multi_exp_window_size(ranges[i].second - ranges[i].first, config);
+        partial[i] = multi_exp_pippenger_batch_range(bases, exponents, ranges[i].first, ranges[i].second, c, num_bits);
+    }
+
+    std::vector<T> results(exponents.size(), T::zero());
+    for (const auto& p : partial)
+    {
+        for (size_t b = 0; b < results.size(); b++)
+        {
+            results[b] = results[b] + p[b];
+        }
+    }
+    return results;
+}
+
+
+/**
+* Dense multi-exponentiation for several scalar vectors over the same bases,
+* `scratch_exponents` holds one vector per batch entry.
+*/
+template<typename T, typename FieldT>
+std::vector<T> multi_exp_array_batch(
+    const T* bases,
+    const std::vector<const FieldT*>& scalars,
+    size_t length,
+    std::vector<std::vector<libff::bigint<FieldT::num_limbs>>>& scratch_exponents,
+    const Config& config)
+{
+    if (scratch_exponents.size() < scalars.size())
+    {
+        scratch_exponents.resize(scalars.size());
+    }
+
+    std::vector<const libff::bigint<FieldT::num_limbs>*> exponents(scalars.size());
+    for (size_t b = 0; b < scalars.size(); b++)
+    {
+        auto& scratch = scratch_exponents[b];
+        if (scratch.size() < length)
+        {
+            scratch.resize(length);
+        }
+
+#ifdef MULTICORE
+        #pragma omp parallel for num_threads(config.num_threads)
+#endif
+        for (size_t i = 0; i < length; i++)
+        {
+            scratch[i] = scalars[b][i].as_bigint();
+        }
+        exponents[b] = scratch.data();
+    }
+
+    return multi_exp_pippenger_batch(bases, exponents, length, FieldT::size_in_bits(), config);
+}
+
+
+/**
+* Sparse multi-exponentiation for several scalar vectors over the same
+* bases, see `sparse_multi_exp_array` for the treatment of zeros and ones.
+*/
+template<typename T, typename FieldT>
+std::vector<T> sparse_multi_exp_array_batch(
+    const T* values,
+    const size_t* indices,
+    size_t count,
+    const std::vector<const FieldT*>& scalars,
+    size_t scalars_length,
+    std::vector<std::vector<libff::bigint<FieldT::num_limbs>>>& scratch_exponents,
+    const Config& config)
+{
+    if (scratch_exponents.size() < scalars.size())
+    {
+        scratch_exponents.resize(scalars.size());
+    }
+
+    const FieldT zero = FieldT::zero();
+    const FieldT one = FieldT::one();
+    const libff::bigint<FieldT::num_limbs> bigint_zero = zero.as_bigint();
+
+    const auto ranges = get_cpu_ranges(0, count, config.num_threads);
+    std::vector<T> ones(scalars.size() * ranges.size(), T::zero());
+    std::vector<const libff::bigint<FieldT::num_limbs>*> exponents(scalars.size());
+    for (size_t b = 0; b < scalars.size(); b++)
+    {
+        auto& scratch = scratch_exponents[b];
+        if (scratch.size() < count)
+        {
+            scratch.resize(count);
+        }
+
+        const FieldT* batch_scalars = scalars[b];
+#ifdef MULTICORE
+        #pragma omp parallel for num_threads(ranges.size())
+#endif
+        for (size_t r = 0; r < ranges.size(); r++)
+        {
+            for (size_t i = ranges[r].first; i < ranges[r].second; i++)
+            {
+                const size_t idx = indices[i];
+                if (idx >= scalars_length || batch_scalars[idx] == zero)
+                {
+                    scratch[i] = bigint_zero;
+                }
+                else if (batch_scalars[idx] == one)
+                {
+                    multi_exp_bucket_add(ones[(b * ranges.size()) + r], values[i]);
+                    scratch[i] = bigint_zero;
+                }
+                else
+                {
+                    scratch[i] = batch_scalars[idx].as_bigint();
+                }
+            }
+        }
+        exponents[b] = scratch.data();
+    }
+
+    std::vector<T> results = multi_exp_pippenger_batch(values, exponents, count, FieldT::size_in_bits(), config);
+    for (size_t b = 0; b < scalars.size(); b++)
+    {
+        for (size_t r = 0; r < ranges.size(); r++)
+        {
+            results[b] = results[b] + ones[(b * ranges.size()) + r];
+        }
+    }
+    return results;
+}
+
+} // libsnark
+
+#endif
@@ -54,6 +54,10 @@ References:
 #include <libsnark/knowledge_commitment/knowledge_commitment.hpp>
 #include <libsnark/relations/constraint_satisfaction_problems/r1cs/r1cs.hpp>
 #include "r1cs_gg_ppzksnark_zok/r1cs_gg_ppzksnark_zok_params.hpp"
+#include "r1cs_gg_ppzksnark_zok/r1cs_gg_ppzksnark_zok_mmap.hpp"
+#include "r1cs_gg_ppzksnark_zok/r1cs_gg_ppzksnark_zok_stream.hpp"
+#include "r1cs_gg_ppzksnark_zok/r1cs_gg_ppzksnark_zok_tables.hpp"
+#include "r1cs_gg_ppzksnark_zok/witness_map.hpp"
 
 #include <libfqfft/evaluation_domain/evaluation_domain.hpp>
 
@@ -276,18 +280,43 @@ public:
 
 /******************************** Proving Context ********************************/
 
+/**
+ * State shared between proofs for the same circuit.
+ *
+ * The proving key is either held in memory (`provingKey`), used in place
+ * from a memory mapped file (`mappedKey`), or read from disk in chunks
+ * during each proof (`streamKey`), exactly one of them is set.
+ * When `precomputedTables` is set they replace the H and L queries of the
+ * key, they are not used with a streamed key.
+ *
+ * The constraints are given either as `constraint_system`, from which
+ * `compact_constraints` is built by the first proof and reused by later
+ * proofs with the same constraint system, or directly in compact form as
+ * `compact_constraint_system` (e.g. from `R1CSBinaryFile::load_compact`),
+ * then no constraint objects need to be kept in memory.
+ */
 template<typename ppT>
 struct ProverContext
 {
-    r1cs_gg_ppzksnark_zok_proving_key_nozk<ppT>& provingKey;
+    r1cs_gg_ppzksnark_zok_proving_key_nozk<ppT>* provingKey;
+    const r1cs_gg_ppzksnark_zok_proving_key_mapped<ppT>* mappedKey;
+    const r1cs_gg_ppzksnark_zok_proving_key_stream<ppT>* streamKey;
+    const r1cs_gg_ppzksnark_zok_precomputed_tables<ppT>* precomputedTables;
     r1cs_gg_ppzksnark_zok_constraint_system<ppT>* constraint_system;
+    const r1cs_compact_constraints<libff::Fr<ppT>>* compact_constraint_system;
+    r1cs_compact_constraints<libff::Fr<ppT>> compact_constraints;
+    const r1cs_gg_ppzksnark_zok_constraint_system<ppT>* compact_constraints_source;
     Config config;
     std::shared_ptr<libfqfft::evaluation_domain<libff::Fr<ppT>>> domain;
     std::vector<libff::bigint<libff::Fr<ppT>::num_limbs>> scratch_exponents;
     std::vector<libff::Fr<ppT>> aA;
     std::vector<libff::Fr<ppT>> aB;
     std::vector<libff::Fr<ppT>> aH;
-    ProverContext(r1cs_gg_ppzksnark_zok_proving_key_nozk<ppT> & pk) : provingKey(pk){};
+    std::vector<std::vector<libff::bigint<libff::Fr<ppT>::num_limbs>>> batch_scratch_exponents;
+    std::vector<std::vector<libff::Fr<ppT>>> batch_aH;
+    ProverContext(r1cs_gg_ppzksnark_zok_proving_key_nozk<ppT> & pk) : provingKey(&pk), mappedKey(nullptr), streamKey(nullptr), precomputedTables(nullptr), constraint_system(nullptr), compact_constraint_system(nullptr), compact_constraints_source(nullptr) {};
+    ProverContext(const r1cs_gg_ppzksnark_zok_proving_key_mapped<ppT> & pk) : provingKey(nullptr), mappedKey(&pk), streamKey(nullptr), precomputedTables(nullptr), constraint_system(nullptr), compact_constraint_system(nullptr), compact_constraints_source(nullptr) {};
+    ProverContext(const r1cs_gg_ppzksnark_zok_proving_key_stream<ppT> & pk) : provingKey(nullptr), mappedKey(nullptr), streamKey(&pk), precomputedTables(nullptr), constraint_system(nullptr), compact_constraint_system(nullptr), compact_constraints_source(nullptr) {};
 };
 
 
@@ -380,18 +409,33 @@ std::istream& operator>>(std::istream &in, r1cs_gg_ppzksnark_zok_processed_verif
  *
  * Compared to a (non-processed) verification key, a processed verification key
  * contains a small constant amount of additional pre-computed information that
- * enables a faster verification time.
+ * enables a faster verification time: the Miller loop precomputations of gamma
+ * and delta, and the pairing e(alpha, beta), so only the pairings involving the
+ * proof are computed for each verification.
  */
 template<typename ppT>
 class r1cs_gg_ppzksnark_zok_processed_verification_key {
 public:
     libff::G1<ppT> vk_alpha_g1;
     libff::G2<ppT> vk_beta_g2;
+    libff::GT<ppT> vk_alpha_g1_beta_g2;
     libff::G2_precomp<ppT> vk_gamma_g2_precomp;
     libff::G2_precomp<ppT> vk_delta_g2_precomp;
 
     accumulation_vector<libff::G1<ppT> > gamma_ABC_g1;
 
+    /**
+     * Fixed-base tables of the input bases gamma_ABC_g1.rest, in the layout of
+     * r1cs_gg_ppzksnark_zok_precomputed_tables: `gamma_ABC_g1_table[k * count + i]`
+     * is base i * 2^(k * table_round_windows * table_window_bits).
+     * Empty unless built by r1cs_gg_ppzksnark_zok_verifier_precompute_input_tables
+     * for a key with enough inputs for the tables to pay off.
+     */
+    std::vector<libff::G1<ppT>> gamma_ABC_g1_table;
+    size_t table_window_bits = 0;
+    size_t table_expansion = 0;
+    size_t table_round_windows = 0;
+
     bool operator==(const r1cs_gg_ppzksnark_zok_processed_verification_key &other) const;
     friend std::ostream& operator<< <ppT>(std::ostream &out, const r1cs_gg_ppzksnark_zok_processed_verification_key<ppT> &pvk);
     friend std::istream& operator>> <ppT>(std::istream &in, r1cs_gg_ppzksnark_zok_processed_verification_key<ppT> &pvk);
@@ -421,6 +465,44 @@ public:
 };
 
 
+/******************************** Toxic waste ********************************/
+
+template<typename ppT>
+class r1cs_gg_ppzksnark_zok_toxic_waste;
+
+template<typename ppT>
+std::ostream& operator<<(std::ostream &out, const r1cs_gg_ppzksnark_zok_toxic_waste<ppT> &secrets);
+
+template<typename ppT>
+std::istream& operator>>(std::istream &in, r1cs_gg_ppzksnark_zok_toxic_waste<ppT> &secrets);
+
+/**
+ * The secrets sampled by the generator.
+ *
+ * Anyone holding them can forge proofs for the keys they were used for, so
+ * they are normally discarded. They are only kept for trusted local
+ * development setups, where the keys are regenerated incrementally as the
+ * circuit changes (see r1cs_gg_ppzksnark_zok_generator.hpp).
+ */
+template<typename ppT>
+class r1cs_gg_ppzksnark_zok_toxic_waste {
+public:
+    libff::Fr<ppT> t;
+    libff::Fr<ppT> alpha;
+    libff::Fr<ppT> beta;
+    libff::Fr<ppT> gamma;
+    libff::Fr<ppT> delta;
+    libff::G1<ppT> g1_generator;
+    libff::G2<ppT> g2_generator;
+
+    static r1cs_gg_ppzksnark_zok_toxic_waste<ppT> random();
+
+    bool operator==(const r1cs_gg_ppzksnark_zok_toxic_waste<ppT> &other) const;
+    friend std::ostream& operator<< <ppT>(std::ostream &out, const r1cs_gg_ppzksnark_zok_toxic_waste<ppT> &secrets);
+    friend std::istream& operator>> <ppT>(std::istream &in, r1cs_gg_ppzksnark_zok_toxic_waste<ppT> &secrets);
+};
+
+
 /*********************************** Proof ***********************************/
 
 template<typename ppT>
@@ -506,6 +588,13 @@ public:
 template<typename ppT>
 r1cs_gg_ppzksnark_zok_keypair<ppT> r1cs_gg_ppzksnark_zok_generator(const r1cs_gg_ppzksnark_zok_constraint_system<ppT> &cs);
 
+/**
+ * The generator with the given secrets, rather than freshly sampled ones.
+ */
+template<typename ppT>
+r1cs_gg_ppzksnark_zok_keypair<ppT> r1cs_gg_ppzksnark_zok_generator(const r1cs_gg_ppzksnark_zok_constraint_system<ppT> &cs,
+                                                               const r1cs_gg_ppzksnark_zok_toxic_waste<ppT> &secrets);
+
 /**
  * A prover algorithm for the R1CS GG-ppzkSNARK.
  *
@@ -519,6 +608,24 @@ r1cs_gg_ppzksnark_zok_proof<ppT> r1cs_gg_ppzksnark_zok_prover(const r1cs_gg_ppzk
                                                       const r1cs_gg_ppzksnark_zok_primary_input<ppT> &primary_input,
                                                       const r1cs_gg_ppzksnark_zok_auxiliary_input<ppT> &auxiliary_input);
 
+/**
+ * Prover using the key, domain and buffers held by the context.
+ */
+template<typename ppT>
+r1cs_gg_ppzksnark_zok_proof<ppT> r1cs_gg_ppzksnark_zok_prover(ProverContext<ppT> &context,
+                                                      const std::vector<libff::Fr<ppT>> &full_variable_assignment);
+
+/**
+ * Prove several full variable assignments for the same circuit at once.
+ *
+ * The witness maps are computed one after another with the shared domain,
+ * then each query of the proving key is traversed once for the whole batch
+ * rather than once per proof.
+ */
+template<typename ppT>
+std::vector<r1cs_gg_ppzksnark_zok_proof<ppT>> r1cs_gg_ppzksnark_zok_prover_batch(ProverContext<ppT> &context,
+                                                      const std::vector<std::vector<libff::Fr<ppT>>> &full_variable_assignments);
+
 /*
   Below are four variants of verifier algorithm for the R1CS GG-ppzkSNARK.
 
@@ -553,12 +660,37 @@ bool r1cs_gg_ppzksnark_zok_verifier_strong_IC(const r1cs_gg_ppzksnark_zok_verifi
                                           const r1cs_gg_ppzksnark_zok_primary_input<ppT> &primary_input,
                                           const r1cs_gg_ppzksnark_zok_proof<ppT> &proof);
 
+/**
+ * Keys with fewer inputs than this accumulate them without precomputed tables.
+ */
+static const size_t VERIFIER_INPUT_TABLE_MIN_INPUTS = 16;
+
 /**
  * Convert a (non-processed) verification key into a processed verification key.
  */
 template<typename ppT>
 r1cs_gg_ppzksnark_zok_processed_verification_key<ppT> r1cs_gg_ppzksnark_zok_verifier_process_vk(const r1cs_gg_ppzksnark_zok_verification_key<ppT> &vk);
 
+/**
+ * Precompute the multiples of the input bases of a processed key with many
+ * inputs, `table_expansion` per base (0 = one per window, so the accumulation
+ * needs no doublings).
+ *
+ * Building the tables costs far more than one accumulation, they are only
+ * worth it for keys kept to verify many proofs (see VerifierCache).
+ */
+template<typename ppT>
+void r1cs_gg_ppzksnark_zok_verifier_precompute_input_tables(r1cs_gg_ppzksnark_zok_processed_verification_key<ppT> &pvk,
+                                                            size_t table_expansion = 0);
+
+/**
+ * gamma_ABC_g1.first + sum_i primary_input[i] * gamma_ABC_g1.rest[i], using the
+ * precomputed tables of the processed key if it has them.
+ */
+template<typename ppT>
+libff::G1<ppT> r1cs_gg_ppzksnark_zok_accumulate_input(const r1cs_gg_ppzksnark_zok_processed_verification_key<ppT> &pvk,
+                                                      const r1cs_gg_ppzksnark_zok_primary_input<ppT> &primary_input);
+
 /**
  * A verifier algorithm for the R1CS GG-ppzkSNARK that:
  * (1) accepts a processed verification key, and
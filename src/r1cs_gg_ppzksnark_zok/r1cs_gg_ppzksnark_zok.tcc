@@ -19,6 +19,7 @@ See r1cs_gg_ppzksnark_zok.hpp .
 #include <functional>
 #include <iostream>
 #include <sstream>
+#include <stdexcept>
 
 #include <libff/algebra/scalar_multiplication/multiexp.hpp>
 #include <libff/common/profiling.hpp>
@@ -31,6 +32,8 @@ See r1cs_gg_ppzksnark_zok.hpp .
 #include <libsnark/knowledge_commitment/kc_multiexp.hpp>
 #include <libsnark/reductions/r1cs_to_qap/r1cs_to_qap.hpp>
 
+#include "r1cs_gg_ppzksnark_zok/multiexp.hpp"
+
 namespace libsnark {
 
 /******************************** Proving key ********************************/
@@ -188,9 +191,14 @@ bool r1cs_gg_ppzksnark_zok_processed_verification_key<ppT>::operator==(const r1c
 {
     return (this->vk_alpha_g1 == other.vk_alpha_g1 &&
             this->vk_beta_g2 == other.vk_beta_g2 &&
+            this->vk_alpha_g1_beta_g2 == other.vk_alpha_g1_beta_g2 &&
             this->vk_gamma_g2_precomp == other.vk_gamma_g2_precomp &&
             this->vk_delta_g2_precomp == other.vk_delta_g2_precomp &&
-            this->gamma_ABC_g1 == other.gamma_ABC_g1);
+            this->gamma_ABC_g1 == other.gamma_ABC_g1 &&
+            this->gamma_ABC_g1_table == other.gamma_ABC_g1_table &&
+            this->table_window_bits == other.table_window_bits &&
+            this->table_expansion == other.table_expansion &&
+            this->table_round_windows == other.table_round_windows);
 }
 
 template<typename ppT>
@@ -198,9 +206,14 @@ std::ostream& operator<<(std::ostream &out, const r1cs_gg_ppzksnark_zok_processe
 {
     out << pvk.vk_alpha_g1 << OUTPUT_NEWLINE;
     out << pvk.vk_beta_g2 << OUTPUT_NEWLINE;
+    out << pvk.vk_alpha_g1_beta_g2 << OUTPUT_NEWLINE;
     out << pvk.vk_gamma_g2_precomp << OUTPUT_NEWLINE;
     out << pvk.vk_delta_g2_precomp << OUTPUT_NEWLINE;
     out << pvk.gamma_ABC_g1 << OUTPUT_NEWLINE;
+    out << pvk.table_window_bits << OUTPUT_NEWLINE;
+    out << pvk.table_expansion << OUTPUT_NEWLINE;
+    out << pvk.table_round_windows << OUTPUT_NEWLINE;
+    out << pvk.gamma_ABC_g1_table << OUTPUT_NEWLINE;
 
     return out;
 }
@@ -212,12 +225,22 @@ std::istream& operator>>(std::istream &in, r1cs_gg_ppzksnark_zok_processed_verif
     libff::consume_OUTPUT_NEWLINE(in);
     in >> pvk.vk_beta_g2;
     libff::consume_OUTPUT_NEWLINE(in);
+    in >> pvk.vk_alpha_g1_beta_g2;
+    libff::consume_OUTPUT_NEWLINE(in);
     in >> pvk.vk_gamma_g2_precomp;
     libff::consume_OUTPUT_NEWLINE(in);
     in >> pvk.vk_delta_g2_precomp;
     libff::consume_OUTPUT_NEWLINE(in);
     in >> pvk.gamma_ABC_g1;
     libff::consume_OUTPUT_NEWLINE(in);
+    in >> pvk.table_window_bits;
+    libff::consume_OUTPUT_NEWLINE(in);
+    in >> pvk.table_expansion;
+    libff::consume_OUTPUT_NEWLINE(in);
+    in >> pvk.table_round_windows;
+    libff::consume_OUTPUT_NEWLINE(in);
+    in >> pvk.gamma_ABC_g1_table;
+    libff::consume_OUTPUT_NEWLINE(in);
 
     return in;
 }
@@ -274,57 +297,119 @@ r1cs_gg_ppzksnark_zok_verification_key<ppT> r1cs_gg_ppzksnark_zok_verification_k
     return result;
 }
 
+template<typename ppT>
+r1cs_gg_ppzksnark_zok_toxic_waste<ppT> r1cs_gg_ppzksnark_zok_toxic_waste<ppT>::random()
+{
+    r1cs_gg_ppzksnark_zok_toxic_waste<ppT> result;
+    result.t = libff::Fr<ppT>::random_element();
+    result.alpha = libff::Fr<ppT>::random_element();
+    result.beta = libff::Fr<ppT>::random_element();
+    result.gamma = libff::Fr<ppT>::random_element();
+    result.delta = libff::Fr<ppT>::random_element();
+    result.g1_generator = libff::G1<ppT>::random_element();
+    result.g2_generator = libff::G2<ppT>::random_element();
+    return result;
+}
+
+template<typename ppT>
+bool r1cs_gg_ppzksnark_zok_toxic_waste<ppT>::operator==(const r1cs_gg_ppzksnark_zok_toxic_waste<ppT> &other) const
+{
+    return (this->t == other.t &&
+            this->alpha == other.alpha &&
+            this->beta == other.beta &&
+            this->gamma == other.gamma &&
+            this->delta == other.delta &&
+            this->g1_generator == other.g1_generator &&
+            this->g2_generator == other.g2_generator);
+}
+
+template<typename ppT>
+std::ostream& operator<<(std::ostream &out, const r1cs_gg_ppzksnark_zok_toxic_waste<ppT> &secrets)
+{
+    out << secrets.t << OUTPUT_NEWLINE;
+    out << secrets.alpha << OUTPUT_NEWLINE;
+    out << secrets.beta << OUTPUT_NEWLINE;
+    out << secrets.gamma << OUTPUT_NEWLINE;
+    out << secrets.delta << OUTPUT_NEWLINE;
+    out << secrets.g1_generator << OUTPUT_NEWLINE;
+    out << secrets.g2_generator << OUTPUT_NEWLINE;
+
+    return out;
+}
+
+template<typename ppT>
+std::istream& operator>>(std::istream &in, r1cs_gg_ppzksnark_zok_toxic_waste<ppT> &secrets)
+{
+    in >> secrets.t;
+    libff::consume_OUTPUT_NEWLINE(in);
+    in >> secrets.alpha;
+    libff::consume_OUTPUT_NEWLINE(in);
+    in >> secrets.beta;
+    libff::consume_OUTPUT_NEWLINE(in);
+    in >> secrets.gamma;
+    libff::consume_OUTPUT_NEWLINE(in);
+    in >> secrets.delta;
+    libff::consume_OUTPUT_NEWLINE(in);
+    in >> secrets.g1_generator;
+    libff::consume_OUTPUT_NEWLINE(in);
+    in >> secrets.g2_generator;
+    libff::consume_OUTPUT_NEWLINE(in);
+
+    return in;
+}
+
 template <typename ppT>
 r1cs_gg_ppzksnark_zok_keypair<ppT> r1cs_gg_ppzksnark_zok_generator(const r1cs_gg_ppzksnark_zok_constraint_system<ppT> &r1cs)
 {
-    libff::enter_block("Call to r1cs_gg_ppzksnark_zok_generator");
-
     /* Generate secret randomness */
-    const libff::Fr<ppT> t = libff::Fr<ppT>::random_element();
-    const libff::Fr<ppT> alpha = libff::Fr<ppT>::random_element();
-    const libff::Fr<ppT> beta = libff::Fr<ppT>::random_element();
-    const libff::Fr<ppT> gamma = libff::Fr<ppT>::random_element();
-    const libff::Fr<ppT> delta = libff::Fr<ppT>::random_element();
+    return r1cs_gg_ppzksnark_zok_generator<ppT>(r1cs, r1cs_gg_ppzksnark_zok_toxic_waste<ppT>::random());
+}
+
+/**
+ * The keys from the QAP evaluated at t: At, Bt and Ct per variable and Ht
+ * the powers of t for the H query, which for Groth's proof system has
+ * degree d-2.
+ */
+template <typename ppT>
+r1cs_gg_ppzksnark_zok_keypair<ppT> r1cs_gg_ppzksnark_zok_generator_from_evaluation(libff::Fr_vector<ppT> At,
+                                                                               libff::Fr_vector<ppT> Bt,
+                                                                               libff::Fr_vector<ppT> Ct,
+                                                                               libff::Fr_vector<ppT> Ht,
+                                                                               const libff::Fr<ppT> &Zt,
+                                                                               const size_t num_inputs,
+                                                                               const size_t num_variables,
+                                                                               const r1cs_gg_ppzksnark_zok_toxic_waste<ppT> &secrets)
+{
+    const libff::Fr<ppT> &alpha = secrets.alpha;
+    const libff::Fr<ppT> &beta = secrets.beta;
+    const libff::Fr<ppT> &gamma = secrets.gamma;
+    const libff::Fr<ppT> &delta = secrets.delta;
     const libff::Fr<ppT> gamma_inverse = gamma.inverse();
     const libff::Fr<ppT> delta_inverse = delta.inverse();
 
-    /* A quadratic arithmetic program evaluated at t. */
-    qap_instance_evaluation<libff::Fr<ppT> > qap = r1cs_to_qap_instance_map_with_evaluation(r1cs, t);
-
-    libff::print_indent(); printf("* QAP number of variables: %zu\n", qap.num_variables());
-    libff::print_indent(); printf("* QAP pre degree: %zu\n", r1cs.constraints.size());
-    libff::print_indent(); printf("* QAP degree: %zu\n", qap.degree());
-    libff::print_indent(); printf("* QAP number of input variables: %zu\n", qap.num_inputs());
-
     libff::enter_block("Compute query densities");
     size_t non_zero_At = 0;
     size_t non_zero_Bt = 0;
-    for (size_t i = 0; i < qap.num_variables() + 1; ++i)
+    for (size_t i = 0; i < num_variables + 1; ++i)
     {
-        if (!qap.At[i].is_zero())
+        if (!At[i].is_zero())
         {
             ++non_zero_At;
         }
-        if (!qap.Bt[i].is_zero())
+        if (!Bt[i].is_zero())
         {
             ++non_zero_Bt;
         }
     }
     libff::leave_block("Compute query densities");
 
-    /* qap.{At,Bt,Ct,Ht} are now in unspecified state, but we do not use them later */
-    libff::Fr_vector<ppT> At = std::move(qap.At);
-    libff::Fr_vector<ppT> Bt = std::move(qap.Bt);
-    libff::Fr_vector<ppT> Ct = std::move(qap.Ct);
-    libff::Fr_vector<ppT> Ht = std::move(qap.Ht);
-
     /* The gamma inverse product component: (beta*A_i(t) + alpha*B_i(t) + C_i(t)) * gamma^{-1}. */
     libff::enter_block("Compute gamma_ABC for R1CS verification key");
     libff::Fr_vector<ppT> gamma_ABC;
-    gamma_ABC.reserve(qap.num_inputs());
+    gamma_ABC.reserve(num_inputs);
 
     const libff::Fr<ppT> gamma_ABC_0 = (beta * At[0] + alpha * Bt[0] + Ct[0]) * gamma_inverse;
-    for (size_t i = 1; i < qap.num_inputs() + 1; ++i)
+    for (size_t i = 1; i < num_inputs + 1; ++i)
     {
         gamma_ABC.emplace_back((beta * At[i] + alpha * Bt[i] + Ct[i]) * gamma_inverse);
     }
@@ -333,22 +418,15 @@ r1cs_gg_ppzksnark_zok_keypair<ppT> r1cs_gg_ppzksnark_zok_generator(const r1cs_gg
     /* The delta inverse product component: (beta*A_i(t) + alpha*B_i(t) + C_i(t)) * delta^{-1}. */
     libff::enter_block("Compute L query for R1CS proving key");
     libff::Fr_vector<ppT> Lt;
-    Lt.reserve(qap.num_variables() - qap.num_inputs());
+    Lt.reserve(num_variables - num_inputs);
 
-    const size_t Lt_offset = qap.num_inputs() + 1;
-    for (size_t i = 0; i < qap.num_variables() - qap.num_inputs(); ++i)
+    const size_t Lt_offset = num_inputs + 1;
+    for (size_t i = 0; i < num_variables - num_inputs; ++i)
     {
         Lt.emplace_back((beta * At[Lt_offset + i] + alpha * Bt[Lt_offset + i] + Ct[Lt_offset + i]) * delta_inverse);
     }
     libff::leave_block("Compute L query for R1CS proving key");
 
-    /**
-     * Note that H for Groth's proof system is degree d-2, but the QAP
-     * reduction returns coefficients for degree d polynomial H (in
-     * style of PGHR-type proof systems)
-     */
-    Ht.resize(Ht.size() - 2);
-
 #ifdef MULTICORE
     const size_t chunks = omp_get_max_threads(); // to override, set OMP_NUM_THREADS env var or call omp_set_num_threads()
 #else
@@ -356,8 +434,8 @@ r1cs_gg_ppzksnark_zok_keypair<ppT> r1cs_gg_ppzksnark_zok_generator(const r1cs_gg
 #endif
 
     libff::enter_block("Generating G1 MSM window table");
-    const libff::G1<ppT> g1_generator = libff::G1<ppT>::random_element();
-    const size_t g1_scalar_count = non_zero_At + non_zero_Bt + qap.num_variables();
+    const libff::G1<ppT> &g1_generator = secrets.g1_generator;
+    const size_t g1_scalar_count = non_zero_At + non_zero_Bt + num_variables;
     const size_t g1_scalar_size = libff::Fr<ppT>::size_in_bits();
     const size_t g1_window_size = libff::get_exp_window_size<libff::G1<ppT> >(g1_scalar_count);
 
@@ -366,7 +444,7 @@ r1cs_gg_ppzksnark_zok_keypair<ppT> r1cs_gg_ppzksnark_zok_generator(const r1cs_gg
     libff::leave_block("Generating G1 MSM window table");
 
     libff::enter_block("Generating G2 MSM window table");
-    const libff::G2<ppT> G2_gen = libff::G2<ppT>::random_element();
+    const libff::G2<ppT> &G2_gen = secrets.g2_generator;
     const size_t g2_scalar_count = non_zero_Bt;
     const size_t g2_scalar_size = libff::Fr<ppT>::size_in_bits();
     size_t g2_window_size = libff::get_exp_window_size<libff::G2<ppT> >(g2_scalar_count);
@@ -397,7 +475,7 @@ r1cs_gg_ppzksnark_zok_keypair<ppT> r1cs_gg_ppzksnark_zok_generator(const r1cs_gg
     libff::leave_block("Compute the B-query", false);
 
     libff::enter_block("Compute the H-query", false);
-    libff::G1_vector<ppT> H_query = batch_exp_with_coeff(g1_scalar_size, g1_window_size, g1_table, qap.Zt * delta_inverse, Ht);
+    libff::G1_vector<ppT> H_query = batch_exp_with_coeff(g1_scalar_size, g1_window_size, g1_table, Zt * delta_inverse, Ht);
 #ifdef USE_MIXED_ADDITION
     libff::batch_to_special<libff::G1<ppT> >(H_query);
 #endif
@@ -422,8 +500,6 @@ r1cs_gg_ppzksnark_zok_keypair<ppT> r1cs_gg_ppzksnark_zok_generator(const r1cs_gg
     libff::leave_block("Encode gamma_ABC for R1CS verification key");
     libff::leave_block("Generate R1CS verification key");
 
-    libff::leave_block("Call to r1cs_gg_ppzksnark_zok_generator");
-
     accumulation_vector<libff::G1<ppT> > gamma_ABC_g1(std::move(gamma_ABC_g1_0), std::move(gamma_ABC_g1_values));
 
     r1cs_gg_ppzksnark_zok_verification_key<ppT> vk = r1cs_gg_ppzksnark_zok_verification_key<ppT>(alpha_g1,
@@ -449,22 +525,455 @@ r1cs_gg_ppzksnark_zok_keypair<ppT> r1cs_gg_ppzksnark_zok_generator(const r1cs_gg
 }
 
 template <typename ppT>
-r1cs_gg_ppzksnark_zok_proof<ppT> r1cs_gg_ppzksnark_zok_prover(ProverContext<ppT>& context, const std::vector<libff::Fr<ppT>>& full_variable_assignment)
+r1cs_gg_ppzksnark_zok_keypair<ppT> r1cs_gg_ppzksnark_zok_generator(const r1cs_gg_ppzksnark_zok_constraint_system<ppT> &r1cs,
+                                                               const r1cs_gg_ppzksnark_zok_toxic_waste<ppT> &secrets)
+{
+    libff::enter_block("Call to r1cs_gg_ppzksnark_zok_generator");
+
+    /* A quadratic arithmetic program evaluated at t. */
+    qap_instance_evaluation<libff::Fr<ppT> > qap = r1cs_to_qap_instance_map_with_evaluation(r1cs, secrets.t);
+
+    libff::print_indent(); printf("* QAP number of variables: %zu\n", qap.num_variables());
+    libff::print_indent(); printf("* QAP pre degree: %zu\n", r1cs.constraints.size());
+    libff::print_indent(); printf("* QAP degree: %zu\n", qap.degree());
+    libff::print_indent(); printf("* QAP number of input variables: %zu\n", qap.num_inputs());
+
+    /**
+     * Note that H for Groth's proof system is degree d-2, but the QAP
+     * reduction returns coefficients for degree d polynomial H (in
+     * style of PGHR-type proof systems)
+     */
+    qap.Ht.resize(qap.Ht.size() - 2);
+
+    /* qap.{At,Bt,Ct,Ht} are now in unspecified state, but we do not use them later */
+    auto keypair = r1cs_gg_ppzksnark_zok_generator_from_evaluation<ppT>(std::move(qap.At), std::move(qap.Bt), std::move(qap.Ct), std::move(qap.Ht),
+                                                                         qap.Zt, qap.num_inputs(), qap.num_variables(), secrets);
+
+    libff::leave_block("Call to r1cs_gg_ppzksnark_zok_generator");
+    return keypair;
+}
+
+/**
+ * The prover multi-exponentiations are dispatched on the type of the query
+ * and the engine selected for it in `Config`. Queries held in std::vectors
+ * use libff's BDLO12 multi_exp unless "pippenger" is selected, queries used
+ * in place (e.g. from a memory mapped key) always use the signed digit
+ * bucket method over raw arrays.
+ */
+template<typename T, typename FieldT>
+T prover_sparse_multi_exp(const sparse_vector<T>& query,
+                          const std::vector<FieldT>& scalars,
+                          size_t length,
+                          const std::string& method,
+                          std::vector<libff::bigint<FieldT::num_limbs>>& scratch_exponents,
+                          const Config& config)
+{
+    if (method == "pippenger")
+    {
+        return sparse_multi_exp_array<T, FieldT>(
+            query.values.data(),
+            query.indices.data(),
+            query.size(),
+            scalars.data(),
+            length,
+            scratch_exponents,
+            config);
+    }
+    return kc_multi_exp_with_mixed_addition<T, FieldT, libff::multi_exp_method_BDLO12>(
+        query,
+        scalars.begin(),
+        scalars.begin() + length,
+        scratch_exponents,
+        config);
+}
+
+template<typename T, typename FieldT>
+T prover_sparse_multi_exp(const sparse_vector_view<T>& query,
+                          const std::vector<FieldT>& scalars,
+                          size_t length,
+                          const std::string& method,
+                          std::vector<libff::bigint<FieldT::num_limbs>>& scratch_exponents,
+                          const Config& config)
+{
+    libff::UNUSED(method);
+    return sparse_multi_exp_array<T, FieldT>(
+        query.values.data(),
+        query.indices.data(),
+        query.size(),
+        scalars.data(),
+        length,
+        scratch_exponents,
+        config);
+}
+
+template<typename T, typename FieldT>
+T prover_multi_exp(const std::vector<T>& query,
+                   const std::vector<FieldT>& scalars,
+                   size_t scalars_offset,
+                   size_t length,
+                   bool with_mixed_addition,
+                   const std::string& method,
+                   std::vector<libff::bigint<FieldT::num_limbs>>& scratch_exponents,
+                   const Config& config)
+{
+    if (method == "pippenger")
+    {
+        return multi_exp_array<T, FieldT>(
+            query.data(),
+            scalars.data() + scalars_offset,
+            length,
+            scratch_exponents,
+            config);
+    }
+    if (with_mixed_addition)
+    {
+        return libff::multi_exp_with_mixed_addition<T, FieldT, libff::multi_exp_method_BDLO12>(
+            query.begin(),
+            query.begin() + length,
+            scalars.begin() + scalars_offset,
+            scalars.begin() + scalars_offset + length,
+            scratch_exponents,
+            config);
+    }
+    return libff::multi_exp<T, FieldT, libff::multi_exp_method_BDLO12>(
+        query.begin(),
+        query.begin() + length,
+        scalars.begin() + scalars_offset,
+        scalars.begin() + scalars_offset + length,
+        scratch_exponents,
+        config);
+}
+
+template<typename T, typename FieldT>
+T prover_multi_exp(const array_view<T>& query,
+                   const std::vector<FieldT>& scalars,
+                   size_t scalars_offset,
+                   size_t length,
+                   bool with_mixed_addition,
+                   const std::string& method,
+                   std::vector<libff::bigint<FieldT::num_limbs>>& scratch_exponents,
+                   const Config& config)
+{
+    libff::UNUSED(with_mixed_addition, method);
+    return multi_exp_array<T, FieldT>(
+        query.data(),
+        scalars.data() + scalars_offset,
+        length,
+        scratch_exponents,
+        config);
+}
+
+template<typename ppT>
+libff::G1<ppT> prover_precomputed_multi_exp(const r1cs_gg_ppzksnark_zok_precomputed_tables<ppT>& tables,
+                                           const array_view<libff::G1<ppT>>& table,
+                                           const libff::Fr<ppT>* scalars,
+                                           std::vector<libff::bigint<libff::Fr<ppT>::num_limbs>>& scratch_exponents,
+                                           const Config& config)
+{
+    return multi_exp_precomputed<libff::G1<ppT>, libff::Fr<ppT>>(
+        table.data(),
+        table.size() / tables.expansion,
+        tables.expansion,
+        tables.round_windows,
+        tables.window_bits,
+        scalars,
+        scratch_exponents,
+        config);
+}
+
+/**
+ * Whether the task prover splits the multi-exponentiation of a query into
+ * chunks. Queries used in place always use the bucket method, queries held
+ * in std::vectors only with the "pippenger" engine, otherwise their engine
+ * computes them as a single task.
+ */
+template<typename T>
+bool prover_query_chunked(const std::vector<T>& query, const std::string& method)
+{
+    libff::UNUSED(query);
+    return method == "pippenger";
+}
+
+template<typename T>
+bool prover_query_chunked(const sparse_vector<T>& query, const std::string& method)
+{
+    libff::UNUSED(query);
+    return method == "pippenger";
+}
+
+template<typename T>
+bool prover_query_chunked(const array_view<T>& query, const std::string& method)
+{
+    libff::UNUSED(query, method);
+    return true;
+}
+
+template<typename T>
+bool prover_query_chunked(const sparse_vector_view<T>& query, const std::string& method)
+{
+    libff::UNUSED(query, method);
+    return true;
+}
+
+/**
+ * The constraints in compact form: those given by the caller, or those of
+ * the context's constraint system, built when it differs from the one they
+ * were last built from
+ */
+template<typename ppT>
+const r1cs_compact_constraints<libff::Fr<ppT>>& prover_compact_constraints(ProverContext<ppT>& context)
+{
+    if (context.compact_constraint_system != nullptr)
+    {
+        return *context.compact_constraint_system;
+    }
+    if (context.constraint_system == nullptr)
+    {
+        throw std::invalid_argument("The prover context has no constraint system");
+    }
+    if (context.compact_constraints_source != context.constraint_system
+        || !context.compact_constraints.matches(*context.constraint_system))
+    {
+        context.compact_constraints.build(*context.constraint_system, context.config);
+        context.compact_constraints_source = context.constraint_system;
+    }
+    return context.compact_constraints;
+}
+
+/**
+ * Prover where the H polynomial and chunks of the four multi-exponentiations
+ * run as OpenMP tasks. Chunks are sized by cost, a G2 addition being roughly
+ * three times a G1 addition, so threads which finish early pick up work from
+ * the other queries instead of idling at the tail of each multi-exp.
+ *
+ * The engine selected for each query is honoured: only queries using the
+ * bucket method are chunked (see `prover_query_chunked`), a query with
+ * another engine is one task running that engine over the whole query.
+ */
+template <typename ppT, typename ProvingKeyT>
+r1cs_gg_ppzksnark_zok_proof<ppT> r1cs_gg_ppzksnark_zok_prover_tasks(ProverContext<ppT>& context, const ProvingKeyT& pk, const std::vector<libff::Fr<ppT>>& full_variable_assignment)
+{
+    libff::enter_block("Call to r1cs_gg_ppzksnark_zok_prover_tasks");
+
+    const std::shared_ptr<libfqfft::evaluation_domain<libff::Fr<ppT>>>& domain = context.domain;
+    const r1cs_compact_constraints<libff::Fr<ppT>>& cs = prover_compact_constraints(context);
+    const Config& config = context.config;
+
+#ifdef DEBUG
+    assert(full_variable_assignment.size() == cs.num_variables + 1);
+    assert(pk.A_query.domain_size() == cs.num_variables+1);
+    assert(pk.B_query.domain_size() == cs.num_variables+1);
+    assert(pk.H_query.size() == domain->m - 1);
+    assert(pk.L_query.size() == cs.num_variables - cs.num_inputs);
+#endif
+
+    const size_t G2_cost = 3;
+    const size_t min_chunk = 1024;
+    const size_t tasks_per_thread = 4;
+
+    const size_t A_count = pk.A_query.size();
+    const size_t B_count = pk.B_query.size();
+    const size_t H_count = domain->m - 1;
+    const size_t L_count = cs.num_variables - cs.num_inputs;
+    const size_t total_cost = A_count + (G2_cost * B_count) + H_count + L_count;
+    const size_t chunk_cost = (total_cost / (std::max(config.num_threads, 1u) * tasks_per_thread)) + 1;
+
+    const auto* tables = context.precomputedTables;
+    const bool A_chunked = prover_query_chunked(pk.A_query, config.multi_exp_A);
+    const bool B_chunked = prover_query_chunked(pk.B_query, config.multi_exp_B);
+    const bool H_chunked = tables || prover_query_chunked(pk.H_query, config.multi_exp_H);
+    const bool L_chunked = tables || prover_query_chunked(pk.L_query, config.multi_exp_L);
+
+    typedef std::vector<std::pair<size_t, size_t>> chunk_list;
+    const auto A_chunks = A_chunked ? multi_exp_cost_chunks(A_count, 1, chunk_cost, min_chunk) : chunk_list();
+    const auto B_chunks = B_chunked ? multi_exp_cost_chunks(B_count, G2_cost, chunk_cost, min_chunk) : chunk_list();
+    const auto H_chunks = H_chunked ? multi_exp_cost_chunks(H_count, 1, chunk_cost, min_chunk) : chunk_list();
+    const auto L_chunks = L_chunked ? multi_exp_cost_chunks(L_count, 1, chunk_cost, min_chunk) : chunk_list();
+
+    // Each query has its own region of the scratch exponents
+    const size_t B_offset = A_count;
+    const size_t H_offset = B_offset + B_count;
+    const size_t L_offset = H_offset + H_count;
+    if (context.scratch_exponents.size() < L_offset + L_count)
+    {
+        context.scratch_exponents.resize(L_offset + L_count);
+    }
+    auto* exponents = context.scratch_exponents.data();
+
+    // The partial results of the chunks, or of the whole query when it isn't chunked
+    std::vector<libff::G1<ppT>> A_partial(A_chunked ? A_chunks.size() : 1, libff::G1<ppT>::zero());
+    std::vector<libff::G2<ppT>> B_partial(B_chunked ? B_chunks.size() : 1, libff::G2<ppT>::zero());
+    std::vector<libff::G1<ppT>> H_partial(H_chunked ? H_chunks.size() : 1, libff::G1<ppT>::zero());
+    std::vector<libff::G1<ppT>> L_partial(L_chunked ? L_chunks.size() : 1, libff::G1<ppT>::zero());
+
+    // Queries computed as a single task have their own scratch exponents
+    std::vector<libff::bigint<libff::Fr<ppT>::num_limbs>> A_scratch, B_scratch, H_scratch, L_scratch;
+
+    const libff::Fr<ppT>* scalars = full_variable_assignment.data();
+    const size_t num_scalars = cs.num_variables + 1;
+    int H_ready = 0;
+
+    libff::enter_block("Compute the proof");
+#ifdef MULTICORE
+    #pragma omp parallel num_threads(config.num_threads)
+    #pragma omp single
+#endif
+    {
+        // The H polynomial is on the critical path of the H-query, start it first
+#ifdef MULTICORE
+        #pragma omp task depend(out: H_ready)
+#endif
+        r1cs_to_qap_witness_map_compact(domain, cs, full_variable_assignment, context.aA, context.aB, context.aH, true, config);
+
+        // Queries which aren't chunked take longest, they go next
+        if (!B_chunked)
+        {
+#ifdef MULTICORE
+            #pragma omp task
+#endif
+            B_partial[0] = prover_sparse_multi_exp(pk.B_query, full_variable_assignment, num_scalars, config.multi_exp_B, B_scratch, config);
+        }
+
+        if (!L_chunked)
+        {
+#ifdef MULTICORE
+            #pragma omp task
+#endif
+            L_partial[0] = prover_multi_exp(pk.L_query, full_variable_assignment, cs.num_inputs + 1, L_count, true, config.multi_exp_L, L_scratch, config);
+        }
+
+        if (!A_chunked)
+        {
+#ifdef MULTICORE
+            #pragma omp task
+#endif
+            A_partial[0] = prover_sparse_multi_exp(pk.A_query, full_variable_assignment, num_scalars, config.multi_exp_A, A_scratch, config);
+        }
+
+        if (!H_chunked)
+        {
+#ifdef MULTICORE
+            #pragma omp task depend(in: H_ready)
+#endif
+            H_partial[0] = prover_multi_exp(pk.H_query, context.aH, 0, H_count, false, config.multi_exp_H, H_scratch, config);
+        }
+
+        // Then the largest chunks, so the smaller ones fill in the tail
+        for (size_t i = 0; i < B_chunks.size(); i++)
+        {
+#ifdef MULTICORE
+            #pragma omp task
+#endif
+            B_partial[i] = sparse_multi_exp_array_chunk(
+                pk.B_query.values.data(), pk.B_query.indices.data(), scalars, num_scalars,
+                exponents + B_offset, B_chunks[i].first, B_chunks[i].second, config);
+        }
+
+        for (size_t i = 0; i < L_chunks.size(); i++)
+        {
+#ifdef MULTICORE
+            #pragma omp task
+#endif
+            L_partial[i] = tables ?
+                multi_exp_precomputed_chunk(
+                    tables->L_table.data(), L_count, tables->expansion, tables->round_windows, tables->window_bits,
+                    scalars + cs.num_inputs + 1, exponents + L_offset, L_chunks[i].first, L_chunks[i].second, config) :
+                multi_exp_array_chunk(
+                    pk.L_query.data(), scalars + cs.num_inputs + 1,
+                    exponents + L_offset, L_chunks[i].first, L_chunks[i].second, config);
+        }
+
+        for (size_t i = 0; i < A_chunks.size(); i++)
+        {
+#ifdef MULTICORE
+            #pragma omp task
+#endif
+            A_partial[i] = sparse_multi_exp_array_chunk(
+                pk.A_query.values.data(), pk.A_query.indices.data(), scalars, num_scalars,
+                exponents, A_chunks[i].first, A_chunks[i].second, config);
+        }
+
+        for (size_t i = 0; i < H_chunks.size(); i++)
+        {
+#ifdef MULTICORE
+            #pragma omp task depend(in: H_ready)
+#endif
+            H_partial[i] = tables ?
+                multi_exp_precomputed_chunk(
+                    tables->H_table.data(), H_count, tables->expansion, tables->round_windows, tables->window_bits,
+                    context.aH.data(), exponents + H_offset, H_chunks[i].first, H_chunks[i].second, config) :
+                multi_exp_array_chunk(
+                    pk.H_query.data(), context.aH.data(),
+                    exponents + H_offset, H_chunks[i].first, H_chunks[i].second, config);
+        }
+    }
+
+    /* We are dividing degree 2(d-1) polynomial by degree d polynomial
+       and not adding a PGHR-style ZK-patch, so our H is degree d-2 */
+    assert(!context.aH[domain->m-2].is_zero());
+    assert(context.aH[domain->m-1].is_zero());
+    assert(context.aH[domain->m].is_zero());
+
+    /* A = alpha + sum_i(a_i*A_i(t)) */
+    libff::G1<ppT> g1_A = pk.alpha_g1;
+    for (const auto& p : A_partial)
+    {
+        g1_A = g1_A + p;
+    }
+
+    /* B = beta + sum_i(a_i*B_i(t)) */
+    libff::G2<ppT> g2_B = pk.beta_g2;
+    for (const auto& p : B_partial)
+    {
+        g2_B = g2_B + p;
+    }
+
+    /* C = sum_i(a_i*((beta*A_i(t) + alpha*B_i(t) + C_i(t)) + H(t)*Z(t))/delta) */
+    libff::G1<ppT> g1_C = libff::G1<ppT>::zero();
+    for (const auto& p : H_partial)
+    {
+        g1_C = g1_C + p;
+    }
+    for (const auto& p : L_partial)
+    {
+        g1_C = g1_C + p;
+    }
+    libff::leave_block("Compute the proof");
+
+    libff::leave_block("Call to r1cs_gg_ppzksnark_zok_prover_tasks");
+
+    return r1cs_gg_ppzksnark_zok_proof<ppT>(std::move(g1_A), std::move(g2_B), std::move(g1_C));
+}
+
+template <typename ppT, typename ProvingKeyT>
+r1cs_gg_ppzksnark_zok_proof<ppT> r1cs_gg_ppzksnark_zok_prover(ProverContext<ppT>& context, const ProvingKeyT& pk, const std::vector<libff::Fr<ppT>>& full_variable_assignment)
 {
+    // Tables from another key would give wrong proofs, or read past their end
+    if (context.precomputedTables != nullptr && !context.precomputedTables->matches(pk))
+    {
+        throw std::invalid_argument("Precomputed tables do not match the proving key");
+    }
+
+    if (context.config.task_scheduler)
+    {
+        return r1cs_gg_ppzksnark_zok_prover_tasks<ppT>(context, pk, full_variable_assignment);
+    }
+
     libff::enter_block("Call to r1cs_gg_ppzksnark_zok_prover");
 
     const std::shared_ptr<libfqfft::evaluation_domain<libff::Fr<ppT>>>& domain = context.domain;
-    const r1cs_gg_ppzksnark_zok_proving_key_nozk<ppT>& pk = context.provingKey;
-    const r1cs_constraint_system<libff::Fr<ppT>>& cs = *context.constraint_system;
+    const r1cs_compact_constraints<libff::Fr<ppT>>& cs = prover_compact_constraints(context);
 
     libff::enter_block("Compute the polynomial H");
-    r1cs_to_qap_witness_map(
+    r1cs_to_qap_witness_map_compact(
         context.domain,
         cs,
         full_variable_assignment,
         context.aA,
         context.aB,
-        context.aH
+        context.aH,
+        false,
+        context.config
     );
 
     /* We are dividing degree 2(d-1) polynomial by degree d polynomial
@@ -475,59 +984,71 @@ r1cs_gg_ppzksnark_zok_proof<ppT> r1cs_gg_ppzksnark_zok_prover(ProverContext<ppT>
     libff::leave_block("Compute the polynomial H");
 
 #ifdef DEBUG
-    assert(full_variable_assignment.size() == cs.num_variables() + 1);
-    assert(pk.A_query.domain_size() == cs.num_variables()+1);
-    assert(pk.B_query.domain_size() == cs.num_variables()+1);
+    assert(full_variable_assignment.size() == cs.num_variables + 1);
+    assert(pk.A_query.domain_size() == cs.num_variables+1);
+    assert(pk.B_query.domain_size() == cs.num_variables+1);
     assert(pk.H_query.size() == domain->m - 1);
-    assert(pk.L_query.size() == cs.num_variables() - cs.num_inputs());
+    assert(pk.L_query.size() == cs.num_variables - cs.num_inputs);
 #endif
 
     libff::enter_block("Compute the proof");
 
     libff::enter_block("Compute evaluation to A-query", false);
-    libff::G1<ppT> evaluation_At = kc_multi_exp_with_mixed_addition<libff::G1<ppT>,
-                                                                    libff::Fr<ppT>,
-                                                                    libff::multi_exp_method_BDLO12>(
+    libff::G1<ppT> evaluation_At = prover_sparse_multi_exp(
         pk.A_query,
-        full_variable_assignment.begin(),
-        full_variable_assignment.begin() + cs.num_variables() + 1,
+        full_variable_assignment,
+        cs.num_variables + 1,
+        context.config.multi_exp_A,
         context.scratch_exponents,
         context.config);
     libff::leave_block("Compute evaluation to A-query", false);
 
     libff::enter_block("Compute evaluation to B-query", false);
-    libff::G2<ppT> evaluation_Bt = kc_multi_exp_with_mixed_addition<libff::G2<ppT>,
-                                                                    libff::Fr<ppT>,
-                                                                    libff::multi_exp_method_BDLO12>(
+    libff::G2<ppT> evaluation_Bt = prover_sparse_multi_exp(
         pk.B_query,
-        full_variable_assignment.begin(),
-        full_variable_assignment.begin() + cs.num_variables() + 1,
+        full_variable_assignment,
+        cs.num_variables + 1,
+        context.config.multi_exp_B,
         context.scratch_exponents,
         context.config);
     libff::leave_block("Compute evaluation to B-query", false);
 
     libff::enter_block("Compute evaluation to H-query", false);
-    libff::G1<ppT> evaluation_Ht = libff::multi_exp<libff::G1<ppT>,
-                                                    libff::Fr<ppT>,
-                                                    libff::multi_exp_method_BDLO12>(
-        pk.H_query.begin(),
-        pk.H_query.begin() + (domain->m - 1),
-        context.aH.begin(),
-        context.aH.begin() + (domain->m - 1),
-        context.scratch_exponents,
-        context.config);
+    libff::G1<ppT> evaluation_Ht = context.precomputedTables ?
+        prover_precomputed_multi_exp(
+            *context.precomputedTables,
+            context.precomputedTables->H_table,
+            context.aH.data(),
+            context.scratch_exponents,
+            context.config) :
+        prover_multi_exp(
+            pk.H_query,
+            context.aH,
+            0,
+            domain->m - 1,
+            false,
+            context.config.multi_exp_H,
+            context.scratch_exponents,
+            context.config);
     libff::leave_block("Compute evaluation to H-query", false);
 
     libff::enter_block("Compute evaluation to L-query", false);
-    libff::G1<ppT> evaluation_Lt = libff::multi_exp_with_mixed_addition<libff::G1<ppT>,
-                                                                        libff::Fr<ppT>,
-                                                                        libff::multi_exp_method_BDLO12>(
-        pk.L_query.begin(),
-        pk.L_query.end(),
-        full_variable_assignment.begin() + cs.num_inputs() + 1,
-        full_variable_assignment.begin() + cs.num_variables() + 1,
-        context.scratch_exponents,
-        context.config);
+    libff::G1<ppT> evaluation_Lt = context.precomputedTables ?
+        prover_precomputed_multi_exp(
+            *context.precomputedTables,
+            context.precomputedTables->L_table,
+            full_variable_assignment.data() + cs.num_inputs + 1,
+            context.scratch_exponents,
+            context.config) :
+        prover_multi_exp(
+            pk.L_query,
+            full_variable_assignment,
+            cs.num_inputs + 1,
+            cs.num_variables - cs.num_inputs,
+            true,
+            context.config.multi_exp_L,
+            context.scratch_exponents,
+            context.config);
     libff::leave_block("Compute evaluation to L-query", false);
 
     /* A = alpha + sum_i(a_i*A_i(t)) */
@@ -549,6 +1070,300 @@ r1cs_gg_ppzksnark_zok_proof<ppT> r1cs_gg_ppzksnark_zok_prover(ProverContext<ppT>
     return proof;
 }
 
+/**
+ * Prover for a key streamed from disk, see `r1cs_gg_ppzksnark_zok_proving_key_stream`.
+ *
+ * Each query is read once for all of the assignments, in chunks sized so
+ * that the two read buffers and the exponents of the chunk stay within
+ * `config.stream_memory_budget`. The partial results of the chunks are
+ * summed as they complete.
+ */
+template <typename ppT>
+std::vector<r1cs_gg_ppzksnark_zok_proof<ppT>> r1cs_gg_ppzksnark_zok_prover_streaming(ProverContext<ppT>& context,
+                                                                                  const r1cs_gg_ppzksnark_zok_proving_key_stream<ppT>& pk,
+                                                                                  const std::vector<const std::vector<libff::Fr<ppT>>*>& full_variable_assignments)
+{
+    typedef libff::G1<ppT> G1;
+    typedef libff::G2<ppT> G2;
+    typedef libff::Fr<ppT> Fr;
+
+    libff::enter_block("Call to r1cs_gg_ppzksnark_zok_prover_streaming");
+
+    const std::shared_ptr<libfqfft::evaluation_domain<Fr>>& domain = context.domain;
+    const r1cs_compact_constraints<Fr>& cs = prover_compact_constraints(context);
+    const Config& config = context.config;
+    const size_t batch_size = full_variable_assignments.size();
+
+    if (pk.count(MAPPED_PK_H_QUERY) != domain->m - 1 || pk.count(MAPPED_PK_L_QUERY) != cs.num_variables - cs.num_inputs)
+    {
+        throw std::runtime_error("Streamed proving key does not match the constraint system");
+    }
+
+    libff::enter_block("Compute the polynomials H");
+    if (context.batch_aH.size() < batch_size)
+    {
+        context.batch_aH.resize(batch_size);
+    }
+    for (size_t i = 0; i < batch_size; i++)
+    {
+        r1cs_to_qap_witness_map_compact(
+            context.domain,
+            cs,
+            *full_variable_assignments[i],
+            context.aA,
+            context.aB,
+            context.batch_aH[i],
+            false,
+            context.config
+        );
+
+        assert(!context.batch_aH[i][domain->m-2].is_zero());
+        assert(context.batch_aH[i][domain->m-1].is_zero());
+        assert(context.batch_aH[i][domain->m].is_zero());
+    }
+    libff::leave_block("Compute the polynomials H");
+
+    // The whole budget goes to one query at a time, the exponents are kept per assignment
+    const size_t budget = std::max<size_t>(config.stream_memory_budget, 1);
+    const size_t exponents_size = batch_size * sizeof(libff::bigint<Fr::num_limbs>);
+    const size_t G1_sparse_chunk = stream_chunk_size(budget, sizeof(G1) + sizeof(size_t), exponents_size);
+    const size_t G2_sparse_chunk = stream_chunk_size(budget, sizeof(G2) + sizeof(size_t), exponents_size);
+    const size_t G1_dense_chunk = stream_chunk_size(budget, sizeof(G1), exponents_size);
+    const size_t num_scalars = cs.num_variables + 1;
+
+    std::vector<const Fr*> full_scalars(batch_size);
+    for (size_t i = 0; i < batch_size; i++)
+    {
+        full_scalars[i] = full_variable_assignments[i]->data();
+    }
+    std::vector<const Fr*> chunk_scalars(batch_size);
+
+    std::vector<G1> evaluation_At(batch_size, G1::zero());
+    std::vector<G2> evaluation_Bt(batch_size, G2::zero());
+    std::vector<G1> evaluation_Ht(batch_size, G1::zero());
+    std::vector<G1> evaluation_Lt(batch_size, G1::zero());
+
+    libff::enter_block("Compute the proofs");
+
+    libff::enter_block("Compute evaluations to A-query", false);
+    pk.template stream_query<G1>(MAPPED_PK_A_VALUES, MAPPED_PK_A_INDICES, G1_sparse_chunk,
+        [&](const G1* values, const size_t* indices, size_t begin, size_t n) {
+            libff::UNUSED(begin);
+            const auto partial = sparse_multi_exp_array_batch<G1, Fr>(values, indices, n, full_scalars, num_scalars, context.batch_scratch_exponents, config);
+            for (size_t i = 0; i < batch_size; i++)
+            {
+                evaluation_At[i] = evaluation_At[i] + partial[i];
+            }
+        });
+    libff::leave_block("Compute evaluations to A-query", false);
+
+    libff::enter_block("Compute evaluations to B-query", false);
+    pk.template stream_query<G2>(MAPPED_PK_B_VALUES, MAPPED_PK_B_INDICES, G2_sparse_chunk,
+        [&](const G2* values, const size_t* indices, size_t begin, size_t n) {
+            libff::UNUSED(begin);
+            const auto partial = sparse_multi_exp_array_batch<G2, Fr>(values, indices, n, full_scalars, num_scalars, context.batch_scratch_exponents, config);
+            for (size_t i = 0; i < batch_size; i++)
+            {
+                evaluation_Bt[i] = evaluation_Bt[i] + partial[i];
+            }
+        });
+    libff::leave_block("Compute evaluations to B-query", false);
+
+    libff::enter_block("Compute evaluations to H-query", false);
+    pk.template stream_query<G1>(MAPPED_PK_H_QUERY, MAPPED_PK_NUM_SECTIONS, G1_dense_chunk,
+        [&](const G1* values, const size_t* indices, size_t begin, size_t n) {
+            libff::UNUSED(indices);
+            for (size_t i = 0; i < batch_size; i++)
+            {
+                chunk_scalars[i] = context.batch_aH[i].data() + begin;
+            }
+            const auto partial = multi_exp_array_batch<G1, Fr>(values, chunk_scalars, n, context.batch_scratch_exponents, config);
+            for (size_t i = 0; i < batch_size; i++)
+            {
+                evaluation_Ht[i] = evaluation_Ht[i] + partial[i];
+            }
+        });
+    libff::leave_block("Compute evaluations to H-query", false);
+
+    libff::enter_block("Compute evaluations to L-query", false);
+    pk.template stream_query<G1>(MAPPED_PK_L_QUERY, MAPPED_PK_NUM_SECTIONS, G1_dense_chunk,
+        [&](const G1* values, const size_t* indices, size_t begin, size_t n) {
+            libff::UNUSED(indices);
+            for (size_t i = 0; i < batch_size; i++)
+            {
+                chunk_scalars[i] = full_scalars[i] + cs.num_inputs + 1 + begin;
+            }
+            const auto partial = multi_exp_array_batch<G1, Fr>(values, chunk_scalars, n, context.batch_scratch_exponents, config);
+            for (size_t i = 0; i < batch_size; i++)
+            {
+                evaluation_Lt[i] = evaluation_Lt[i] + partial[i];
+            }
+        });
+    libff::leave_block("Compute evaluations to L-query", false);
+
+    std::vector<r1cs_gg_ppzksnark_zok_proof<ppT>> proofs;
+    proofs.reserve(batch_size);
+    for (size_t i = 0; i < batch_size; i++)
+    {
+        G1 g1_A = pk.alpha_g1 + evaluation_At[i];
+        G2 g2_B = pk.beta_g2 + evaluation_Bt[i];
+        G1 g1_C = evaluation_Ht[i] + evaluation_Lt[i];
+        proofs.emplace_back(std::move(g1_A), std::move(g2_B), std::move(g1_C));
+    }
+
+    libff::leave_block("Compute the proofs");
+
+    libff::leave_block("Call to r1cs_gg_ppzksnark_zok_prover_streaming");
+
+    return proofs;
+}
+
+template <typename ppT>
+r1cs_gg_ppzksnark_zok_proof<ppT> r1cs_gg_ppzksnark_zok_prover(ProverContext<ppT>& context, const std::vector<libff::Fr<ppT>>& full_variable_assignment)
+{
+    if (context.streamKey != nullptr)
+    {
+        return r1cs_gg_ppzksnark_zok_prover_streaming<ppT>(context, *context.streamKey, {&full_variable_assignment})[0];
+    }
+    if (context.mappedKey != nullptr)
+    {
+        return r1cs_gg_ppzksnark_zok_prover<ppT>(context, *context.mappedKey, full_variable_assignment);
+    }
+    return r1cs_gg_ppzksnark_zok_prover<ppT>(context, *context.provingKey, full_variable_assignment);
+}
+
+template <typename ppT, typename ProvingKeyT>
+std::vector<r1cs_gg_ppzksnark_zok_proof<ppT>> r1cs_gg_ppzksnark_zok_prover_batch(ProverContext<ppT>& context, const ProvingKeyT& pk, const std::vector<std::vector<libff::Fr<ppT>>>& full_variable_assignments)
+{
+    libff::enter_block("Call to r1cs_gg_ppzksnark_zok_prover_batch");
+
+    const std::shared_ptr<libfqfft::evaluation_domain<libff::Fr<ppT>>>& domain = context.domain;
+    const r1cs_compact_constraints<libff::Fr<ppT>>& cs = prover_compact_constraints(context);
+    const size_t batch_size = full_variable_assignments.size();
+
+    libff::enter_block("Compute the polynomials H");
+    if (context.batch_aH.size() < batch_size)
+    {
+        context.batch_aH.resize(batch_size);
+    }
+    for (size_t i = 0; i < batch_size; i++)
+    {
+        r1cs_to_qap_witness_map_compact(
+            context.domain,
+            cs,
+            full_variable_assignments[i],
+            context.aA,
+            context.aB,
+            context.batch_aH[i],
+            false,
+            context.config
+        );
+
+        assert(!context.batch_aH[i][domain->m-2].is_zero());
+        assert(context.batch_aH[i][domain->m-1].is_zero());
+        assert(context.batch_aH[i][domain->m].is_zero());
+    }
+    libff::leave_block("Compute the polynomials H");
+
+#ifdef DEBUG
+    for (const auto& assignment : full_variable_assignments)
+    {
+        assert(assignment.size() == cs.num_variables + 1);
+    }
+    assert(pk.A_query.domain_size() == cs.num_variables+1);
+    assert(pk.B_query.domain_size() == cs.num_variables+1);
+    assert(pk.H_query.size() == domain->m - 1);
+    assert(pk.L_query.size() == cs.num_variables - cs.num_inputs);
+#endif
+
+    std::vector<const libff::Fr<ppT>*> full_scalars(batch_size);
+    std::vector<const libff::Fr<ppT>*> H_scalars(batch_size);
+    std::vector<const libff::Fr<ppT>*> L_scalars(batch_size);
+    for (size_t i = 0; i < batch_size; i++)
+    {
+        full_scalars[i] = full_variable_assignments[i].data();
+        H_scalars[i] = context.batch_aH[i].data();
+        L_scalars[i] = full_variable_assignments[i].data() + cs.num_inputs + 1;
+    }
+
+    libff::enter_block("Compute the proofs");
+
+    libff::enter_block("Compute evaluations to A-query", false);
+    const std::vector<libff::G1<ppT>> evaluation_At = sparse_multi_exp_array_batch<libff::G1<ppT>, libff::Fr<ppT>>(
+        pk.A_query.values.data(),
+        pk.A_query.indices.data(),
+        pk.A_query.size(),
+        full_scalars,
+        cs.num_variables + 1,
+        context.batch_scratch_exponents,
+        context.config);
+    libff::leave_block("Compute evaluations to A-query", false);
+
+    libff::enter_block("Compute evaluations to B-query", false);
+    const std::vector<libff::G2<ppT>> evaluation_Bt = sparse_multi_exp_array_batch<libff::G2<ppT>, libff::Fr<ppT>>(
+        pk.B_query.values.data(),
+        pk.B_query.indices.data(),
+        pk.B_query.size(),
+        full_scalars,
+        cs.num_variables + 1,
+        context.batch_scratch_exponents,
+        context.config);
+    libff::leave_block("Compute evaluations to B-query", false);
+
+    libff::enter_block("Compute evaluations to H-query", false);
+    const std::vector<libff::G1<ppT>> evaluation_Ht = multi_exp_array_batch<libff::G1<ppT>, libff::Fr<ppT>>(
+        pk.H_query.data(),
+        H_scalars,
+        domain->m - 1,
+        context.batch_scratch_exponents,
+        context.config);
+    libff::leave_block("Compute evaluations to H-query", false);
+
+    libff::enter_block("Compute evaluations to L-query", false);
+    const std::vector<libff::G1<ppT>> evaluation_Lt = multi_exp_array_batch<libff::G1<ppT>, libff::Fr<ppT>>(
+        pk.L_query.data(),
+        L_scalars,
+        cs.num_variables - cs.num_inputs,
+        context.batch_scratch_exponents,
+        context.config);
+    libff::leave_block("Compute evaluations to L-query", false);
+
+    std::vector<r1cs_gg_ppzksnark_zok_proof<ppT>> proofs;
+    proofs.reserve(batch_size);
+    for (size_t i = 0; i < batch_size; i++)
+    {
+        libff::G1<ppT> g1_A = pk.alpha_g1 + evaluation_At[i];
+        libff::G2<ppT> g2_B = pk.beta_g2 + evaluation_Bt[i];
+        libff::G1<ppT> g1_C = evaluation_Ht[i] + evaluation_Lt[i];
+        proofs.emplace_back(std::move(g1_A), std::move(g2_B), std::move(g1_C));
+    }
+
+    libff::leave_block("Compute the proofs");
+
+    libff::leave_block("Call to r1cs_gg_ppzksnark_zok_prover_batch");
+
+    return proofs;
+}
+
+template <typename ppT>
+std::vector<r1cs_gg_ppzksnark_zok_proof<ppT>> r1cs_gg_ppzksnark_zok_prover_batch(ProverContext<ppT>& context, const std::vector<std::vector<libff::Fr<ppT>>>& full_variable_assignments)
+{
+    if (context.streamKey != nullptr)
+    {
+        std::vector<const std::vector<libff::Fr<ppT>>*> assignments;
+        for (const auto& assignment : full_variable_assignments)
+        {
+            assignments.emplace_back(&assignment);
+        }
+        return r1cs_gg_ppzksnark_zok_prover_streaming<ppT>(context, *context.streamKey, assignments);
+    }
+    if (context.mappedKey != nullptr)
+    {
+        return r1cs_gg_ppzksnark_zok_prover_batch<ppT>(context, *context.mappedKey, full_variable_assignments);
+    }
+    return r1cs_gg_ppzksnark_zok_prover_batch<ppT>(context, *context.provingKey, full_variable_assignments);
+}
+
 template <typename ppT>
 r1cs_gg_ppzksnark_zok_processed_verification_key<ppT> r1cs_gg_ppzksnark_zok_verifier_process_vk(const r1cs_gg_ppzksnark_zok_verification_key<ppT> &vk)
 {
@@ -557,6 +1372,7 @@ r1cs_gg_ppzksnark_zok_processed_verification_key<ppT> r1cs_gg_ppzksnark_zok_veri
     r1cs_gg_ppzksnark_zok_processed_verification_key<ppT> pvk;
     pvk.vk_alpha_g1 = vk.alpha_g1;
     pvk.vk_beta_g2 = vk.beta_g2;
+    pvk.vk_alpha_g1_beta_g2 = ppT::reduced_pairing(vk.alpha_g1, vk.beta_g2);
     pvk.vk_gamma_g2_precomp = ppT::precompute_G2(vk.gamma_g2);
     pvk.vk_delta_g2_precomp = ppT::precompute_G2(vk.delta_g2);
     pvk.gamma_ABC_g1 = vk.gamma_ABC_g1;
@@ -566,6 +1382,87 @@ r1cs_gg_ppzksnark_zok_processed_verification_key<ppT> r1cs_gg_ppzksnark_zok_veri
     return pvk;
 }
 
+template <typename ppT>
+void r1cs_gg_ppzksnark_zok_verifier_precompute_input_tables(r1cs_gg_ppzksnark_zok_processed_verification_key<ppT> &pvk,
+                                                            size_t table_expansion)
+{
+    pvk.gamma_ABC_g1_table.clear();
+    pvk.table_window_bits = 0;
+    pvk.table_expansion = 0;
+    pvk.table_round_windows = 0;
+
+    // The tables are indexed by input, so every input needs its base
+    const auto& rest = pvk.gamma_ABC_g1.rest;
+    const size_t count = rest.values.size();
+    bool dense = count >= VERIFIER_INPUT_TABLE_MIN_INPUTS && count == rest.domain_size();
+    for (size_t i = 0; dense && i < count; i++)
+    {
+        dense = (rest.indices[i] == i);
+    }
+    if (!dense)
+    {
+        return;
+    }
+
+    libff::enter_block("Precompute input tables");
+    const Config config;
+    const size_t window_bits = multi_exp_window_size(count, config);
+    const size_t num_windows = multi_exp_num_signed_windows(libff::Fr<ppT>::size_in_bits(), window_bits);
+    const size_t expansion = (table_expansion == 0) ? num_windows : std::min(table_expansion, num_windows);
+    const size_t round_windows = (num_windows + expansion - 1) / expansion;
+
+    pvk.table_window_bits = window_bits;
+    pvk.table_expansion = expansion;
+    pvk.table_round_windows = round_windows;
+    pvk.gamma_ABC_g1_table.reserve(expansion * count);
+
+    std::vector<libff::G1<ppT>> multiples(rest.values);
+    for (size_t k = 0; k < expansion; k++)
+    {
+        if (k > 0)
+        {
+            for (auto& multiple : multiples)
+            {
+                for (size_t d = 0; d < round_windows * window_bits; d++)
+                {
+                    multiple = multiple.dbl();
+                }
+            }
+        }
+
+        // In special form so the buckets can use mixed or batched affine additions
+        libff::batch_to_special(multiples);
+        pvk.gamma_ABC_g1_table.insert(pvk.gamma_ABC_g1_table.end(), multiples.begin(), multiples.end());
+    }
+    libff::leave_block("Precompute input tables");
+}
+
+template <typename ppT>
+libff::G1<ppT> r1cs_gg_ppzksnark_zok_accumulate_input(const r1cs_gg_ppzksnark_zok_processed_verification_key<ppT> &pvk,
+                                                      const r1cs_gg_ppzksnark_zok_primary_input<ppT> &primary_input)
+{
+    typedef libff::Fr<ppT> FieldT;
+
+    if (pvk.gamma_ABC_g1_table.empty())
+    {
+        return pvk.gamma_ABC_g1.template accumulate_chunk<FieldT>(primary_input.begin(), primary_input.end(), 0).first;
+    }
+
+    const size_t count = pvk.gamma_ABC_g1_table.size() / pvk.table_expansion;
+    assert(primary_input.size() <= count);
+
+    std::vector<libff::bigint<FieldT::num_limbs>> exponents(primary_input.size());
+    for (size_t i = 0; i < primary_input.size(); i++)
+    {
+        exponents[i] = primary_input[i].as_bigint();
+    }
+
+    return pvk.gamma_ABC_g1.first + multi_exp_precomputed_buckets(pvk.gamma_ABC_g1_table.data(), count,
+                                                                  pvk.table_expansion, pvk.table_round_windows, pvk.table_window_bits,
+                                                                  exponents.data(), 0, primary_input.size(),
+                                                                  FieldT::size_in_bits(), Config());
+}
+
 template <typename ppT>
 bool r1cs_gg_ppzksnark_zok_online_verifier_weak_IC(const r1cs_gg_ppzksnark_zok_processed_verification_key<ppT> &pvk,
                                                const r1cs_gg_ppzksnark_zok_primary_input<ppT> &primary_input,
@@ -575,8 +1472,7 @@ bool r1cs_gg_ppzksnark_zok_online_verifier_weak_IC(const r1cs_gg_ppzksnark_zok_p
     assert(pvk.gamma_ABC_g1.domain_size() >= primary_input.size());
 
     libff::enter_block("Accumulate input");
-    const accumulation_vector<libff::G1<ppT> > accumulated_IC = pvk.gamma_ABC_g1.template accumulate_chunk<libff::Fr<ppT> >(primary_input.begin(), primary_input.end(), 0);
-    const libff::G1<ppT> &acc = accumulated_IC.first;
+    const libff::G1<ppT> acc = r1cs_gg_ppzksnark_zok_accumulate_input<ppT>(pvk, primary_input);
     libff::leave_block("Accumulate input");
 
     bool result = true;
@@ -605,9 +1501,7 @@ bool r1cs_gg_ppzksnark_zok_online_verifier_weak_IC(const r1cs_gg_ppzksnark_zok_p
         proof_g_C_precomp, pvk.vk_delta_g2_precomp);
     const libff::GT<ppT> QAP = ppT::final_exponentiation(QAP1 * QAP2.unitary_inverse());
 
-    libff::GT<ppT> vk_alpha_g1_beta_g2 = ppT::reduced_pairing(pvk.vk_alpha_g1, pvk.vk_beta_g2);
-
-    if (QAP != vk_alpha_g1_beta_g2)
+    if (QAP != pvk.vk_alpha_g1_beta_g2)
     {
         if (!libff::inhibit_profiling_info)
         {
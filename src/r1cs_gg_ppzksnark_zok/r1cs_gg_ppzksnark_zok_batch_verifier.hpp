@@ -0,0 +1,50 @@
+#ifndef ETHSNARKS_R1CS_GG_PPZKSNARK_ZOK_BATCH_VERIFIER_HPP_
+#define ETHSNARKS_R1CS_GG_PPZKSNARK_ZOK_BATCH_VERIFIER_HPP_
+
+#include <vector>
+
+#include "prover_config.hpp"
+#include "r1cs_gg_ppzksnark_zok/r1cs_gg_ppzksnark_zok.hpp"
+
+namespace libsnark {
+
+/**
+* Verify many proofs for the same verification key at once, with strong
+* input consistency, returning whether each proof is valid.
+*
+* Each proof must satisfy e(A, B) = e(alpha, beta) e(acc, gamma) e(C, delta),
+* where acc is the accumulated input. With random scalars r_i the checks are
+* combined into one:
+*
+*   prod_i e(r_i A_i, B_i) = e(sum_i r_i alpha, beta) e(sum_i r_i acc_i, gamma) e(sum_i r_i C_i, delta)
+*
+* which costs one Miller loop per proof, two more for the whole batch and
+* a single final exponentiation, instead of three Miller loops and one final
+* exponentiation per proof. The first pairing on the right is the processed
+* key's e(alpha, beta) raised to sum_i r_i. An invalid proof makes the combined check
+* fail except with negligible probability, the batch is then split in halves
+* which are checked again (with new scalars) to find the invalid proofs.
+*
+* The Miller loops and scalar multiplications are shared between
+* `config.num_threads` threads.
+*/
+template<typename ppT>
+std::vector<bool> r1cs_gg_ppzksnark_zok_batch_verifier_strong_IC(const r1cs_gg_ppzksnark_zok_processed_verification_key<ppT> &pvk,
+                                                                 const std::vector<r1cs_gg_ppzksnark_zok_primary_input<ppT>> &primary_inputs,
+                                                                 const std::vector<r1cs_gg_ppzksnark_zok_proof<ppT>> &proofs,
+                                                                 const Config& config);
+
+/**
+* As above, processing the verification key first
+*/
+template<typename ppT>
+std::vector<bool> r1cs_gg_ppzksnark_zok_batch_verifier_strong_IC(const r1cs_gg_ppzksnark_zok_verification_key<ppT> &vk,
+                                                                 const std::vector<r1cs_gg_ppzksnark_zok_primary_input<ppT>> &primary_inputs,
+                                                                 const std::vector<r1cs_gg_ppzksnark_zok_proof<ppT>> &proofs,
+                                                                 const Config& config);
+
+} // libsnark
+
+#include "r1cs_gg_ppzksnark_zok/r1cs_gg_ppzksnark_zok_batch_verifier.tcc"
+
+#endif
@@ -0,0 +1,185 @@
+#ifndef ETHSNARKS_R1CS_GG_PPZKSNARK_ZOK_BATCH_VERIFIER_TCC_
+#define ETHSNARKS_R1CS_GG_PPZKSNARK_ZOK_BATCH_VERIFIER_TCC_
+
+#include <algorithm>
+#include <cstdio>
+#include <stdexcept>
+#include <vector>
+
+#include <libff/common/profiling.hpp>
+#include <libff/common/utils.hpp>
+
+#ifdef MULTICORE
+#include <omp.h>
+#endif
+
+namespace libsnark {
+
+
+/**
+* The combined check of the proofs `batch`, see the header. The proofs must
+* be well formed and have the right number of inputs.
+*/
+template<typename ppT>
+bool batch_verifier_check(const r1cs_gg_ppzksnark_zok_processed_verification_key<ppT> &pvk,
+                          const std::vector<r1cs_gg_ppzksnark_zok_primary_input<ppT>> &primary_inputs,
+                          const std::vector<r1cs_gg_ppzksnark_zok_proof<ppT>> &proofs,
+                          const std::vector<size_t> &batch,
+                          const Config& config)
+{
+    typedef libff::Fr<ppT> FieldT;
+
+    const size_t n = batch.size();
+    const size_t num_inputs = pvk.gamma_ABC_g1.domain_size();
+
+    std::vector<FieldT> r(n);
+    for (auto& x : r)
+    {
+        x = FieldT::random_element();
+    }
+
+    // The inputs only contribute through acc, so they are combined before
+    // any group operation: sum_i r_i acc_i is the accumulation of sum_i r_i x_i
+    FieldT r_sum = FieldT::zero();
+    std::vector<FieldT> combined_input(num_inputs, FieldT::zero());
+    for (size_t k = 0; k < n; k++)
+    {
+        r_sum += r[k];
+        const auto& input = primary_inputs[batch[k]];
+        for (size_t j = 0; j < num_inputs; j++)
+        {
+            combined_input[j] += r[k] * input[j];
+        }
+    }
+
+    // Each thread multiplies its Miller loops and sums its r_i C_i separately
+    size_t num_threads = 1;
+#ifdef MULTICORE
+    num_threads = std::max<size_t>(config.num_threads, 1);
+#endif
+    libff::UNUSED(config);
+    std::vector<libff::Fqk<ppT>> thread_miller(num_threads, libff::Fqk<ppT>::one());
+    std::vector<libff::G1<ppT>> thread_C(num_threads, libff::G1<ppT>::zero());
+
+#ifdef MULTICORE
+    #pragma omp parallel for schedule(dynamic) num_threads(num_threads)
+#endif
+    for (size_t k = 0; k < n; k++)
+    {
+        size_t thread = 0;
+#ifdef MULTICORE
+        thread = omp_get_thread_num();
+#endif
+        const auto& proof = proofs[batch[k]];
+        const libff::G1_precomp<ppT> rA_precomp = ppT::precompute_G1(r[k] * proof.g_A);
+        const libff::G2_precomp<ppT> B_precomp = ppT::precompute_G2(proof.g_B);
+        thread_miller[thread] = thread_miller[thread] * ppT::miller_loop(rA_precomp, B_precomp);
+        thread_C[thread] = thread_C[thread] + (r[k] * proof.g_C);
+    }
+
+    libff::Fqk<ppT> lhs = libff::Fqk<ppT>::one();
+    libff::G1<ppT> C_sum = libff::G1<ppT>::zero();
+    for (size_t t = 0; t < num_threads; t++)
+    {
+        lhs = lhs * thread_miller[t];
+        C_sum = C_sum + thread_C[t];
+    }
+
+    // The accumulation adds gamma_ABC_g1.first once, it is needed sum_i r_i times
+    const libff::G1<ppT> acc = r1cs_gg_ppzksnark_zok_accumulate_input<ppT>(pvk, combined_input)
+                             + ((r_sum - FieldT::one()) * pvk.gamma_ABC_g1.first);
+
+    const libff::Fqk<ppT> rhs = ppT::double_miller_loop(ppT::precompute_G1(acc), pvk.vk_gamma_g2_precomp,
+                                                        ppT::precompute_G1(C_sum), pvk.vk_delta_g2_precomp);
+
+    // e(sum_i r_i alpha, beta) is the precomputed e(alpha, beta) raised to sum_i r_i
+    return ppT::final_exponentiation(lhs * rhs.unitary_inverse()) == (pvk.vk_alpha_g1_beta_g2 ^ r_sum.as_bigint());
+}
+
+
+/**
+* Check `batch` as a whole, if that fails check each half of it, and so on
+* until the invalid proofs are found
+*/
+template<typename ppT>
+void batch_verifier_bisect(const r1cs_gg_ppzksnark_zok_processed_verification_key<ppT> &pvk,
+                            const std::vector<r1cs_gg_ppzksnark_zok_primary_input<ppT>> &primary_inputs,
+                           const std::vector<r1cs_gg_ppzksnark_zok_proof<ppT>> &proofs,
+                           const std::vector<size_t> &batch,
+                           std::vector<bool> &result,
+                           const Config& config)
+{
+    if (batch.empty())
+    {
+        return;
+    }
+
+    if (batch_verifier_check(pvk, primary_inputs, proofs, batch, config))
+    {
+        for (const auto i : batch)
+        {
+            result[i] = true;
+        }
+        return;
+    }
+
+    if (batch.size() == 1)
+    {
+        result[batch[0]] = false;
+        return;
+    }
+
+    const auto middle = batch.begin() + (batch.size() / 2);
+    batch_verifier_bisect(pvk, primary_inputs, proofs, std::vector<size_t>(batch.begin(), middle), result, config);
+    batch_verifier_bisect(pvk, primary_inputs, proofs, std::vector<size_t>(middle, batch.end()), result, config);
+}
+
+
+template<typename ppT>
+std::vector<bool> r1cs_gg_ppzksnark_zok_batch_verifier_strong_IC(const r1cs_gg_ppzksnark_zok_processed_verification_key<ppT> &pvk,
+                                                                 const std::vector<r1cs_gg_ppzksnark_zok_primary_input<ppT>> &primary_inputs,
+                                                                 const std::vector<r1cs_gg_ppzksnark_zok_proof<ppT>> &proofs,
+                                                                 const Config& config)
+{
+    libff::enter_block("Call to r1cs_gg_ppzksnark_zok_batch_verifier_strong_IC");
+
+    if (primary_inputs.size() != proofs.size())
+    {
+        throw std::invalid_argument("Batch verifier: number of inputs and proofs differ");
+    }
+
+    std::vector<bool> result(proofs.size(), false);
+
+    // Proofs which fail the cheap checks are rejected without joining the batch
+    std::vector<size_t> batch;
+    batch.reserve(proofs.size());
+    for (size_t i = 0; i < proofs.size(); i++)
+    {
+        if (primary_inputs[i].size() == pvk.gamma_ABC_g1.domain_size() && proofs[i].is_well_formed())
+        {
+            batch.emplace_back(i);
+        }
+    }
+
+    libff::print_indent(); printf("* Proofs in batch: %zu of %zu\n", batch.size(), proofs.size());
+
+    batch_verifier_bisect(pvk, primary_inputs, proofs, batch, result, config);
+
+    libff::leave_block("Call to r1cs_gg_ppzksnark_zok_batch_verifier_strong_IC");
+
+    return result;
+}
+
+
+template<typename ppT>
+std::vector<bool> r1cs_gg_ppzksnark_zok_batch_verifier_strong_IC(const r1cs_gg_ppzksnark_zok_verification_key<ppT> &vk,
+                                                                 const std::vector<r1cs_gg_ppzksnark_zok_primary_input<ppT>> &primary_inputs,
+                                                                 const std::vector<r1cs_gg_ppzksnark_zok_proof<ppT>> &proofs,
+                                                                 const Config& config)
+{
+    return r1cs_gg_ppzksnark_zok_batch_verifier_strong_IC<ppT>(r1cs_gg_ppzksnark_zok_verifier_process_vk<ppT>(vk), primary_inputs, proofs, config);
+}
+
+} // libsnark
+
+#endif
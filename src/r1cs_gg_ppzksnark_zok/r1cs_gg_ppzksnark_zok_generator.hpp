@@ -0,0 +1,90 @@
+#ifndef ETHSNARKS_R1CS_GG_PPZKSNARK_ZOK_GENERATOR_HPP_
+#define ETHSNARKS_R1CS_GG_PPZKSNARK_ZOK_GENERATOR_HPP_
+
+#include <string>
+
+#include "prover_config.hpp"
+#include "r1cs_gg_ppzksnark_zok/r1cs_gg_ppzksnark_zok.hpp"
+
+namespace libsnark {
+
+/**
+* Default memory budget of the mapped generator when `config.stream_memory_budget`
+* is 0, in bytes
+*/
+static const size_t GENERATOR_MAPPED_DEFAULT_BUDGET = size_t(1) << 30;
+
+
+/**
+* A generator which writes the proving key directly to `pk_path` in the
+* mapped format (see r1cs_gg_ppzksnark_zok_mmap.hpp), returning the
+* verification key.
+*
+* Produces the same kind of key as `r1cs_gg_ppzksnark_zok_generator`
+* followed by `write_proving_key_mapped`, but never holds the queries in
+* memory: each query is exponentiated in chunks, in parallel, and every
+* chunk is written out while the next one is computed. The window tables
+* and chunk buffers are kept within `config.stream_memory_budget` bytes,
+* the QAP evaluated at t is still held in memory (three field elements per
+* variable).
+*
+* The QAP evaluation is parallel too: the Lagrange polynomials are
+* evaluated in blocks with batched inversions, and the A, B and C
+* polynomials are accumulated per variable from the constraint system in
+* compact form.
+*
+* Throws `std::runtime_error` if the key cannot be written.
+*/
+template<typename ppT>
+r1cs_gg_ppzksnark_zok_verification_key<ppT> r1cs_gg_ppzksnark_zok_generator_mapped(const r1cs_gg_ppzksnark_zok_constraint_system<ppT> &cs,
+                                                                                   const std::string& pk_path,
+                                                                                   const Config& config);
+
+/**
+* The mapped generator for a constraint system in compact form, e.g. loaded
+* with `R1CSBinaryFile::load_compact`, so the constraint objects are never
+* built.
+*/
+template<typename ppT>
+r1cs_gg_ppzksnark_zok_verification_key<ppT> r1cs_gg_ppzksnark_zok_generator_mapped(const r1cs_compact_constraints<libff::Fr<ppT>> &cs,
+                                                                                   const std::string& pk_path,
+                                                                                   const Config& config);
+
+/**
+* The in-memory generator for a constraint system in compact form, producing
+* the same keys as `r1cs_gg_ppzksnark_zok_generator` with these secrets
+*/
+template<typename ppT>
+r1cs_gg_ppzksnark_zok_keypair<ppT> r1cs_gg_ppzksnark_zok_generator(const r1cs_compact_constraints<libff::Fr<ppT>> &cs,
+                                                               const r1cs_gg_ppzksnark_zok_toxic_waste<ppT> &secrets,
+                                                               const Config& config);
+
+
+/**
+* Regenerate the keys for a modified constraint system from the secrets and
+* the constraint system of a previous key, returning the verification key
+* and writing the proving key to `pk`.
+*
+* Only the query entries whose exponents changed are recomputed, i.e. the A,
+* B and L entries of variables whose QAP columns differ between the two
+* constraint systems; the rest are copied from `previous_pk`. The H query is
+* reused whole while the domain size stays the same. This is meant for
+* iterating on large circuits in trusted development setups, the secrets
+* must never be kept for keys used in production.
+*
+* Throws `std::runtime_error` if `previous_pk` was not generated from
+* `previous_cs` with these secrets.
+*/
+template<typename ppT>
+r1cs_gg_ppzksnark_zok_verification_key<ppT> r1cs_gg_ppzksnark_zok_generator_incremental(const r1cs_gg_ppzksnark_zok_constraint_system<ppT> &previous_cs,
+                                                                                        const r1cs_gg_ppzksnark_zok_proving_key_nozk<ppT> &previous_pk,
+                                                                                        const r1cs_gg_ppzksnark_zok_constraint_system<ppT> &cs,
+                                                                                        const r1cs_gg_ppzksnark_zok_toxic_waste<ppT> &secrets,
+                                                                                        r1cs_gg_ppzksnark_zok_proving_key_nozk<ppT> &pk,
+                                                                                        const Config& config);
+
+} // libsnark
+
+#include "r1cs_gg_ppzksnark_zok/r1cs_gg_ppzksnark_zok_generator.tcc"
+
+#endif
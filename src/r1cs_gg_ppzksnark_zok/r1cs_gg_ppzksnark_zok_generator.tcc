@@ -0,0 +1,681 @@
+#ifndef ETHSNARKS_R1CS_GG_PPZKSNARK_ZOK_GENERATOR_TCC_
+#define ETHSNARKS_R1CS_GG_PPZKSNARK_ZOK_GENERATOR_TCC_
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <future>
+#include <stdexcept>
+#include <vector>
+
+#include <libff/algebra/fields/field_utils.hpp>
+#include <libff/algebra/scalar_multiplication/multiexp.hpp>
+#include <libff/common/profiling.hpp>
+#include <libff/common/utils.hpp>
+
+namespace libsnark {
+
+
+/**
+* Evaluate the Lagrange polynomials of the domain of size `m` generated by
+* `omega` at t, L_i(t) = Z(t)/m * omega^i / (t - omega^i)
+*/
+template<typename FieldT>
+std::vector<FieldT> generator_mapped_lagrange(size_t m, const FieldT& omega, const FieldT& t, const Config& config)
+{
+    const FieldT Zt = (t ^ m) - FieldT::one();
+    const FieldT Zt_over_m = Zt * FieldT(m).inverse();
+
+    std::vector<FieldT> u(m);
+    witness_map_for_blocks(m, 4096, false, config, [&](size_t begin, size_t end) {
+        std::vector<FieldT> denominators;
+        denominators.reserve(end - begin);
+
+        const FieldT first = omega ^ begin;
+        FieldT r = first;
+        for (size_t i = begin; i < end; i++)
+        {
+            denominators.emplace_back(t - r);
+            r *= omega;
+        }
+
+        if (Zt.is_zero())
+        {
+            // t is in the domain, every polynomial is 0 except the one for t itself
+            for (size_t i = begin; i < end; i++)
+            {
+                u[i] = denominators[i - begin].is_zero() ? FieldT::one() : FieldT::zero();
+            }
+            return;
+        }
+
+        libff::batch_invert(denominators);
+        FieldT l = Zt_over_m * first;
+        for (size_t i = begin; i < end; i++)
+        {
+            u[i] = l * denominators[i - begin];
+            l *= omega;
+        }
+    });
+    return u;
+}
+
+
+/**
+* Evaluate the polynomial of each variable of one of the A, B or C matrices
+* at t, given the Lagrange polynomials `u` at t.
+*
+* The terms are sorted by variable first, only moving integers, so each
+* variable is summed by a single thread without any locking.
+*/
+template<typename FieldT>
+std::vector<FieldT> generator_mapped_columns(const r1cs_compact_constraints<FieldT>& cs, const r1cs_compact_matrix<FieldT>& matrix,
+                                             size_t num_columns, const std::vector<FieldT>& u, const Config& config)
+{
+    const size_t num_rows = matrix.row_offsets.size() - 1;
+    const size_t num_terms = matrix.indices.size();
+
+    std::vector<size_t> column_offsets(num_columns + 1, 0);
+    for (size_t k = 0; k < num_terms; k++)
+    {
+        column_offsets[matrix.indices[k] + 1]++;
+    }
+    for (size_t i = 0; i < num_columns; i++)
+    {
+        column_offsets[i + 1] += column_offsets[i];
+    }
+
+    std::vector<size_t> terms(num_terms);       // position of the term in the row major arrays
+    std::vector<uint32_t> rows(num_terms);
+    std::vector<size_t> cursor(column_offsets.begin(), column_offsets.end() - 1);
+    for (size_t row = 0; row < num_rows; row++)
+    {
+        for (size_t k = matrix.row_offsets[row]; k < matrix.row_offsets[row + 1]; k++)
+        {
+            const size_t position = cursor[matrix.indices[k]]++;
+            terms[position] = k;
+            rows[position] = row;
+        }
+    }
+
+    std::vector<FieldT> result(num_columns);
+    witness_map_for_blocks(num_columns, 4096, false, config, [&](size_t begin, size_t end) {
+        for (size_t column = begin; column < end; column++)
+        {
+            FieldT sum = FieldT::zero();
+            for (size_t p = column_offsets[column]; p < column_offsets[column + 1]; p++)
+            {
+                sum += cs.coeff(matrix, terms[p]) * u[rows[p]];
+            }
+            result[column] = sum;
+        }
+    });
+    return result;
+}
+
+
+/**
+* The QAP of a constraint system evaluated at t, over the same domain as the
+* prover: A_i(t), B_i(t) and C_i(t) for every variable, and Z(t)
+*/
+template<typename FieldT>
+struct qap_compact_evaluation
+{
+    size_t m;
+    FieldT Zt;
+    std::vector<FieldT> At;
+    std::vector<FieldT> Bt;
+    std::vector<FieldT> Ct;
+};
+
+
+template<typename FieldT>
+qap_compact_evaluation<FieldT> generator_qap_evaluation(const r1cs_compact_constraints<FieldT>& cs, const FieldT& t, const Config& config)
+{
+    libff::enter_block("Compute evaluation of the QAP at t");
+
+    if (cs.num_constraints >= UINT32_MAX)
+    {
+        throw std::runtime_error("Constraint system too large for the compact layout");
+    }
+
+    qap_compact_evaluation<FieldT> result;
+    result.m = libff::get_power_of_two(cs.num_constraints + cs.num_inputs + 1);
+    result.Zt = (t ^ result.m) - FieldT::one();
+
+    libff::print_indent(); printf("* QAP number of variables: %zu\n", cs.num_variables);
+    libff::print_indent(); printf("* QAP pre degree: %zu\n", cs.num_constraints);
+    libff::print_indent(); printf("* QAP degree: %zu\n", result.m);
+    libff::print_indent(); printf("* QAP number of input variables: %zu\n", cs.num_inputs);
+
+    const std::vector<FieldT> u = generator_mapped_lagrange(result.m, libff::get_root_of_unity<FieldT>(result.m), t, config);
+    result.At = generator_mapped_columns(cs, cs.A, cs.num_variables + 1, u, config);
+    result.Bt = generator_mapped_columns(cs, cs.B, cs.num_variables + 1, u, config);
+    result.Ct = generator_mapped_columns(cs, cs.C, cs.num_variables + 1, u, config);
+
+    /* account for the additional constraints input_i * 0 = 0 */
+    for (size_t i = 0; i <= cs.num_inputs; i++)
+    {
+        result.At[i] += u[cs.num_constraints + i];
+    }
+
+    libff::leave_block("Compute evaluation of the QAP at t");
+    return result;
+}
+
+
+template<typename FieldT>
+qap_compact_evaluation<FieldT> generator_qap_evaluation(const r1cs_constraint_system<FieldT>& r1cs, const FieldT& t, const Config& config)
+{
+    // The compact form is only needed while the QAP is evaluated
+    r1cs_compact_constraints<FieldT> cs;
+    cs.build(r1cs, config);
+    return generator_qap_evaluation(cs, t, config);
+}
+
+
+/**
+* Largest window size no larger than libff's choice for `num_scalars` whose
+* table fits in `memory_budget` bytes
+*/
+template<typename T>
+size_t generator_mapped_window_size(size_t num_scalars, size_t scalar_size, size_t memory_budget)
+{
+    size_t window = libff::get_exp_window_size<T>(num_scalars);
+    while (window > 1 && ((scalar_size + window - 1) / window) * (size_t(1) << window) * sizeof(T) > memory_budget)
+    {
+        window--;
+    }
+    return window;
+}
+
+
+/**
+* Exponentiate and write the section `id` in chunks of `chunk_size` elements.
+*
+* `fill(scalars, first, count)` computes the exponents of elements
+* [first, first+count), it is called for independent blocks from several
+* threads. While one chunk is exponentiated the previous one is converted to
+* special form and written out.
+*/
+template<typename T, typename FieldT, typename Fn>
+void generator_mapped_write_query(std::ostream& out, const mapped_pk_header& header, mapped_pk_section_id id,
+                                  const libff::window_table<T>& table, size_t window, size_t chunk_size,
+                                  Fn fill, const Config& config)
+{
+    const size_t total = header.sections[id].count;
+    const size_t scalar_size = FieldT::size_in_bits();
+    chunk_size = std::min(std::max<size_t>(chunk_size, 1), std::max<size_t>(total, 1));
+
+    std::vector<FieldT> scalars(chunk_size);
+    std::vector<T> buffers[2];
+    std::future<void> pending;
+    size_t current = 0;
+    for (size_t begin = 0; begin < total; begin += chunk_size, current ^= 1)
+    {
+        const size_t n = std::min(chunk_size, total - begin);
+        std::vector<T>& values = buffers[current];
+        values.resize(n);
+
+        witness_map_for_blocks(n, 1024, false, config, [&](size_t b, size_t e) {
+            fill(&scalars[b], begin + b, e - b);
+            for (size_t i = b; i < e; i++)
+            {
+                values[i] = libff::windowed_exp<T, FieldT>(scalar_size, window, table, scalars[i]);
+            }
+        });
+
+        if (pending.valid())
+        {
+            pending.get();
+        }
+        std::vector<T>* written = &values;
+        pending = std::async(std::launch::async, [&out, &header, written, id, begin]() {
+#ifdef USE_MIXED_ADDITION
+            libff::batch_to_special<T>(*written);
+#endif
+            mapped_pk_write_section(out, header, id, written->data(), begin, written->size());
+        });
+    }
+
+    if (pending.valid())
+    {
+        pending.get();
+    }
+}
+
+
+/**
+* The mapped generator for a constraint system in either form, of which
+* only the QAP evaluation at t is computed
+*/
+template<typename ppT, typename ConstraintSystemT>
+r1cs_gg_ppzksnark_zok_verification_key<ppT> generator_mapped_keys(const ConstraintSystemT &r1cs,
+                                                                  size_t num_variables,
+                                                                  size_t num_inputs,
+                                                                  const std::string& pk_path,
+                                                                  const Config& config)
+{
+    typedef libff::Fr<ppT> FieldT;
+    libff::enter_block("Call to r1cs_gg_ppzksnark_zok_generator_mapped");
+
+    const size_t memory_budget = config.stream_memory_budget ? config.stream_memory_budget : GENERATOR_MAPPED_DEFAULT_BUDGET;
+
+    /* Generate secret randomness */
+    const r1cs_gg_ppzksnark_zok_toxic_waste<ppT> secrets = r1cs_gg_ppzksnark_zok_toxic_waste<ppT>::random();
+    const FieldT &t = secrets.t;
+    const FieldT &alpha = secrets.alpha;
+    const FieldT &beta = secrets.beta;
+    const FieldT &gamma = secrets.gamma;
+    const FieldT &delta = secrets.delta;
+    const FieldT gamma_inverse = gamma.inverse();
+    const FieldT delta_inverse = delta.inverse();
+
+    const qap_compact_evaluation<FieldT> qap = generator_qap_evaluation(r1cs, t, config);
+    const size_t m = qap.m;
+    const FieldT &Zt = qap.Zt;
+    const std::vector<FieldT> &At = qap.At;
+    const std::vector<FieldT> &Bt = qap.Bt;
+    const std::vector<FieldT> &Ct = qap.Ct;
+
+    libff::enter_block("Compute query densities");
+    std::vector<size_t> A_indices;
+    std::vector<size_t> B_indices;
+    for (size_t i = 0; i < num_variables + 1; ++i)
+    {
+        if (!At[i].is_zero())
+        {
+            A_indices.emplace_back(i);
+        }
+        if (!Bt[i].is_zero())
+        {
+            B_indices.emplace_back(i);
+        }
+    }
+    libff::leave_block("Compute query densities");
+
+    /* Note that H for Groth's proof system is degree d-2 */
+    const size_t H_count = m - 1;
+    const size_t L_count = num_variables - num_inputs;
+    const size_t Lt_offset = num_inputs + 1;
+
+    /* The window tables take up to a quarter of the budget, the chunk buffers the rest */
+    const size_t scalar_size = FieldT::size_in_bits();
+    const size_t table_budget = memory_budget / 4;
+    const size_t chunk_budget = memory_budget - table_budget;
+
+    libff::enter_block("Generating G1 MSM window table");
+    const libff::G1<ppT> &g1_generator = secrets.g1_generator;
+    const size_t g1_scalar_count = A_indices.size() + H_count + L_count + num_inputs;
+    const size_t g1_window_size = generator_mapped_window_size<libff::G1<ppT>>(g1_scalar_count, scalar_size, table_budget / 2);
+
+    libff::print_indent(); printf("* G1 window: %zu\n", g1_window_size);
+    const libff::window_table<libff::G1<ppT>> g1_table = libff::get_window_table(scalar_size, g1_window_size, g1_generator);
+    libff::leave_block("Generating G1 MSM window table");
+
+    libff::enter_block("Generating G2 MSM window table");
+    const libff::G2<ppT> &G2_gen = secrets.g2_generator;
+    const size_t g2_window_size = generator_mapped_window_size<libff::G2<ppT>>(B_indices.size(), scalar_size, table_budget / 2);
+
+    libff::print_indent(); printf("* G2 window: %zu\n", g2_window_size);
+    const libff::window_table<libff::G2<ppT>> g2_table = libff::get_window_table(scalar_size, g2_window_size, G2_gen);
+    libff::leave_block("Generating G2 MSM window table");
+
+    const libff::G1<ppT> alpha_g1 = alpha * g1_generator;
+    const libff::G1<ppT> beta_g1 = beta * g1_generator;
+    const libff::G2<ppT> beta_g2 = beta * G2_gen;
+    const libff::G1<ppT> delta_g1 = delta * g1_generator;
+    const libff::G2<ppT> delta_g2 = delta * G2_gen;
+
+    libff::enter_block("Write R1CS proving key");
+    std::ofstream out(pk_path, std::ios::binary | std::ios::trunc);
+    if (!out.is_open())
+    {
+        throw std::runtime_error("Cannot open file: " + pk_path);
+    }
+
+    const uint64_t counts[MAPPED_PK_NUM_SECTIONS] = {
+        3, 2,
+        A_indices.size(), A_indices.size(),
+        B_indices.size(), B_indices.size(),
+        H_count, L_count
+    };
+    mapped_pk_header header;
+    mapped_pk_layout<ppT>(header, num_variables + 1, num_variables + 1, counts);
+
+    mapped_pk_write_points<ppT>(out, header, alpha_g1, beta_g1, delta_g1, beta_g2, delta_g2);
+    mapped_pk_write_section(out, header, MAPPED_PK_A_INDICES, A_indices.data(), 0, A_indices.size());
+    mapped_pk_write_section(out, header, MAPPED_PK_B_INDICES, B_indices.data(), 0, B_indices.size());
+
+    const size_t g1_chunk_size = stream_chunk_size(chunk_budget, sizeof(libff::G1<ppT>), sizeof(FieldT));
+    const size_t g2_chunk_size = stream_chunk_size(chunk_budget, sizeof(libff::G2<ppT>), sizeof(FieldT));
+
+    libff::enter_block("Compute the A-query", false);
+    generator_mapped_write_query<libff::G1<ppT>, FieldT>(out, header, MAPPED_PK_A_VALUES, g1_table, g1_window_size, g1_chunk_size,
+        [&](FieldT* scalars, size_t first, size_t count) {
+            for (size_t i = 0; i < count; i++)
+            {
+                scalars[i] = At[A_indices[first + i]];
+            }
+        }, config);
+    libff::leave_block("Compute the A-query", false);
+
+    libff::enter_block("Compute the B-query", false);
+    generator_mapped_write_query<libff::G2<ppT>, FieldT>(out, header, MAPPED_PK_B_VALUES, g2_table, g2_window_size, g2_chunk_size,
+        [&](FieldT* scalars, size_t first, size_t count) {
+            for (size_t i = 0; i < count; i++)
+            {
+                scalars[i] = Bt[B_indices[first + i]];
+            }
+        }, config);
+    libff::leave_block("Compute the B-query", false);
+
+    libff::enter_block("Compute the H-query", false);
+    const FieldT Zt_delta_inverse = Zt * delta_inverse;
+    generator_mapped_write_query<libff::G1<ppT>, FieldT>(out, header, MAPPED_PK_H_QUERY, g1_table, g1_window_size, g1_chunk_size,
+        [&](FieldT* scalars, size_t first, size_t count) {
+            FieldT ti = (t ^ first) * Zt_delta_inverse;
+            for (size_t i = 0; i < count; i++)
+            {
+                scalars[i] = ti;
+                ti *= t;
+            }
+        }, config);
+    libff::leave_block("Compute the H-query", false);
+
+    /* The delta inverse product component: (beta*A_i(t) + alpha*B_i(t) + C_i(t)) * delta^{-1}. */
+    libff::enter_block("Compute the L-query", false);
+    generator_mapped_write_query<libff::G1<ppT>, FieldT>(out, header, MAPPED_PK_L_QUERY, g1_table, g1_window_size, g1_chunk_size,
+        [&](FieldT* scalars, size_t first, size_t count) {
+            for (size_t i = first; i < first + count; i++)
+            {
+                const size_t j = Lt_offset + i;
+                scalars[i - first] = (beta * At[j] + alpha * Bt[j] + Ct[j]) * delta_inverse;
+            }
+        }, config);
+    libff::leave_block("Compute the L-query", false);
+
+    mapped_pk_finish(out, header);
+    if (!out.good())
+    {
+        throw std::runtime_error("Cannot write file: " + pk_path);
+    }
+    libff::leave_block("Write R1CS proving key");
+
+    /* The gamma inverse product component: (beta*A_i(t) + alpha*B_i(t) + C_i(t)) * gamma^{-1}. */
+    libff::enter_block("Generate R1CS verification key");
+    const libff::G2<ppT> gamma_g2 = gamma * G2_gen;
+
+    libff::Fr_vector<ppT> gamma_ABC;
+    gamma_ABC.reserve(num_inputs);
+    const FieldT gamma_ABC_0 = (beta * At[0] + alpha * Bt[0] + Ct[0]) * gamma_inverse;
+    for (size_t i = 1; i < num_inputs + 1; ++i)
+    {
+        gamma_ABC.emplace_back((beta * At[i] + alpha * Bt[i] + Ct[i]) * gamma_inverse);
+    }
+
+    libff::G1<ppT> gamma_ABC_g1_0 = gamma_ABC_0 * g1_generator;
+    libff::G1_vector<ppT> gamma_ABC_g1_values = libff::batch_exp(scalar_size, g1_window_size, g1_table, gamma_ABC);
+    accumulation_vector<libff::G1<ppT>> gamma_ABC_g1(std::move(gamma_ABC_g1_0), std::move(gamma_ABC_g1_values));
+    libff::leave_block("Generate R1CS verification key");
+
+    libff::leave_block("Call to r1cs_gg_ppzksnark_zok_generator_mapped");
+
+    return r1cs_gg_ppzksnark_zok_verification_key<ppT>(alpha_g1, beta_g2, gamma_g2, delta_g2, gamma_ABC_g1);
+}
+
+
+template<typename ppT>
+r1cs_gg_ppzksnark_zok_verification_key<ppT> r1cs_gg_ppzksnark_zok_generator_mapped(const r1cs_gg_ppzksnark_zok_constraint_system<ppT> &cs,
+                                                                                   const std::string& pk_path,
+                                                                                   const Config& config)
+{
+    return generator_mapped_keys<ppT>(cs, cs.num_variables(), cs.num_inputs(), pk_path, config);
+}
+
+
+template<typename ppT>
+r1cs_gg_ppzksnark_zok_verification_key<ppT> r1cs_gg_ppzksnark_zok_generator_mapped(const r1cs_compact_constraints<libff::Fr<ppT>> &cs,
+                                                                                   const std::string& pk_path,
+                                                                                   const Config& config)
+{
+    return generator_mapped_keys<ppT>(cs, cs.num_variables, cs.num_inputs, pk_path, config);
+}
+
+
+template<typename ppT>
+r1cs_gg_ppzksnark_zok_keypair<ppT> r1cs_gg_ppzksnark_zok_generator(const r1cs_compact_constraints<libff::Fr<ppT>> &cs,
+                                                               const r1cs_gg_ppzksnark_zok_toxic_waste<ppT> &secrets,
+                                                               const Config& config)
+{
+    typedef libff::Fr<ppT> FieldT;
+    libff::enter_block("Call to r1cs_gg_ppzksnark_zok_generator");
+
+    qap_compact_evaluation<FieldT> qap = generator_qap_evaluation(cs, secrets.t, config);
+
+    /* Note that H for Groth's proof system is degree d-2 */
+    std::vector<FieldT> Ht(qap.m - 1);
+    FieldT ti = FieldT::one();
+    for (size_t i = 0; i < qap.m - 1; i++)
+    {
+        Ht[i] = ti;
+        ti *= secrets.t;
+    }
+
+    auto keypair = r1cs_gg_ppzksnark_zok_generator_from_evaluation<ppT>(std::move(qap.At), std::move(qap.Bt), std::move(qap.Ct), std::move(Ht),
+                                                                         qap.Zt, cs.num_inputs, cs.num_variables, secrets);
+
+    libff::leave_block("Call to r1cs_gg_ppzksnark_zok_generator");
+    return keypair;
+}
+
+
+/**
+* Carry over the entries of a sparse query whose exponent is the same in both
+* constraint systems. The entries to recompute are left as zero, their
+* positions and exponents are appended to `positions` and `scalars`.
+*/
+template<typename T, typename FieldT>
+void generator_incremental_sparse(const sparse_vector<T>& previous, const std::vector<FieldT>& previous_scalars,
+                                  const std::vector<FieldT>& current_scalars, sparse_vector<T>& result,
+                                  std::vector<size_t>& positions, std::vector<FieldT>& scalars)
+{
+    result.domain_size_ = current_scalars.size();
+    result.indices.clear();
+    result.values.clear();
+
+    size_t p = 0;
+    for (size_t i = 0; i < current_scalars.size(); i++)
+    {
+        if (current_scalars[i].is_zero())
+        {
+            continue;
+        }
+        while (p < previous.indices.size() && previous.indices[p] < i)
+        {
+            p++;
+        }
+
+        result.indices.emplace_back(i);
+        if (i < previous_scalars.size() && previous_scalars[i] == current_scalars[i]
+            && p < previous.indices.size() && previous.indices[p] == i)
+        {
+            result.values.emplace_back(previous.values[p]);
+        }
+        else
+        {
+            result.values.emplace_back(T::zero());
+            positions.emplace_back(result.values.size() - 1);
+            scalars.emplace_back(current_scalars[i]);
+        }
+    }
+}
+
+
+/**
+* Compute `values[positions[k]] = scalars[k] * generator`, in parallel
+*/
+template<typename T, typename FieldT>
+void generator_incremental_exp(std::vector<T>& values, const std::vector<size_t>& positions, const std::vector<FieldT>& scalars,
+                               const T& generator, const Config& config)
+{
+    if (positions.empty())
+    {
+        return;
+    }
+
+    const size_t scalar_size = FieldT::size_in_bits();
+    const size_t window = libff::get_exp_window_size<T>(positions.size());
+    const libff::window_table<T> table = libff::get_window_table(scalar_size, window, generator);
+
+    std::vector<T> computed(positions.size());
+    witness_map_for_blocks(positions.size(), 1024, false, config, [&](size_t begin, size_t end) {
+        for (size_t k = begin; k < end; k++)
+        {
+            computed[k] = libff::windowed_exp<T, FieldT>(scalar_size, window, table, scalars[k]);
+        }
+    });
+#ifdef USE_MIXED_ADDITION
+    libff::batch_to_special<T>(computed);
+#endif
+
+    for (size_t k = 0; k < positions.size(); k++)
+    {
+        values[positions[k]] = computed[k];
+    }
+}
+
+
+template<typename ppT>
+r1cs_gg_ppzksnark_zok_verification_key<ppT> r1cs_gg_ppzksnark_zok_generator_incremental(const r1cs_gg_ppzksnark_zok_constraint_system<ppT> &previous_cs,
+                                                                                        const r1cs_gg_ppzksnark_zok_proving_key_nozk<ppT> &previous_pk,
+                                                                                        const r1cs_gg_ppzksnark_zok_constraint_system<ppT> &cs,
+                                                                                        const r1cs_gg_ppzksnark_zok_toxic_waste<ppT> &secrets,
+                                                                                        r1cs_gg_ppzksnark_zok_proving_key_nozk<ppT> &pk,
+                                                                                        const Config& config)
+{
+    typedef libff::Fr<ppT> FieldT;
+    libff::enter_block("Call to r1cs_gg_ppzksnark_zok_generator_incremental");
+
+    const FieldT gamma_inverse = secrets.gamma.inverse();
+    const FieldT delta_inverse = secrets.delta.inverse();
+
+    pk.alpha_g1 = secrets.alpha * secrets.g1_generator;
+    pk.beta_g1 = secrets.beta * secrets.g1_generator;
+    pk.beta_g2 = secrets.beta * secrets.g2_generator;
+    pk.delta_g1 = secrets.delta * secrets.g1_generator;
+    pk.delta_g2 = secrets.delta * secrets.g2_generator;
+
+    if (previous_pk.alpha_g1 != pk.alpha_g1 || previous_pk.delta_g2 != pk.delta_g2)
+    {
+        throw std::runtime_error("Previous proving key was not generated with these secrets");
+    }
+    if (previous_pk.A_query.domain_size() != previous_cs.num_variables() + 1
+        || previous_pk.L_query.size() != previous_cs.num_variables() - previous_cs.num_inputs())
+    {
+        throw std::runtime_error("Previous proving key does not match the previous constraint system");
+    }
+
+    const qap_compact_evaluation<FieldT> previous = generator_qap_evaluation(previous_cs, secrets.t, config);
+    const qap_compact_evaluation<FieldT> current = generator_qap_evaluation(cs, secrets.t, config);
+
+    /**
+     * Every query entry is its exponent times a fixed generator, so an entry
+     * of the previous key is reused as is wherever the exponent is the same.
+     * Variables whose columns did not change keep their exponents, unless
+     * the domain changed size, in which case everything is recomputed.
+     */
+    libff::enter_block("Compute the A-query");
+    std::vector<size_t> A_positions;
+    std::vector<FieldT> A_scalars;
+    generator_incremental_sparse(previous_pk.A_query, previous.At, current.At, pk.A_query, A_positions, A_scalars);
+    generator_incremental_exp(pk.A_query.values, A_positions, A_scalars, secrets.g1_generator, config);
+    libff::print_indent(); printf("* Recomputed %zu of %zu\n", A_positions.size(), pk.A_query.values.size());
+    libff::leave_block("Compute the A-query");
+
+    libff::enter_block("Compute the B-query");
+    std::vector<size_t> B_positions;
+    std::vector<FieldT> B_scalars;
+    generator_incremental_sparse(previous_pk.B_query, previous.Bt, current.Bt, pk.B_query, B_positions, B_scalars);
+    generator_incremental_exp(pk.B_query.values, B_positions, B_scalars, secrets.g2_generator, config);
+    libff::print_indent(); printf("* Recomputed %zu of %zu\n", B_positions.size(), pk.B_query.values.size());
+    libff::leave_block("Compute the B-query");
+
+    /* Note that H for Groth's proof system is degree d-2, it only depends on the domain */
+    libff::enter_block("Compute the H-query");
+    if (previous.m == current.m && previous_pk.H_query.size() == current.m - 1)
+    {
+        pk.H_query = previous_pk.H_query;
+    }
+    else
+    {
+        std::vector<size_t> H_positions(current.m - 1);
+        std::vector<FieldT> H_scalars(current.m - 1);
+        FieldT ti = current.Zt * delta_inverse;
+        for (size_t i = 0; i < current.m - 1; i++)
+        {
+            H_positions[i] = i;
+            H_scalars[i] = ti;
+            ti *= secrets.t;
+        }
+        pk.H_query.assign(current.m - 1, libff::G1<ppT>::zero());
+        generator_incremental_exp(pk.H_query, H_positions, H_scalars, secrets.g1_generator, config);
+    }
+    libff::leave_block("Compute the H-query");
+
+    /* The delta inverse product component: (beta*A_i(t) + alpha*B_i(t) + C_i(t)) * delta^{-1}. */
+    libff::enter_block("Compute the L-query");
+    auto L_scalar = [&](const qap_compact_evaluation<FieldT>& qap, size_t i) {
+        return (secrets.beta * qap.At[i] + secrets.alpha * qap.Bt[i] + qap.Ct[i]) * delta_inverse;
+    };
+
+    const size_t num_inputs = cs.num_inputs();
+    const size_t L_count = cs.num_variables() - num_inputs;
+    const size_t Lt_offset = num_inputs + 1;
+    const size_t previous_Lt_offset = previous_cs.num_inputs() + 1;
+    std::vector<size_t> L_positions;
+    std::vector<FieldT> L_scalars;
+    pk.L_query.assign(L_count, libff::G1<ppT>::zero());
+    for (size_t j = 0; j < L_count; j++)
+    {
+        const size_t i = Lt_offset + j;
+        const FieldT scalar = L_scalar(current, i);
+        if (i >= previous_Lt_offset && i < previous.At.size() && scalar == L_scalar(previous, i))
+        {
+            pk.L_query[j] = previous_pk.L_query[i - previous_Lt_offset];
+        }
+        else
+        {
+            L_positions.emplace_back(j);
+            L_scalars.emplace_back(scalar);
+        }
+    }
+    generator_incremental_exp(pk.L_query, L_positions, L_scalars, secrets.g1_generator, config);
+    libff::print_indent(); printf("* Recomputed %zu of %zu\n", L_positions.size(), L_count);
+    libff::leave_block("Compute the L-query");
+
+    /* The gamma inverse product component: (beta*A_i(t) + alpha*B_i(t) + C_i(t)) * gamma^{-1}. */
+    libff::enter_block("Generate R1CS verification key");
+    const libff::G2<ppT> gamma_g2 = secrets.gamma * secrets.g2_generator;
+
+    libff::G1_vector<ppT> gamma_ABC_g1_values;
+    gamma_ABC_g1_values.reserve(num_inputs);
+    const FieldT gamma_ABC_0 = (secrets.beta * current.At[0] + secrets.alpha * current.Bt[0] + current.Ct[0]) * gamma_inverse;
+    for (size_t i = 1; i < num_inputs + 1; ++i)
+    {
+        const FieldT gamma_ABC_i = (secrets.beta * current.At[i] + secrets.alpha * current.Bt[i] + current.Ct[i]) * gamma_inverse;
+        gamma_ABC_g1_values.emplace_back(gamma_ABC_i * secrets.g1_generator);
+    }
+    libff::G1<ppT> gamma_ABC_g1_0 = gamma_ABC_0 * secrets.g1_generator;
+    accumulation_vector<libff::G1<ppT>> gamma_ABC_g1(std::move(gamma_ABC_g1_0), std::move(gamma_ABC_g1_values));
+    libff::leave_block("Generate R1CS verification key");
+
+    libff::leave_block("Call to r1cs_gg_ppzksnark_zok_generator_incremental");
+
+    return r1cs_gg_ppzksnark_zok_verification_key<ppT>(pk.alpha_g1, pk.beta_g2, gamma_g2, pk.delta_g2, gamma_ABC_g1);
+}
+
+
+} // libsnark
+
+#endif
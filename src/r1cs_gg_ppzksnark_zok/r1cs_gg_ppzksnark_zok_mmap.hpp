@@ -0,0 +1,227 @@
+#ifndef ETHSNARKS_R1CS_GG_PPZKSNARK_ZOK_MMAP_HPP_
+#define ETHSNARKS_R1CS_GG_PPZKSNARK_ZOK_MMAP_HPP_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <libff/algebra/curves/public_params.hpp>
+
+namespace libsnark {
+
+/**
+* Memory-mappable proving key format
+*
+* The header is followed by a number of sections, each of which starts on a
+* page boundary and contains the in-memory representation of its elements.
+* Once mapped, the queries are used directly by the prover: there is no
+* per-element deserialisation and processes on the same host share the
+* page cache.
+*
+* Because the elements are stored as they are in memory, the file is only
+* portable between builds using the same curve and the same endianness;
+* the element sizes and a byte-order marker are recorded in the header
+* and checked on load.
+*
+*   header
+*   [G1 points]   alpha_g1, beta_g1, delta_g1
+*   [G2 points]   beta_g2, delta_g2
+*   [A indices]   size_t[A count]
+*   [A values]    G1[A count]
+*   [B indices]   size_t[B count]
+*   [B values]    G2[B count]
+*   [H query]     G1[H count]
+*   [L query]     G1[L count]
+*/
+
+static const char MAPPED_PK_MAGIC[8] = {'E', 'S', 'P', 'K', 'M', 'A', 'P', '\0'};
+static const uint32_t MAPPED_PK_VERSION = 1;
+static const uint32_t MAPPED_PK_BYTE_ORDER = 0x01020304;
+
+enum mapped_pk_section_id {
+    MAPPED_PK_G1_POINTS = 0,
+    MAPPED_PK_G2_POINTS,
+    MAPPED_PK_A_INDICES,
+    MAPPED_PK_A_VALUES,
+    MAPPED_PK_B_INDICES,
+    MAPPED_PK_B_VALUES,
+    MAPPED_PK_H_QUERY,
+    MAPPED_PK_L_QUERY,
+    MAPPED_PK_NUM_SECTIONS
+};
+
+struct mapped_pk_section
+{
+    uint64_t offset;    // byte offset from start of file, page aligned
+    uint64_t count;     // number of elements
+};
+
+struct mapped_pk_header
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint32_t page_size;
+    uint32_t G1_size;
+    uint32_t G2_size;
+    uint32_t index_size;
+    uint64_t A_domain_size;
+    uint64_t B_domain_size;
+    uint64_t file_size;
+    mapped_pk_section sections[MAPPED_PK_NUM_SECTIONS];
+};
+
+
+/**
+* Read-only view of a contiguous array of elements
+*/
+template<typename T>
+class array_view {
+public:
+    const T* data_;
+    size_t size_;
+
+    array_view() : data_(nullptr), size_(0) {}
+    array_view(const T* data, size_t size) : data_(data), size_(size) {}
+
+    const T* data() const { return data_; }
+    size_t size() const { return size_; }
+    const T* begin() const { return data_; }
+    const T* end() const { return data_ + size_; }
+    const T& operator[](size_t i) const { return data_[i]; }
+};
+
+
+/**
+* Read-only view with the same layout as libsnark's `sparse_vector`
+*/
+template<typename T>
+class sparse_vector_view {
+public:
+    array_view<size_t> indices;
+    array_view<T> values;
+    size_t domain_size_;
+
+    sparse_vector_view() : domain_size_(0) {}
+
+    size_t size() const { return indices.size(); }
+    size_t domain_size() const { return domain_size_; }
+};
+
+
+/**
+* Read-only memory mapping of a whole file, on Windows the file is read
+* into memory instead.
+*
+* Throws `std::runtime_error` if the file cannot be opened or mapped.
+*/
+class mapped_file {
+public:
+    explicit mapped_file(const std::string& path);
+    ~mapped_file();
+
+    mapped_file(const mapped_file&) = delete;
+    mapped_file& operator=(const mapped_file&) = delete;
+
+    const uint8_t* data() const { return base; }
+    size_t size() const { return length; }
+
+    /** Hint to the kernel that the whole file will be needed soon */
+    void prefetch() const;
+
+    /**
+    * Pointer to `count` elements of type T at `offset`, throws if they
+    * are not within the file or are misaligned
+    */
+    template<typename T>
+    const T* at(uint64_t offset, uint64_t count) const;
+
+private:
+    const uint8_t* base;
+    size_t length;
+#ifdef _WIN32
+    std::vector<uint8_t> heap_copy;
+#endif
+};
+
+
+template<typename ppT>
+class r1cs_gg_ppzksnark_zok_proving_key_nozk;
+
+
+/**
+* A proving key backed by a memory mapped file in the format described above.
+*
+* Throws `std::runtime_error` if the file cannot be opened or does not match
+* the format expected by this build.
+*/
+template<typename ppT>
+class r1cs_gg_ppzksnark_zok_proving_key_mapped {
+public:
+    libff::G1<ppT> alpha_g1;
+    libff::G1<ppT> beta_g1;
+    libff::G2<ppT> beta_g2;
+    libff::G1<ppT> delta_g1;
+    libff::G2<ppT> delta_g2;
+
+    sparse_vector_view<libff::G1<ppT>> A_query;
+    sparse_vector_view<libff::G2<ppT>> B_query;
+    array_view<libff::G1<ppT>> H_query;
+    array_view<libff::G1<ppT>> L_query;
+
+    explicit r1cs_gg_ppzksnark_zok_proving_key_mapped(const std::string& path);
+
+    const mapped_pk_header& header() const
+    {
+        return *file.at<mapped_pk_header>(0, 1);
+    }
+
+    /** Hint to the kernel that the whole key will be needed soon */
+    void prefetch() const
+    {
+        file.prefetch();
+    }
+
+private:
+    mapped_file file;
+
+    void load_sections();
+
+    template<typename T>
+    const T* section(mapped_pk_section_id id, size_t expected_size) const;
+};
+
+
+/**
+* Returns true if the file starts with the mapped proving key magic
+*/
+inline bool is_mapped_proving_key(const std::string& path);
+
+
+/**
+* Throws `std::runtime_error` if the header does not describe a key which
+* this build can use, or if the file is smaller than the header says
+*/
+template<typename ppT>
+void check_mapped_pk_header(const mapped_pk_header& h, uint64_t file_size);
+
+
+/**
+* Fill in a header for a key with `counts[id]` elements in each section,
+* placing every section on its own page boundary
+*/
+template<typename ppT>
+void mapped_pk_layout(mapped_pk_header& header, uint64_t A_domain_size, uint64_t B_domain_size, const uint64_t (&counts)[MAPPED_PK_NUM_SECTIONS]);
+
+
+/**
+* Write a proving key in the memory mappable format
+*/
+template<typename ppT>
+bool write_proving_key_mapped(const r1cs_gg_ppzksnark_zok_proving_key_nozk<ppT>& pk, const std::string& path);
+
+} // libsnark
+
+#include "r1cs_gg_ppzksnark_zok/r1cs_gg_ppzksnark_zok_mmap.tcc"
+
+#endif
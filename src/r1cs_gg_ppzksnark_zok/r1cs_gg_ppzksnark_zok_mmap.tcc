@@ -0,0 +1,299 @@
+#ifndef ETHSNARKS_R1CS_GG_PPZKSNARK_ZOK_MMAP_TCC_
+#define ETHSNARKS_R1CS_GG_PPZKSNARK_ZOK_MMAP_TCC_
+
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace libsnark {
+
+static const uint64_t MAPPED_PK_PAGE_SIZE = 4096;
+
+
+static inline uint64_t mapped_pk_align(uint64_t offset)
+{
+    return (offset + MAPPED_PK_PAGE_SIZE - 1) & ~(MAPPED_PK_PAGE_SIZE - 1);
+}
+
+
+inline bool is_mapped_proving_key(const std::string& path)
+{
+    std::ifstream fh(path, std::ios::binary);
+    char magic[sizeof(MAPPED_PK_MAGIC)];
+    if (!fh.read(magic, sizeof(magic)))
+    {
+        return false;
+    }
+    return 0 == ::memcmp(magic, MAPPED_PK_MAGIC, sizeof(magic));
+}
+
+
+template<typename ppT>
+void mapped_pk_layout(mapped_pk_header& header, uint64_t A_domain_size, uint64_t B_domain_size, const uint64_t (&counts)[MAPPED_PK_NUM_SECTIONS])
+{
+    ::memset(&header, 0, sizeof(header));
+    ::memcpy(header.magic, MAPPED_PK_MAGIC, sizeof(MAPPED_PK_MAGIC));
+    header.version = MAPPED_PK_VERSION;
+    header.byte_order = MAPPED_PK_BYTE_ORDER;
+    header.page_size = MAPPED_PK_PAGE_SIZE;
+    header.G1_size = sizeof(libff::G1<ppT>);
+    header.G2_size = sizeof(libff::G2<ppT>);
+    header.index_size = sizeof(size_t);
+    header.A_domain_size = A_domain_size;
+    header.B_domain_size = B_domain_size;
+
+    uint64_t offset = mapped_pk_align(sizeof(header));
+    for (size_t i = 0; i < MAPPED_PK_NUM_SECTIONS; i++)
+    {
+        const size_t element_size = (i == MAPPED_PK_A_INDICES || i == MAPPED_PK_B_INDICES) ? sizeof(size_t)
+                                  : (i == MAPPED_PK_G2_POINTS || i == MAPPED_PK_B_VALUES) ? sizeof(libff::G2<ppT>)
+                                  : sizeof(libff::G1<ppT>);
+        header.sections[i].offset = offset;
+        header.sections[i].count = counts[i];
+        offset = mapped_pk_align(offset + (counts[i] * element_size));
+    }
+    header.file_size = offset;
+}
+
+
+template<typename T>
+static void mapped_pk_write_section(std::ostream& out, const mapped_pk_header& header, mapped_pk_section_id id, const T* data, size_t first, size_t count)
+{
+    if (count)
+    {
+        out.seekp(header.sections[id].offset + (first * sizeof(T)));
+        out.write(reinterpret_cast<const char*>(data), count * sizeof(T));
+    }
+}
+
+
+template<typename ppT>
+void mapped_pk_write_points(std::ostream& out, const mapped_pk_header& header,
+                            const libff::G1<ppT>& alpha_g1, const libff::G1<ppT>& beta_g1, const libff::G1<ppT>& delta_g1,
+                            const libff::G2<ppT>& beta_g2, const libff::G2<ppT>& delta_g2)
+{
+    const libff::G1<ppT> g1_points[3] = {alpha_g1, beta_g1, delta_g1};
+    const libff::G2<ppT> g2_points[2] = {beta_g2, delta_g2};
+    mapped_pk_write_section(out, header, MAPPED_PK_G1_POINTS, g1_points, 0, 3);
+    mapped_pk_write_section(out, header, MAPPED_PK_G2_POINTS, g2_points, 0, 2);
+}
+
+
+inline void mapped_pk_finish(std::ostream& out, const mapped_pk_header& header)
+{
+    // Pad the final section, so every section can be mapped in whole pages
+    out.seekp(0, std::ios::end);
+    if (static_cast<uint64_t>(out.tellp()) < header.file_size)
+    {
+        out.seekp(header.file_size - 1);
+        out.put(0);
+    }
+
+    out.seekp(0);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.flush();
+}
+
+
+template<typename ppT>
+bool write_proving_key_mapped(const r1cs_gg_ppzksnark_zok_proving_key_nozk<ppT>& pk, const std::string& path)
+{
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out.is_open())
+    {
+        return false;
+    }
+
+    const uint64_t counts[MAPPED_PK_NUM_SECTIONS] = {
+        3, 2,
+        pk.A_query.indices.size(), pk.A_query.values.size(),
+        pk.B_query.indices.size(), pk.B_query.values.size(),
+        pk.H_query.size(), pk.L_query.size()
+    };
+    mapped_pk_header header;
+    mapped_pk_layout<ppT>(header, pk.A_query.domain_size(), pk.B_query.domain_size(), counts);
+
+    mapped_pk_write_points<ppT>(out, header, pk.alpha_g1, pk.beta_g1, pk.delta_g1, pk.beta_g2, pk.delta_g2);
+    mapped_pk_write_section(out, header, MAPPED_PK_A_INDICES, pk.A_query.indices.data(), 0, pk.A_query.indices.size());
+    mapped_pk_write_section(out, header, MAPPED_PK_A_VALUES, pk.A_query.values.data(), 0, pk.A_query.values.size());
+    mapped_pk_write_section(out, header, MAPPED_PK_B_INDICES, pk.B_query.indices.data(), 0, pk.B_query.indices.size());
+    mapped_pk_write_section(out, header, MAPPED_PK_B_VALUES, pk.B_query.values.data(), 0, pk.B_query.values.size());
+    mapped_pk_write_section(out, header, MAPPED_PK_H_QUERY, pk.H_query.data(), 0, pk.H_query.size());
+    mapped_pk_write_section(out, header, MAPPED_PK_L_QUERY, pk.L_query.data(), 0, pk.L_query.size());
+
+    mapped_pk_finish(out, header);
+    return out.good();
+}
+
+
+inline mapped_file::mapped_file(const std::string& path) :
+    base(nullptr),
+    length(0)
+{
+#ifdef _WIN32
+    // No mmap available, fall back to reading the file in one go
+    std::ifstream fh(path, std::ios::binary | std::ios::ate);
+    if (!fh.is_open())
+    {
+        throw std::runtime_error("Cannot open file: " + path);
+    }
+    length = fh.tellg();
+    heap_copy.resize(length);
+    fh.seekg(0);
+    fh.read(reinterpret_cast<char*>(heap_copy.data()), length);
+    base = heap_copy.data();
+#else
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        throw std::runtime_error("Cannot open file: " + path);
+    }
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0)
+    {
+        ::close(fd);
+        throw std::runtime_error("Cannot stat file: " + path);
+    }
+    length = st.st_size;
+
+    void* addr = ::mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (addr == MAP_FAILED)
+    {
+        throw std::runtime_error("Cannot mmap file: " + path);
+    }
+    base = static_cast<const uint8_t*>(addr);
+#endif
+}
+
+
+inline mapped_file::~mapped_file()
+{
+#ifndef _WIN32
+    if (base != nullptr)
+    {
+        ::munmap(const_cast<uint8_t*>(base), length);
+    }
+#endif
+}
+
+
+inline void mapped_file::prefetch() const
+{
+#ifndef _WIN32
+    ::madvise(const_cast<uint8_t*>(base), length, MADV_WILLNEED);
+#endif
+}
+
+
+template<typename T>
+const T* mapped_file::at(uint64_t offset, uint64_t count) const
+{
+    if ((offset % alignof(T)) != 0 || offset > length || count > (length - offset) / sizeof(T))
+    {
+        throw std::runtime_error("Mapped file: data out of bounds or misaligned");
+    }
+    return reinterpret_cast<const T*>(base + offset);
+}
+
+
+template<typename ppT>
+void check_mapped_pk_header(const mapped_pk_header& h, uint64_t file_size)
+{
+    const char* error = nullptr;
+    if (0 != ::memcmp(h.magic, MAPPED_PK_MAGIC, sizeof(MAPPED_PK_MAGIC)))
+    {
+        error = "Mapped proving key: bad magic";
+    }
+    else if (h.version != MAPPED_PK_VERSION)
+    {
+        error = "Mapped proving key: unsupported version";
+    }
+    else if (h.byte_order != MAPPED_PK_BYTE_ORDER)
+    {
+        error = "Mapped proving key: byte order mismatch";
+    }
+    else if (h.G1_size != sizeof(libff::G1<ppT>) || h.G2_size != sizeof(libff::G2<ppT>) || h.index_size != sizeof(size_t))
+    {
+        error = "Mapped proving key: element sizes do not match this build";
+    }
+    else if (h.file_size > file_size)
+    {
+        error = "Mapped proving key: truncated file";
+    }
+    else if (h.sections[MAPPED_PK_A_INDICES].count != h.sections[MAPPED_PK_A_VALUES].count
+          || h.sections[MAPPED_PK_B_INDICES].count != h.sections[MAPPED_PK_B_VALUES].count)
+    {
+        error = "Mapped proving key: sparse query size mismatch";
+    }
+    if (error)
+    {
+        throw std::runtime_error(error);
+    }
+}
+
+
+template<typename ppT>
+template<typename T>
+const T* r1cs_gg_ppzksnark_zok_proving_key_mapped<ppT>::section(mapped_pk_section_id id, size_t expected_size) const
+{
+    if (expected_size != sizeof(T))
+    {
+        throw std::runtime_error("Mapped proving key: element size mismatch");
+    }
+    const auto& s = header().sections[id];
+    return file.at<T>(s.offset, s.count);
+}
+
+
+template<typename ppT>
+r1cs_gg_ppzksnark_zok_proving_key_mapped<ppT>::r1cs_gg_ppzksnark_zok_proving_key_mapped(const std::string& path) :
+    file(path)
+{
+    load_sections();
+}
+
+
+template<typename ppT>
+void r1cs_gg_ppzksnark_zok_proving_key_mapped<ppT>::load_sections()
+{
+    if (file.size() < sizeof(mapped_pk_header))
+    {
+        throw std::runtime_error("Mapped proving key: file too small");
+    }
+
+    const auto& h = header();
+    check_mapped_pk_header<ppT>(h, file.size());
+
+    const auto* g1_points = section<libff::G1<ppT>>(MAPPED_PK_G1_POINTS, h.G1_size);
+    const auto* g2_points = section<libff::G2<ppT>>(MAPPED_PK_G2_POINTS, h.G2_size);
+    alpha_g1 = g1_points[0];
+    beta_g1 = g1_points[1];
+    delta_g1 = g1_points[2];
+    beta_g2 = g2_points[0];
+    delta_g2 = g2_points[1];
+
+    A_query.domain_size_ = h.A_domain_size;
+    A_query.indices = array_view<size_t>(section<size_t>(MAPPED_PK_A_INDICES, h.index_size), h.sections[MAPPED_PK_A_INDICES].count);
+    A_query.values = array_view<libff::G1<ppT>>(section<libff::G1<ppT>>(MAPPED_PK_A_VALUES, h.G1_size), h.sections[MAPPED_PK_A_VALUES].count);
+
+    B_query.domain_size_ = h.B_domain_size;
+    B_query.indices = array_view<size_t>(section<size_t>(MAPPED_PK_B_INDICES, h.index_size), h.sections[MAPPED_PK_B_INDICES].count);
+    B_query.values = array_view<libff::G2<ppT>>(section<libff::G2<ppT>>(MAPPED_PK_B_VALUES, h.G2_size), h.sections[MAPPED_PK_B_VALUES].count);
+
+    H_query = array_view<libff::G1<ppT>>(section<libff::G1<ppT>>(MAPPED_PK_H_QUERY, h.G1_size), h.sections[MAPPED_PK_H_QUERY].count);
+    L_query = array_view<libff::G1<ppT>>(section<libff::G1<ppT>>(MAPPED_PK_L_QUERY, h.G1_size), h.sections[MAPPED_PK_L_QUERY].count);
+}
+
+
+} // libsnark
+
+#endif
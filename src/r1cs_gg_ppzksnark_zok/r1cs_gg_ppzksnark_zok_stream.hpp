@@ -0,0 +1,98 @@
+#ifndef ETHSNARKS_R1CS_GG_PPZKSNARK_ZOK_STREAM_HPP_
+#define ETHSNARKS_R1CS_GG_PPZKSNARK_ZOK_STREAM_HPP_
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+
+#ifdef _WIN32
+#include <fstream>
+#include <mutex>
+#endif
+
+#include "r1cs_gg_ppzksnark_zok/r1cs_gg_ppzksnark_zok_mmap.hpp"
+
+namespace libsnark {
+
+/**
+* A proving key in the mapped format (see r1cs_gg_ppzksnark_zok_mmap.hpp)
+* which is read from disk in chunks while proving, instead of being held in
+* memory or mapped in whole.
+*
+* Only the header and the five fixed points are kept resident. Each query is
+* read through two buffers: while the multi-exp runs over one chunk the next
+* one is read into the other, so for keys larger than RAM the disk reads
+* overlap the compute and the memory used for the key is bounded by the
+* chunk size rather than by the size of the key.
+*
+* Throws `std::runtime_error` if the file cannot be opened or does not match
+* the format expected by this build.
+*/
+template<typename ppT>
+class r1cs_gg_ppzksnark_zok_proving_key_stream {
+public:
+    libff::G1<ppT> alpha_g1;
+    libff::G1<ppT> beta_g1;
+    libff::G2<ppT> beta_g2;
+    libff::G1<ppT> delta_g1;
+    libff::G2<ppT> delta_g2;
+
+    explicit r1cs_gg_ppzksnark_zok_proving_key_stream(const std::string& path);
+    ~r1cs_gg_ppzksnark_zok_proving_key_stream();
+
+    r1cs_gg_ppzksnark_zok_proving_key_stream(const r1cs_gg_ppzksnark_zok_proving_key_stream&) = delete;
+    r1cs_gg_ppzksnark_zok_proving_key_stream& operator=(const r1cs_gg_ppzksnark_zok_proving_key_stream&) = delete;
+
+    const mapped_pk_header& header() const { return m_header; }
+
+    size_t count(mapped_pk_section_id id) const { return m_header.sections[id].count; }
+
+    /**
+    * Read elements [first, first+count) of a section into `dst`, safe to
+    * call from several threads at once
+    */
+    template<typename T>
+    void read(mapped_pk_section_id id, size_t first, size_t count, T* dst) const;
+
+    /**
+    * Stream a query through two buffers of up to `chunk_size` elements,
+    * calling `fn(values, indices, begin, n)` for each chunk in order while
+    * the next chunk is read. `indices` is null when `indices_id` is
+    * MAPPED_PK_NUM_SECTIONS, i.e. for the dense queries.
+    *
+    * Read errors, and exceptions thrown by `fn`, are propagated.
+    */
+    template<typename T, typename Fn>
+    void stream_query(mapped_pk_section_id values_id, mapped_pk_section_id indices_id, size_t chunk_size, Fn fn) const;
+
+private:
+    std::string m_path;
+    mapped_pk_header m_header;
+#ifdef _WIN32
+    mutable std::ifstream m_file;
+    mutable std::mutex m_file_mutex;
+#else
+    int m_fd;
+#endif
+
+    void read_bytes(uint64_t offset, size_t size, void* dst) const;
+    void release_bytes(uint64_t offset, size_t size) const;
+};
+
+
+/**
+* Number of elements per chunk for streaming a query so that both buffers,
+* plus `per_element` bytes of working memory per element (e.g. the exponents
+* of the batch), fit within `memory_budget` bytes. At least one element.
+*/
+inline size_t stream_chunk_size(size_t memory_budget, size_t element_size, size_t per_element)
+{
+    const size_t cost = (2 * element_size) + per_element;
+    return std::max<size_t>(1, memory_budget / cost);
+}
+
+} // libsnark
+
+#include "r1cs_gg_ppzksnark_zok/r1cs_gg_ppzksnark_zok_stream.tcc"
+
+#endif
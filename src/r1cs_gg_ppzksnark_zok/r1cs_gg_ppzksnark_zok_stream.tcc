@@ -0,0 +1,223 @@
+#ifndef ETHSNARKS_R1CS_GG_PPZKSNARK_ZOK_STREAM_TCC_
+#define ETHSNARKS_R1CS_GG_PPZKSNARK_ZOK_STREAM_TCC_
+
+#include <cerrno>
+#include <cstring>
+#include <future>
+#include <stdexcept>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace libsnark {
+
+
+template<typename ppT>
+r1cs_gg_ppzksnark_zok_proving_key_stream<ppT>::r1cs_gg_ppzksnark_zok_proving_key_stream(const std::string& path) :
+    m_path(path)
+{
+    uint64_t file_size;
+#ifdef _WIN32
+    m_file.open(path, std::ios::binary | std::ios::ate);
+    if (!m_file.is_open())
+    {
+        throw std::runtime_error("Cannot open file: " + path);
+    }
+    file_size = m_file.tellg();
+#else
+    m_fd = ::open(path.c_str(), O_RDONLY);
+    if (m_fd < 0)
+    {
+        throw std::runtime_error("Cannot open file: " + path);
+    }
+
+    struct stat st;
+    if (::fstat(m_fd, &st) != 0)
+    {
+        ::close(m_fd);
+        throw std::runtime_error("Cannot stat file: " + path);
+    }
+    file_size = st.st_size;
+#endif
+
+    try {
+        if (file_size < sizeof(mapped_pk_header))
+        {
+            throw std::runtime_error("Mapped proving key: file too small");
+        }
+        read_bytes(0, sizeof(m_header), &m_header);
+        check_mapped_pk_header<ppT>(m_header, file_size);
+
+        libff::G1<ppT> g1_points[3];
+        libff::G2<ppT> g2_points[2];
+        if (count(MAPPED_PK_G1_POINTS) != 3 || count(MAPPED_PK_G2_POINTS) != 2)
+        {
+            throw std::runtime_error("Mapped proving key: bad point sections");
+        }
+        read(MAPPED_PK_G1_POINTS, 0, 3, g1_points);
+        read(MAPPED_PK_G2_POINTS, 0, 2, g2_points);
+        alpha_g1 = g1_points[0];
+        beta_g1 = g1_points[1];
+        delta_g1 = g1_points[2];
+        beta_g2 = g2_points[0];
+        delta_g2 = g2_points[1];
+
+        for (size_t i = MAPPED_PK_A_INDICES; i < MAPPED_PK_NUM_SECTIONS; i++)
+        {
+            const auto& s = m_header.sections[i];
+            const size_t element_size = (i == MAPPED_PK_A_INDICES || i == MAPPED_PK_B_INDICES) ? sizeof(size_t)
+                                      : (i == MAPPED_PK_B_VALUES) ? sizeof(libff::G2<ppT>)
+                                      : sizeof(libff::G1<ppT>);
+            if (s.offset > file_size || s.count > (file_size - s.offset) / element_size)
+            {
+                throw std::runtime_error("Mapped proving key: section out of bounds");
+            }
+        }
+    }
+    catch (...) {
+#ifndef _WIN32
+        ::close(m_fd);
+#endif
+        throw;
+    }
+
+#if !defined(_WIN32) && defined(POSIX_FADV_SEQUENTIAL)
+    ::posix_fadvise(m_fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+}
+
+
+template<typename ppT>
+r1cs_gg_ppzksnark_zok_proving_key_stream<ppT>::~r1cs_gg_ppzksnark_zok_proving_key_stream()
+{
+#ifndef _WIN32
+    ::close(m_fd);
+#endif
+}
+
+
+template<typename ppT>
+void r1cs_gg_ppzksnark_zok_proving_key_stream<ppT>::read_bytes(uint64_t offset, size_t size, void* dst) const
+{
+#ifdef _WIN32
+    std::lock_guard<std::mutex> lock(m_file_mutex);
+    m_file.clear();
+    m_file.seekg(offset);
+    if (!m_file.read(static_cast<char*>(dst), size))
+    {
+        throw std::runtime_error("Cannot read file: " + m_path);
+    }
+#else
+    auto* out = static_cast<uint8_t*>(dst);
+    while (size > 0)
+    {
+        const ssize_t n = ::pread(m_fd, out, size, offset);
+        if (n < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (n <= 0)
+        {
+            throw std::runtime_error("Cannot read file: " + m_path);
+        }
+        out += n;
+        offset += n;
+        size -= n;
+    }
+#endif
+}
+
+
+/**
+* Once a chunk has been copied into a buffer its pages aren't needed again
+* during this pass, drop them so streaming a large key doesn't push
+* everything else out of the page cache
+*/
+template<typename ppT>
+void r1cs_gg_ppzksnark_zok_proving_key_stream<ppT>::release_bytes(uint64_t offset, size_t size) const
+{
+#if !defined(_WIN32) && defined(POSIX_FADV_DONTNEED)
+    ::posix_fadvise(m_fd, offset, size, POSIX_FADV_DONTNEED);
+#else
+    libff::UNUSED(offset, size);
+#endif
+}
+
+
+template<typename ppT>
+template<typename T>
+void r1cs_gg_ppzksnark_zok_proving_key_stream<ppT>::read(mapped_pk_section_id id, size_t first, size_t count, T* dst) const
+{
+    const auto& s = m_header.sections[id];
+    if (first > s.count || count > s.count - first)
+    {
+        throw std::runtime_error("Mapped proving key: read out of bounds");
+    }
+    const uint64_t offset = s.offset + (first * sizeof(T));
+    read_bytes(offset, count * sizeof(T), dst);
+    release_bytes(offset, count * sizeof(T));
+}
+
+
+template<typename ppT>
+template<typename T, typename Fn>
+void r1cs_gg_ppzksnark_zok_proving_key_stream<ppT>::stream_query(mapped_pk_section_id values_id, mapped_pk_section_id indices_id, size_t chunk_size, Fn fn) const
+{
+    const bool sparse = indices_id != MAPPED_PK_NUM_SECTIONS;
+    const size_t total = count(values_id);
+    if (total == 0)
+    {
+        return;
+    }
+    chunk_size = std::min(std::max<size_t>(chunk_size, 1), total);
+
+    std::vector<T> values[2];
+    std::vector<size_t> indices[2];
+    for (size_t b = 0; b < 2; b++)
+    {
+        values[b].resize(chunk_size);
+        if (sparse)
+        {
+            indices[b].resize(chunk_size);
+        }
+    }
+
+    auto load = [&](size_t b, size_t begin, size_t n) {
+        read(values_id, begin, n, values[b].data());
+        if (sparse)
+        {
+            read(indices_id, begin, n, indices[b].data());
+        }
+    };
+
+    load(0, 0, chunk_size);
+    size_t current = 0;
+    for (size_t begin = 0; begin < total; begin += chunk_size, current ^= 1)
+    {
+        const size_t n = std::min(chunk_size, total - begin);
+        const size_t next_begin = begin + n;
+
+        // Read the next chunk into the other buffer while this one is used
+        std::future<void> next;
+        if (next_begin < total)
+        {
+            next = std::async(std::launch::async, load, current ^ 1, next_begin, std::min(chunk_size, total - next_begin));
+        }
+
+        fn(values[current].data(), sparse ? indices[current].data() : nullptr, begin, n);
+
+        if (next.valid())
+        {
+            next.get();
+        }
+    }
+}
+
+
+} // libsnark
+
+#endif
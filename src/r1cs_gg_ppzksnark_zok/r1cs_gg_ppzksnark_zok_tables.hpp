@@ -0,0 +1,114 @@
+#ifndef ETHSNARKS_R1CS_GG_PPZKSNARK_ZOK_TABLES_HPP_
+#define ETHSNARKS_R1CS_GG_PPZKSNARK_ZOK_TABLES_HPP_
+
+#include <cstdint>
+#include <string>
+
+#include "r1cs_gg_ppzksnark_zok/r1cs_gg_ppzksnark_zok_mmap.hpp"
+
+namespace libsnark {
+
+/**
+* Precomputed fixed-base tables for the H and L queries
+*
+* The exponents are split into W signed windows of c bits. For an expansion
+* factor E each base P is stored E times, as P * 2^(k*s*c) for k in [0, E)
+* where s = ceil(W/E). Digit `k*s + j` of an exponent then selects a bucket
+* for the k'th multiple in round j, so all E multiples share one set of
+* buckets and the accumulator is only doubled between the s rounds. With
+* E = W there is a single round and no doublings at all.
+*
+* The tables are E times the size of the H and L queries, they are written
+* by an offline step to a file next to the proving key and memory mapped.
+* The prover refuses tables which don't match its key (see `matches`).
+*
+*   header
+*   [H table]   G1[E * H count], k-major: table[k * count + i]
+*   [L table]   G1[E * L count]
+*/
+
+static const char PRECOMPUTED_TABLES_MAGIC[8] = {'E', 'S', 'P', 'K', 'T', 'B', 'L', '\0'};
+static const uint32_t PRECOMPUTED_TABLES_VERSION = 1;
+
+struct precomputed_tables_header
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint32_t G1_size;
+    uint32_t window_bits;       // c
+    uint32_t expansion;         // E, multiples stored per base
+    uint32_t round_windows;     // s, windows covered by each multiple
+    uint64_t H_count;
+    uint64_t L_count;
+    uint64_t H_offset;
+    uint64_t L_offset;
+    uint64_t file_size;
+};
+
+
+/**
+* Memory mapped precomputed tables, see above.
+*
+* Throws `std::runtime_error` if the file cannot be opened or does not match
+* the format expected by this build.
+*/
+template<typename ppT>
+class r1cs_gg_ppzksnark_zok_precomputed_tables {
+public:
+    array_view<libff::G1<ppT>> H_table;
+    array_view<libff::G1<ppT>> L_table;
+    size_t window_bits;
+    size_t expansion;
+    size_t round_windows;
+
+    explicit r1cs_gg_ppzksnark_zok_precomputed_tables(const std::string& path);
+
+    size_t H_count() const { return H_table.size() / expansion; }
+    size_t L_count() const { return L_table.size() / expansion; }
+
+    /**
+    * Whether the tables were computed from the H and L queries of `pk`.
+    *
+    * The first multiples in the tables are the bases themselves, so besides
+    * the counts they are compared with the key at evenly spaced positions.
+    * A key generated again has different bases everywhere, so a file left
+    * over from a previous key doesn't match.
+    */
+    template<typename ProvingKeyT>
+    bool matches(const ProvingKeyT& pk) const;
+
+    void prefetch() const
+    {
+        file.prefetch();
+    }
+
+private:
+    mapped_file file;
+};
+
+
+/**
+* Where the tables for a proving key are stored, next to the key
+*/
+inline std::string precomputed_tables_path(const std::string& pk_path)
+{
+    return pk_path + ".tables";
+}
+
+
+/**
+* Write the precomputed tables for the H and L queries of a proving key
+*
+* `expansion` is the number of multiples stored per base (clamped to the
+* number of windows), `window_bits` of 0 picks a window size from the
+* number of bases per thread.
+*/
+template<typename ppT, typename ProvingKeyT>
+bool write_precomputed_tables(const ProvingKeyT& pk, const std::string& path, size_t expansion, size_t window_bits = 0);
+
+} // libsnark
+
+#include "r1cs_gg_ppzksnark_zok/r1cs_gg_ppzksnark_zok_tables.tcc"
+
+#endif
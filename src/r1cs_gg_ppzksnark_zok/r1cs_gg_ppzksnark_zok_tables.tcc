@@ -0,0 +1,177 @@
+#ifndef ETHSNARKS_R1CS_GG_PPZKSNARK_ZOK_TABLES_TCC_
+#define ETHSNARKS_R1CS_GG_PPZKSNARK_ZOK_TABLES_TCC_
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+
+#include <libff/algebra/scalar_multiplication/multiexp.hpp>
+
+#include "r1cs_gg_ppzksnark_zok/multiexp.hpp"
+
+namespace libsnark {
+
+
+/**
+* Write `expansion` blocks of multiples of the bases, each block being the
+* previous one doubled `shift` times
+*/
+template<typename T>
+static void precomputed_tables_write_query(std::ofstream& out, const T* bases, size_t count, size_t expansion, size_t shift, const Config& config)
+{
+    std::vector<T> multiples(bases, bases + count);
+    for (size_t k = 0; k < expansion; k++)
+    {
+        if (k > 0)
+        {
+#ifdef MULTICORE
+            #pragma omp parallel for num_threads(config.num_threads)
+#endif
+            for (size_t i = 0; i < count; i++)
+            {
+                for (size_t d = 0; d < shift; d++)
+                {
+                    multiples[i] = multiples[i].dbl();
+                }
+            }
+        }
+
+        libff::batch_to_special(multiples);
+        out.write(reinterpret_cast<const char*>(multiples.data()), count * sizeof(T));
+    }
+}
+
+
+template<typename ppT, typename ProvingKeyT>
+bool write_precomputed_tables(const ProvingKeyT& pk, const std::string& path, size_t expansion, size_t window_bits)
+{
+    typedef libff::G1<ppT> G1;
+
+    const Config config;
+    if (window_bits == 0)
+    {
+        const size_t largest = std::max<size_t>(pk.H_query.size(), pk.L_query.size());
+        window_bits = multi_exp_window_size(largest / std::max(config.num_threads, 1u), config);
+    }
+    const size_t num_windows = multi_exp_num_signed_windows(libff::Fr<ppT>::size_in_bits(), window_bits);
+    expansion = std::max<size_t>(1, std::min(expansion, num_windows));
+    const size_t round_windows = (num_windows + expansion - 1) / expansion;
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out.is_open())
+    {
+        return false;
+    }
+
+    precomputed_tables_header header;
+    ::memset(&header, 0, sizeof(header));
+    ::memcpy(header.magic, PRECOMPUTED_TABLES_MAGIC, sizeof(PRECOMPUTED_TABLES_MAGIC));
+    header.version = PRECOMPUTED_TABLES_VERSION;
+    header.byte_order = MAPPED_PK_BYTE_ORDER;
+    header.G1_size = sizeof(G1);
+    header.window_bits = window_bits;
+    header.expansion = expansion;
+    header.round_windows = round_windows;
+    header.H_count = pk.H_query.size();
+    header.L_count = pk.L_query.size();
+
+    const size_t shift = round_windows * window_bits;
+
+    header.H_offset = mapped_pk_align(sizeof(header));
+    out.seekp(header.H_offset);
+    precomputed_tables_write_query(out, pk.H_query.data(), header.H_count, expansion, shift, config);
+
+    header.L_offset = mapped_pk_align(header.H_offset + (expansion * header.H_count * sizeof(G1)));
+    out.seekp(header.L_offset);
+    precomputed_tables_write_query(out, pk.L_query.data(), header.L_count, expansion, shift, config);
+
+    header.file_size = header.L_offset + (expansion * header.L_count * sizeof(G1));
+
+    out.seekp(0);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.flush();
+    return out.good();
+}
+
+
+template<typename ppT>
+r1cs_gg_ppzksnark_zok_precomputed_tables<ppT>::r1cs_gg_ppzksnark_zok_precomputed_tables(const std::string& path) :
+    file(path)
+{
+    const auto& h = *file.at<precomputed_tables_header>(0, 1);
+
+    const char* error = nullptr;
+    if (0 != ::memcmp(h.magic, PRECOMPUTED_TABLES_MAGIC, sizeof(PRECOMPUTED_TABLES_MAGIC)))
+    {
+        error = "Precomputed tables: bad magic";
+    }
+    else if (h.version != PRECOMPUTED_TABLES_VERSION)
+    {
+        error = "Precomputed tables: unsupported version";
+    }
+    else if (h.byte_order != MAPPED_PK_BYTE_ORDER)
+    {
+        error = "Precomputed tables: byte order mismatch";
+    }
+    else if (h.G1_size != sizeof(libff::G1<ppT>))
+    {
+        error = "Precomputed tables: element size does not match this build";
+    }
+    else if (h.window_bits == 0 || h.window_bits > 30 || h.expansion == 0
+          || (h.expansion * h.round_windows) < multi_exp_num_signed_windows(libff::Fr<ppT>::size_in_bits(), h.window_bits))
+    {
+        error = "Precomputed tables: invalid window parameters";
+    }
+    if (error)
+    {
+        throw std::runtime_error(error);
+    }
+
+    window_bits = h.window_bits;
+    expansion = h.expansion;
+    round_windows = h.round_windows;
+    H_table = array_view<libff::G1<ppT>>(file.at<libff::G1<ppT>>(h.H_offset, h.expansion * h.H_count), h.expansion * h.H_count);
+    L_table = array_view<libff::G1<ppT>>(file.at<libff::G1<ppT>>(h.L_offset, h.expansion * h.L_count), h.expansion * h.L_count);
+}
+
+
+/**
+* Compare the first `count` entries of `table` with `query` at about 64
+* positions, including the first and the last
+*/
+template<typename T, typename QueryT>
+static bool precomputed_tables_sample_matches(const array_view<T>& table, const QueryT& query, size_t count)
+{
+    const size_t num_samples = 64;
+    if (count == 0)
+    {
+        return true;
+    }
+
+    const size_t step = std::max<size_t>(1, count / num_samples);
+    for (size_t i = 0; i < count; i += step)
+    {
+        if (!(table[i] == query[i]))
+        {
+            return false;
+        }
+    }
+    return table[count - 1] == query[count - 1];
+}
+
+
+template<typename ppT>
+template<typename ProvingKeyT>
+bool r1cs_gg_ppzksnark_zok_precomputed_tables<ppT>::matches(const ProvingKeyT& pk) const
+{
+    return H_count() == pk.H_query.size()
+        && L_count() == pk.L_query.size()
+        && precomputed_tables_sample_matches(H_table, pk.H_query, H_count())
+        && precomputed_tables_sample_matches(L_table, pk.L_query, L_count());
+}
+
+} // libsnark
+
+#endif
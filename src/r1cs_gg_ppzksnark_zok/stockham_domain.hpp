@@ -0,0 +1,445 @@
+#ifndef ETHSNARKS_STOCKHAM_DOMAIN_HPP_
+#define ETHSNARKS_STOCKHAM_DOMAIN_HPP_
+
+#include <algorithm>
+#include <cassert>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+#include <libff/algebra/fields/field_utils.hpp>
+#include <libff/common/utils.hpp>
+#include <libfqfft/evaluation_domain/evaluation_domain.hpp>
+
+#ifdef MULTICORE
+#include <omp.h>
+#endif
+
+#include "prover_config.hpp"
+
+namespace libsnark {
+
+/**
+* Power of two evaluation domain using a mixed radix 2/4/8 Stockham NTT.
+*
+* The domain elements are the powers of the same root of unity as
+* `basic_radix2_domain`, so the two are interchangeable.
+*
+* Each stage reads from one buffer and writes to the other in an order
+* where the output ends up sorted, so there is no bit-reversal pass, and
+* the radix 4 and 8 stages make half or a third of the passes over memory
+* of a radix 2 transform. The stages are split between the threads of a
+* single parallel region.
+*
+* The twiddle factors for a domain size are computed once and shared by all
+* domains of that size: omega^i for i < m/2, with the other half given by
+* omega^(m/2) = -1. The stages run out of place, the scratch buffers are
+* kept for reuse and transforms on different vectors may run concurrently.
+*
+* The stage radixes are taken from `Config::radixes` when they are all 2, 4
+* or 8 and their product is the domain size, otherwise radix 4 is used
+* with one radix 8 (or 2) stage for odd powers of two.
+*/
+template<typename FieldT>
+class stockham_domain : public libfqfft::evaluation_domain<FieldT> {
+public:
+    stockham_domain(const size_t m, const Config& config = Config());
+
+    void FFT(std::vector<FieldT> &a);
+    void iFFT(std::vector<FieldT> &a);
+    void cosetFFT(std::vector<FieldT> &a, const FieldT &g);
+    void icosetFFT(std::vector<FieldT> &a, const FieldT &g);
+    std::vector<FieldT> evaluate_all_lagrange_polynomials(const FieldT &t);
+    FieldT get_domain_element(const size_t idx);
+    FieldT compute_vanishing_polynomial(const FieldT &t);
+    void add_poly_Z(const FieldT &coeff, std::vector<FieldT> &H);
+    void divide_by_Z_on_coset(std::vector<FieldT> &P);
+
+    const std::vector<size_t>& radixes() const { return m_radixes; }
+
+private:
+    Config m_config;
+    FieldT m_omega;
+    std::vector<size_t> m_radixes;
+    std::shared_ptr<const std::vector<FieldT>> m_twiddles;
+
+    std::mutex m_scratch_mutex;
+    std::vector<std::vector<FieldT>> m_scratch;
+
+    /** omega^i for i < m */
+    FieldT twiddle(size_t i) const;
+
+    void transform(std::vector<FieldT> &a);
+    void scale_by_powers(std::vector<FieldT> &a, const FieldT &g) const;
+
+    static std::shared_ptr<const std::vector<FieldT>> get_twiddles(size_t m, const FieldT &omega, const Config& config);
+};
+
+
+template<typename FieldT>
+stockham_domain<FieldT>::stockham_domain(const size_t m, const Config& config) :
+    libfqfft::evaluation_domain<FieldT>(m),
+    m_config(config)
+{
+    if (m < 1 || (m & (m - 1)) != 0)
+    {
+        throw std::invalid_argument("stockham_domain: size must be a power of two");
+    }
+    m_omega = libff::get_root_of_unity<FieldT>(m);
+
+    size_t product = 1;
+    for (const auto r : config.radixes)
+    {
+        product *= r;
+        if (r != 2 && r != 4 && r != 8)
+        {
+            product = 0;
+            break;
+        }
+    }
+    if (!config.radixes.empty() && product == m)
+    {
+        m_radixes.assign(config.radixes.begin(), config.radixes.end());
+    }
+    else
+    {
+        size_t bits = libff::log2(m);
+        if (bits % 2 == 1)
+        {
+            m_radixes.emplace_back(bits >= 3 ? 8 : 2);
+            bits -= bits >= 3 ? 3 : 1;
+        }
+        for (; bits > 0; bits -= 2)
+        {
+            m_radixes.emplace_back(4);
+        }
+    }
+
+    m_twiddles = get_twiddles(m, m_omega, config);
+}
+
+
+template<typename FieldT>
+std::shared_ptr<const std::vector<FieldT>> stockham_domain<FieldT>::get_twiddles(size_t m, const FieldT &omega, const Config& config)
+{
+    static std::mutex mutex;
+    static std::map<size_t, std::shared_ptr<const std::vector<FieldT>>> cache;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto& entry = cache[m];
+    if (!entry)
+    {
+        std::vector<FieldT> powers(std::max<size_t>(m / 2, 1));
+        const auto ranges = get_cpu_ranges(0, powers.size(), config.num_threads);
+#ifdef MULTICORE
+        #pragma omp parallel for num_threads(ranges.size())
+#endif
+        for (size_t r = 0; r < ranges.size(); r++)
+        {
+            FieldT w = omega ^ ranges[r].first;
+            for (size_t i = ranges[r].first; i < ranges[r].second; i++)
+            {
+                powers[i] = w;
+                w *= omega;
+            }
+        }
+        entry = std::make_shared<const std::vector<FieldT>>(std::move(powers));
+    }
+    return entry;
+}
+
+
+template<typename FieldT>
+FieldT stockham_domain<FieldT>::twiddle(size_t i) const
+{
+    const auto& t = *m_twiddles;
+    return i < t.size() ? t[i] : -t[i - t.size()];
+}
+
+
+template<typename FieldT>
+void stockham_domain<FieldT>::transform(std::vector<FieldT> &a)
+{
+    const size_t m = this->m;
+    if (a.size() != m)
+    {
+        throw std::invalid_argument("stockham_domain: vector size does not match the domain");
+    }
+    if (m == 1)
+    {
+        return;
+    }
+
+    std::vector<FieldT> scratch;
+    {
+        std::lock_guard<std::mutex> lock(m_scratch_mutex);
+        if (!m_scratch.empty())
+        {
+            scratch.swap(m_scratch.back());
+            m_scratch.pop_back();
+        }
+    }
+    scratch.resize(m);
+
+    const FieldT w4 = twiddle(m / 4 * (m >= 4));
+    const FieldT w8 = m >= 8 ? twiddle(m / 8) : FieldT::one();
+    const FieldT w8_3 = m >= 8 ? twiddle(3 * (m / 8)) : FieldT::one();
+    const std::vector<size_t>& radixes = m_radixes;
+
+    FieldT* x = a.data();
+    FieldT* y = scratch.data();
+
+#ifdef MULTICORE
+    #pragma omp parallel num_threads(m_config.num_threads)
+#endif
+    {
+        FieldT* in = x;
+        FieldT* out = y;
+        size_t n = m;       // length of the sub-transforms of this stage
+        size_t s = 1;       // stride between their elements
+
+        for (const size_t r : radixes)
+        {
+            const size_t mm = n / r;
+            const size_t step = m / n;  // omega_n = omega^step
+
+#ifdef MULTICORE
+            #pragma omp for collapse(2) schedule(static)
+#endif
+            for (size_t p = 0; p < mm; p++)
+            {
+                for (size_t q = 0; q < s; q++)
+                {
+                    const FieldT* src = in + q + (s * p);
+                    FieldT* dst = out + q + (s * r * p);
+                    const size_t sm = s * mm;
+
+                    if (r == 2)
+                    {
+                        const FieldT a0 = src[0];
+                        const FieldT a1 = src[sm];
+                        dst[0] = a0 + a1;
+                        dst[s] = (a0 - a1) * twiddle(step * p);
+                    }
+                    else if (r == 4)
+                    {
+                        const FieldT a0 = src[0];
+                        const FieldT a1 = src[sm];
+                        const FieldT a2 = src[2 * sm];
+                        const FieldT a3 = src[3 * sm];
+                        const FieldT apc = a0 + a2;
+                        const FieldT amc = a0 - a2;
+                        const FieldT bpd = a1 + a3;
+                        const FieldT wbmd = w4 * (a1 - a3);
+                        dst[0] = apc + bpd;
+                        if (p == 0)
+                        {
+                            dst[s] = amc + wbmd;
+                            dst[2 * s] = apc - bpd;
+                            dst[3 * s] = amc - wbmd;
+                        }
+                        else
+                        {
+                            dst[s] = (amc + wbmd) * twiddle(step * p);
+                            dst[2 * s] = (apc - bpd) * twiddle(step * p * 2);
+                            dst[3 * s] = (amc - wbmd) * twiddle(step * p * 3);
+                        }
+                    }
+                    else
+                    {
+                        // Two 4-point transforms of the even and odd elements
+                        const FieldT e0 = src[0] + src[4 * sm];
+                        const FieldT e1 = src[0] - src[4 * sm];
+                        const FieldT e2 = src[2 * sm] + src[6 * sm];
+                        const FieldT e3 = w4 * (src[2 * sm] - src[6 * sm]);
+                        const FieldT o0 = src[sm] + src[5 * sm];
+                        const FieldT o1 = src[sm] - src[5 * sm];
+                        const FieldT o2 = src[3 * sm] + src[7 * sm];
+                        const FieldT o3 = w4 * (src[3 * sm] - src[7 * sm]);
+
+                        const FieldT E[4] = {e0 + e2, e1 + e3, e0 - e2, e1 - e3};
+                        const FieldT O[4] = {o0 + o2, w8 * (o1 + o3), w4 * (o0 - o2), w8_3 * (o1 - o3)};
+
+                        for (size_t k = 0; k < 4; k++)
+                        {
+                            const FieldT lo = E[k] + O[k];
+                            const FieldT hi = E[k] - O[k];
+                            dst[k * s] = (p == 0 || k == 0) ? lo : lo * twiddle(step * p * k);
+                            dst[(k + 4) * s] = p == 0 ? hi : hi * twiddle(step * p * (k + 4));
+                        }
+                    }
+                }
+            }
+
+            std::swap(in, out);
+            n = mm;
+            s *= r;
+        }
+    }
+
+    // After an odd number of stages the result is in the scratch buffer
+    if (radixes.size() % 2 == 1)
+    {
+        a.swap(scratch);
+    }
+
+    std::lock_guard<std::mutex> lock(m_scratch_mutex);
+    m_scratch.emplace_back(std::move(scratch));
+}
+
+
+template<typename FieldT>
+void stockham_domain<FieldT>::scale_by_powers(std::vector<FieldT> &a, const FieldT &g) const
+{
+    const auto ranges = get_cpu_ranges(0, a.size(), m_config.num_threads);
+#ifdef MULTICORE
+    #pragma omp parallel for num_threads(ranges.size())
+#endif
+    for (size_t r = 0; r < ranges.size(); r++)
+    {
+        FieldT u = g ^ ranges[r].first;
+        for (size_t i = ranges[r].first; i < ranges[r].second; i++)
+        {
+            a[i] *= u;
+            u *= g;
+        }
+    }
+}
+
+
+template<typename FieldT>
+void stockham_domain<FieldT>::FFT(std::vector<FieldT> &a)
+{
+    transform(a);
+}
+
+
+/**
+* The inverse transform is the forward transform with the outputs 1..m-1
+* reversed, the reversal is done along with the scaling by 1/m
+*/
+template<typename FieldT>
+void stockham_domain<FieldT>::iFFT(std::vector<FieldT> &a)
+{
+    transform(a);
+
+    const size_t m = this->m;
+    const FieldT m_inverse = FieldT(m).inverse();
+    const size_t half = m / 2;
+#ifdef MULTICORE
+    #pragma omp parallel for num_threads(m_config.num_threads)
+#endif
+    for (size_t i = 0; i <= half; i++)
+    {
+        const size_t j = (m - i) % m;
+        if (i == j)
+        {
+            a[i] *= m_inverse;
+        }
+        else
+        {
+            const FieldT t = a[i] * m_inverse;
+            a[i] = a[j] * m_inverse;
+            a[j] = t;
+        }
+    }
+}
+
+
+template<typename FieldT>
+void stockham_domain<FieldT>::cosetFFT(std::vector<FieldT> &a, const FieldT &g)
+{
+    scale_by_powers(a, g);
+    FFT(a);
+}
+
+
+template<typename FieldT>
+void stockham_domain<FieldT>::icosetFFT(std::vector<FieldT> &a, const FieldT &g)
+{
+    iFFT(a);
+    scale_by_powers(a, g.inverse());
+}
+
+
+template<typename FieldT>
+std::vector<FieldT> stockham_domain<FieldT>::evaluate_all_lagrange_polynomials(const FieldT &t)
+{
+    const size_t m = this->m;
+    std::vector<FieldT> u(m, FieldT::zero());
+    if (m == 1)
+    {
+        u[0] = FieldT::one();
+        return u;
+    }
+
+    const FieldT Z = (t ^ m) - FieldT::one();
+    if (Z.is_zero())
+    {
+        // t is an element of the domain
+        FieldT omega_i = FieldT::one();
+        for (size_t i = 0; i < m; i++, omega_i *= m_omega)
+        {
+            if (omega_i == t)
+            {
+                u[i] = FieldT::one();
+                return u;
+            }
+        }
+    }
+
+    /* L_i(t) = (t^m - 1) / m * omega^i / (t - omega^i) */
+    FieldT l = Z * FieldT(m).inverse();
+    FieldT r = FieldT::one();
+    for (size_t i = 0; i < m; i++)
+    {
+        u[i] = l * (t - r).inverse();
+        l *= m_omega;
+        r *= m_omega;
+    }
+    return u;
+}
+
+
+template<typename FieldT>
+FieldT stockham_domain<FieldT>::get_domain_element(const size_t idx)
+{
+    return twiddle(idx % this->m);
+}
+
+
+template<typename FieldT>
+FieldT stockham_domain<FieldT>::compute_vanishing_polynomial(const FieldT &t)
+{
+    return (t ^ this->m) - FieldT::one();
+}
+
+
+template<typename FieldT>
+void stockham_domain<FieldT>::add_poly_Z(const FieldT &coeff, std::vector<FieldT> &H)
+{
+    assert(H.size() == this->m + 1);
+    H[this->m] += coeff;
+    H[0] -= coeff;
+}
+
+
+template<typename FieldT>
+void stockham_domain<FieldT>::divide_by_Z_on_coset(std::vector<FieldT> &P)
+{
+    const FieldT coset = FieldT::multiplicative_generator;
+    const FieldT Z_inverse_at_coset = compute_vanishing_polynomial(coset).inverse();
+#ifdef MULTICORE
+    #pragma omp parallel for num_threads(m_config.num_threads)
+#endif
+    for (size_t i = 0; i < this->m; i++)
+    {
+        P[i] *= Z_inverse_at_coset;
+    }
+}
+
+} // libsnark
+
+#endif
@@ -0,0 +1,464 @@
+#ifndef ETHSNARKS_WITNESS_MAP_HPP_
+#define ETHSNARKS_WITNESS_MAP_HPP_
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+#include <libff/common/profiling.hpp>
+#include <libff/common/utils.hpp>
+#include <libfqfft/evaluation_domain/evaluation_domain.hpp>
+#include <libsnark/relations/constraint_satisfaction_problems/r1cs/r1cs.hpp>
+
+#ifdef MULTICORE
+#include <omp.h>
+#endif
+
+#include "prover_config.hpp"
+
+namespace libsnark {
+
+/**
+* Witness map for the prover: evaluates the constraints over the full
+* variable assignment, then computes the coefficients of
+* H = (A*B - C) / Z using the evaluation domain.
+*
+* The constraint system is copied once into a compact form, where the terms
+* of each of the A, B and C matrices are stored row after row in flat
+* arrays. Evaluating a block of constraints then reads contiguous memory
+* instead of following a pointer (and making a virtual call) per
+* constraint, and blocks are evaluated in parallel.
+*
+* Circuits use few distinct coefficients, mostly 1, -1 and powers of two,
+* so each term only holds the id of its coefficient in a table shared by
+* the three matrices: 8 bytes per term instead of 4 plus a field element.
+* Terms with a coefficient of one skip the multiplication.
+*/
+
+
+/**
+* One of the A, B or C matrices in compressed sparse row form
+*/
+template<typename FieldT>
+struct r1cs_compact_matrix
+{
+    std::vector<size_t> row_offsets;    // num_constraints + 1, terms of row i are [row_offsets[i], row_offsets[i+1])
+    std::vector<uint32_t> indices;
+    std::vector<uint32_t> coeff_ids;    // into r1cs_compact_constraints::coefficients
+};
+
+
+/**
+* Hash of a field element's representation, for finding the distinct
+* coefficients
+*/
+template<typename FieldT>
+struct r1cs_compact_coefficient_hash
+{
+    size_t operator()(const FieldT& x) const
+    {
+        // FNV-1a
+        uint8_t bytes[sizeof(FieldT)];
+        std::memcpy(bytes, &x, sizeof(FieldT));
+        uint64_t hash = 14695981039346656037ULL;
+        for (const auto byte : bytes)
+        {
+            hash = (hash ^ byte) * 1099511628211ULL;
+        }
+        return hash;
+    }
+};
+
+
+/**
+* The constraint system in compact form, see above.
+*
+* Built once per constraint system and kept by the prover context, or
+* loaded directly from a binary R1CS file (`R1CSBinaryFile::load_compact`)
+* without building the constraint objects at all.
+*/
+template<typename FieldT>
+struct r1cs_compact_constraints
+{
+    size_t num_constraints;
+    size_t num_inputs;
+    size_t num_variables;
+    r1cs_compact_matrix<FieldT> A;
+    r1cs_compact_matrix<FieldT> B;
+    r1cs_compact_matrix<FieldT> C;
+    std::vector<FieldT> coefficients;   // the distinct coefficients
+    uint32_t one_id;                    // id of the coefficient 1, or UINT32_MAX
+
+    r1cs_compact_constraints() :
+        num_constraints(0), num_inputs(0), num_variables(0), one_id(UINT32_MAX)
+    { }
+
+    const FieldT& coeff(const r1cs_compact_matrix<FieldT>& matrix, size_t k) const
+    {
+        return coefficients[matrix.coeff_ids[k]];
+    }
+
+    FieldT evaluate(const r1cs_compact_matrix<FieldT>& matrix, size_t row, const FieldT* assignment) const
+    {
+        FieldT sum = FieldT::zero();
+        for (size_t k = matrix.row_offsets[row]; k < matrix.row_offsets[row + 1]; k++)
+        {
+            const uint32_t id = matrix.coeff_ids[k];
+            if (id == one_id)
+            {
+                sum += assignment[matrix.indices[k]];
+            }
+            else
+            {
+                sum += coefficients[id] * assignment[matrix.indices[k]];
+            }
+        }
+        return sum;
+    }
+
+    /** Whether the sizes are those of `cs`, the terms are not compared */
+    bool matches(const r1cs_constraint_system<FieldT>& cs) const
+    {
+        return num_constraints == cs.num_constraints()
+            && num_inputs == cs.num_inputs()
+            && num_variables == cs.num_variables()
+            && A.row_offsets.size() == num_constraints + 1;
+    }
+
+    void build(const r1cs_constraint_system<FieldT>& cs, const Config& config);
+
+    /**
+    * Fill in `coefficients` and the coefficient ids of the matrices from the
+    * coefficient of every term of A, B and C, in the same order as their
+    * indices. The distinct coefficients are found in parallel.
+    */
+    void intern_coefficients(const std::vector<FieldT>* term_coeffs[3], const Config& config);
+};
+
+
+/**
+* Run `fn(begin, end)` over [0, length) in blocks of `block` elements.
+*
+* Outside of a parallel region the blocks are shared between the threads,
+* inside a task (`as_tasks`) they are spawned as a taskloop instead, as a
+* nested parallel region would run on a single thread.
+*/
+template<typename Fn>
+void witness_map_for_blocks(size_t length, size_t block, bool as_tasks, const Config& config, Fn fn)
+{
+    const size_t num_blocks = (length + block - 1) / block;
+    if (as_tasks)
+    {
+#ifdef MULTICORE
+        #pragma omp taskloop grainsize(1)
+#endif
+        for (size_t b = 0; b < num_blocks; b++)
+        {
+            fn(b * block, std::min(length, (b + 1) * block));
+        }
+    }
+    else
+    {
+#ifdef MULTICORE
+        #pragma omp parallel for schedule(dynamic) num_threads(config.num_threads)
+#endif
+        for (size_t b = 0; b < num_blocks; b++)
+        {
+            fn(b * block, std::min(length, (b + 1) * block));
+        }
+    }
+    libff::UNUSED(config);
+}
+
+
+template<typename FieldT>
+void r1cs_compact_constraints<FieldT>::build(const r1cs_constraint_system<FieldT>& cs, const Config& config)
+{
+    libff::enter_block("Compact the constraint system");
+
+    if (cs.num_variables() >= UINT32_MAX)
+    {
+        throw std::runtime_error("Constraint system too large for the compact layout");
+    }
+
+    num_constraints = cs.num_constraints();
+    num_inputs = cs.num_inputs();
+    num_variables = cs.num_variables();
+
+    r1cs_compact_matrix<FieldT>* matrices[3] = {&A, &B, &C};
+    for (auto* matrix : matrices)
+    {
+        matrix->row_offsets.assign(num_constraints + 1, 0);
+    }
+
+    // Count the terms of each row, then fill them in at their offsets
+    const size_t block = 4096;
+    witness_map_for_blocks(num_constraints, block, false, config, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++)
+        {
+            const auto& constraint = cs.constraints[i];
+            A.row_offsets[i + 1] = constraint->getA().getTerms().size();
+            B.row_offsets[i + 1] = constraint->getB().getTerms().size();
+            C.row_offsets[i + 1] = constraint->getC().getTerms().size();
+        }
+    });
+
+    for (auto* matrix : matrices)
+    {
+        for (size_t i = 0; i < num_constraints; i++)
+        {
+            matrix->row_offsets[i + 1] += matrix->row_offsets[i];
+        }
+        matrix->indices.resize(matrix->row_offsets[num_constraints]);
+    }
+
+    std::vector<FieldT> term_coeffs[3];
+    for (size_t j = 0; j < 3; j++)
+    {
+        term_coeffs[j].resize(matrices[j]->indices.size());
+    }
+
+    auto fill = [](r1cs_compact_matrix<FieldT>& matrix, std::vector<FieldT>& coeffs, size_t row, const linear_combination_light<FieldT>& lc) {
+        size_t k = matrix.row_offsets[row];
+        for (const auto& term : lc.getTerms())
+        {
+            matrix.indices[k] = term.index;
+            coeffs[k] = term.getCoeff();
+            k++;
+        }
+    };
+
+    witness_map_for_blocks(num_constraints, block, false, config, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++)
+        {
+            const auto& constraint = cs.constraints[i];
+            fill(A, term_coeffs[0], i, constraint->getA());
+            fill(B, term_coeffs[1], i, constraint->getB());
+            fill(C, term_coeffs[2], i, constraint->getC());
+        }
+    });
+
+    const std::vector<FieldT>* coeffs[3] = {&term_coeffs[0], &term_coeffs[1], &term_coeffs[2]};
+    intern_coefficients(coeffs, config);
+
+    libff::leave_block("Compact the constraint system");
+}
+
+
+template<typename FieldT>
+void r1cs_compact_constraints<FieldT>::intern_coefficients(const std::vector<FieldT>* term_coeffs[3], const Config& config)
+{
+    typedef std::unordered_map<FieldT, uint32_t, r1cs_compact_coefficient_hash<FieldT>> coefficient_map;
+
+    r1cs_compact_matrix<FieldT>* matrices[3] = {&A, &B, &C};
+    const size_t block = size_t(1) << 16;
+
+    // Each block of terms finds its own distinct coefficients, with ids local to the block
+    std::vector<std::vector<FieldT>> block_coefficients[3];
+    for (size_t j = 0; j < 3; j++)
+    {
+        const size_t num_terms = term_coeffs[j]->size();
+        matrices[j]->coeff_ids.resize(num_terms);
+        block_coefficients[j].resize((num_terms + block - 1) / block);
+
+        witness_map_for_blocks(num_terms, block, false, config, [&](size_t begin, size_t end) {
+            coefficient_map local;
+            auto& distinct = block_coefficients[j][begin / block];
+            for (size_t k = begin; k < end; k++)
+            {
+                const FieldT& coeff = (*term_coeffs[j])[k];
+                auto it = local.find(coeff);
+                if (it == local.end())
+                {
+                    it = local.emplace(coeff, distinct.size()).first;
+                    distinct.emplace_back(coeff);
+                }
+                matrices[j]->coeff_ids[k] = it->second;
+            }
+        });
+    }
+
+    // Merge the blocks' coefficients into one table, then renumber the ids
+    coefficient_map global;
+    coefficients.clear();
+    std::vector<std::vector<uint32_t>> block_ids[3];
+    for (size_t j = 0; j < 3; j++)
+    {
+        block_ids[j].resize(block_coefficients[j].size());
+        for (size_t b = 0; b < block_coefficients[j].size(); b++)
+        {
+            for (const auto& coeff : block_coefficients[j][b])
+            {
+                auto it = global.find(coeff);
+                if (it == global.end())
+                {
+                    if (coefficients.size() >= UINT32_MAX)
+                    {
+                        throw std::runtime_error("Too many distinct coefficients for the compact layout");
+                    }
+                    it = global.emplace(coeff, coefficients.size()).first;
+                    coefficients.emplace_back(coeff);
+                }
+                block_ids[j][b].emplace_back(it->second);
+            }
+        }
+
+        witness_map_for_blocks(matrices[j]->coeff_ids.size(), block, false, config, [&](size_t begin, size_t end) {
+            const auto& ids = block_ids[j][begin / block];
+            for (size_t k = begin; k < end; k++)
+            {
+                matrices[j]->coeff_ids[k] = ids[matrices[j]->coeff_ids[k]];
+            }
+        });
+    }
+
+    const auto one = global.find(FieldT::one());
+    one_id = one == global.end() ? UINT32_MAX : one->second;
+
+    libff::print_indent(); printf("* Distinct coefficients: %zu\n", coefficients.size());
+}
+
+
+/**
+* Multiply a[begin, end) by g^i, each block starts from its own power of g
+* so the blocks are independent
+*/
+template<typename FieldT>
+void witness_map_scale_by_powers(FieldT* a, const FieldT& g, size_t begin, size_t end)
+{
+    FieldT u = g ^ begin;
+    for (size_t i = begin; i < end; i++)
+    {
+        a[i] *= u;
+        u *= g;
+    }
+}
+
+
+/**
+* Computes the coefficients of H into `aH`, which ends up with domain->m + 1
+* elements. `aA` and `aB` are used as scratch space, all three are resized
+* as necessary so they can be reused between proofs.
+*
+* When `as_tasks` is set this is being run as an OpenMP task: the blocks
+* of each step are spawned as a taskloop and the three transforms of A, B
+* and C as concurrent tasks, so the other threads of the team can pick up
+* multi-exponentiation work in between.
+*/
+template<typename FieldT>
+void r1cs_to_qap_witness_map_compact(const std::shared_ptr<libfqfft::evaluation_domain<FieldT>>& domain,
+                                     const r1cs_compact_constraints<FieldT>& cs,
+                                     const std::vector<FieldT>& full_variable_assignment,
+                                     std::vector<FieldT>& aA,
+                                     std::vector<FieldT>& aB,
+                                     std::vector<FieldT>& aH,
+                                     bool as_tasks,
+                                     const Config& config)
+{
+    libff::enter_block("Call to r1cs_to_qap_witness_map_compact");
+
+    const size_t m = domain->m;
+    const size_t block = 4096;
+    const FieldT* assignment = full_variable_assignment.data();
+    const FieldT zero = FieldT::zero();
+
+    aA.resize(m);
+    aB.resize(m);
+    aH.resize(m);
+    FieldT* pA = aA.data();
+    FieldT* pB = aB.data();
+    FieldT* pC = aH.data();
+
+    libff::enter_block("Compute evaluation of polynomials A, B, C on set S");
+    witness_map_for_blocks(m, block, as_tasks, config, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++)
+        {
+            if (i < cs.num_constraints)
+            {
+                pA[i] = cs.evaluate(cs.A, i, assignment);
+                pB[i] = cs.evaluate(cs.B, i, assignment);
+                pC[i] = cs.evaluate(cs.C, i, assignment);
+            }
+            else
+            {
+                /* account for the additional constraints input_i * 0 = 0 */
+                const size_t input = i - cs.num_constraints;
+                pA[i] = input <= cs.num_inputs ? assignment[input] : zero;
+                pB[i] = zero;
+                pC[i] = zero;
+            }
+        }
+    });
+    libff::leave_block("Compute evaluation of polynomials A, B, C on set S");
+
+    // Interpolate, then evaluate on the coset g*S
+    const FieldT g = FieldT::multiplicative_generator;
+    auto to_coset = [&](std::vector<FieldT>& a) {
+        domain->iFFT(a);
+        FieldT* p = a.data();
+        witness_map_for_blocks(m, block, as_tasks, config, [&](size_t begin, size_t end) {
+            witness_map_scale_by_powers(p, g, begin, end);
+        });
+        domain->FFT(a);
+    };
+
+    libff::enter_block("Compute evaluation of polynomials A, B, C on coset");
+    if (as_tasks)
+    {
+        std::vector<FieldT>* vectors[3] = {&aA, &aB, &aH};
+        for (size_t k = 0; k < 3; k++)
+        {
+#ifdef MULTICORE
+            #pragma omp task firstprivate(k)
+#endif
+            to_coset(*vectors[k]);
+        }
+#ifdef MULTICORE
+        #pragma omp taskwait
+#endif
+    }
+    else
+    {
+        to_coset(aA);
+        to_coset(aB);
+        to_coset(aH);
+    }
+    libff::leave_block("Compute evaluation of polynomials A, B, C on coset");
+
+    // The transforms may have swapped the storage of the vectors
+    pA = aA.data();
+    pB = aB.data();
+    pC = aH.data();
+
+    // Z is constant on the coset, so the division is folded into the combination
+    libff::enter_block("Compute evaluation of polynomial H on coset");
+    const FieldT Z_inverse = domain->compute_vanishing_polynomial(g).inverse();
+    witness_map_for_blocks(m, block, as_tasks, config, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++)
+        {
+            pC[i] = ((pA[i] * pB[i]) - pC[i]) * Z_inverse;
+        }
+    });
+    libff::leave_block("Compute evaluation of polynomial H on coset");
+
+    libff::enter_block("Compute coefficients of polynomial H");
+    domain->iFFT(aH);
+    pC = aH.data();
+    const FieldT g_inverse = g.inverse();
+    witness_map_for_blocks(m, block, as_tasks, config, [&](size_t begin, size_t end) {
+        witness_map_scale_by_powers(pC, g_inverse, begin, end);
+    });
+    aH.resize(m + 1, zero);
+    libff::leave_block("Compute coefficients of polynomial H");
+
+    libff::leave_block("Call to r1cs_to_qap_witness_map_compact");
+}
+
+} // libsnark
+
+#endif
@@ -8,28 +8,39 @@
 #include "utils.hpp"
 #include "import.hpp"
 #include "export.hpp"
+#include "prover_service.hpp"
+#include "verifier_cache.hpp"
 
 #include "r1cs_gg_ppzksnark_zok/r1cs_gg_ppzksnark_zok.hpp"
+#include "r1cs_gg_ppzksnark_zok/r1cs_gg_ppzksnark_zok_generator.hpp"
+#include "r1cs_gg_ppzksnark_zok/stockham_domain.hpp"
 
 namespace ethsnarks {
 
+/**
+* Processed verification keys are kept for the life of the process, so
+* repeated verifications with the same key skip the precomputations
+*/
+static VerifierCache& stub_verifier_cache()
+{
+    static VerifierCache cache;
+    return cache;
+}
+
+
 bool stub_verify( const char *vk_json, const char *proof_json )
 {
     ppT::init_public_params();
 
-    std::stringstream vk_stream;
-    vk_stream << vk_json;
-    auto vk = vk_from_json(vk_stream);
+    return stub_verifier_cache().verify(vk_json, proof_json);
+}
 
-    std::stringstream proof_stream;
-    proof_stream << proof_json;
-    auto proof_pair = proof_from_json(proof_stream);
 
-    auto status = libsnark::r1cs_gg_ppzksnark_zok_verifier_strong_IC <ppT> (vk, proof_pair.first, proof_pair.second);
-    if( status )
-        return true;
+std::vector<bool> stub_verify_batch( const char *vk_json, const std::vector<std::string> &proof_jsons )
+{
+    ppT::init_public_params();
 
-    return false;
+    return stub_verifier_cache().verify_batch(vk_json, proof_jsons);
 }
 
 
@@ -58,15 +69,33 @@ static unsigned int roundUpToNearestPowerOf2(unsigned int v)
     return v;
 }
 
-const std::shared_ptr<libfqfft::evaluation_domain<FieldT>> get_domain ( ProtoboardT& pb, const ethsnarks::ProvingKeyT& proving_key, const libsnark::Config& config )
+size_t get_domain_size ( const ProtoboardT& pb )
 {
     const auto& cs = pb.constraint_system;
+    return roundUpToNearestPowerOf2(cs.num_constraints() + cs.num_inputs() + 1);
+}
+
+size_t get_domain_size ( const CompactConstraintsT& constraints )
+{
+    return roundUpToNearestPowerOf2(constraints.num_constraints + constraints.num_inputs + 1);
+}
+
+const std::shared_ptr<libfqfft::evaluation_domain<FieldT>> get_domain ( ProtoboardT& pb, const libsnark::Config& config )
+{
+    return get_domain(get_domain_size(pb), config);
+}
+
+const std::shared_ptr<libfqfft::evaluation_domain<FieldT>> get_domain ( size_t domain_size, const libsnark::Config& config )
+{
     std::shared_ptr<libfqfft::evaluation_domain<FieldT>> result;
-    unsigned int domain_size = roundUpToNearestPowerOf2(cs.num_constraints() + cs.num_inputs() + 1);
     if (config.fft.compare("basic_radix2") == 0)
     {
         result.reset(new libfqfft::basic_radix2_domain<FieldT>(domain_size));
     }
+    else if (config.fft.compare("stockham") == 0)
+    {
+        result.reset(new libsnark::stockham_domain<FieldT>(domain_size, config));
+    }
     else
     {
         result.reset(new libfqfft::recursive_domain<FieldT>(domain_size, config));
@@ -74,10 +103,42 @@ const std::shared_ptr<libfqfft::evaluation_domain<FieldT>> get_domain ( Protoboa
     return result;
 }
 
-int stub_genkeys_from_pb( ProtoboardT& pb, const char *pk_file, const char *vk_file )
+const std::shared_ptr<libfqfft::evaluation_domain<FieldT>> get_domain ( ProtoboardT& pb, const ethsnarks::ProvingKeyT& proving_key, const libsnark::Config& config )
+{
+    return get_domain(pb, config);
+}
+
+
+std::string stub_prove_from_pb( ProtoboardT& pb, const char *pk_file )
+{
+    ProverService service;
+    return service.prove_json(pk_file, pb);
+}
+
+
+std::string stub_prove_from_compact( const CompactConstraintsT& constraints, const std::vector<FieldT>& values, const char *pk_file )
+{
+    ProverService service;
+    return service.prove_json(pk_file, constraints, values);
+}
+
+
+static ToxicWasteT stub_genkeys_secrets( const char *toxic_waste_file )
+{
+    auto secrets = ToxicWasteT::random();
+    if( toxic_waste_file != nullptr ) {
+        writeToFile<ToxicWasteT>(toxic_waste_file, secrets);
+    }
+    return secrets;
+}
+
+
+int stub_genkeys_from_pb( ProtoboardT& pb, const char *pk_file, const char *vk_file, const char *toxic_waste_file )
 {
     const auto& constraints = pb.constraint_system;
-    auto keypair = libsnark::r1cs_gg_ppzksnark_zok_generator<ppT>(constraints);
+    const auto secrets = stub_genkeys_secrets(toxic_waste_file);
+
+    auto keypair = libsnark::r1cs_gg_ppzksnark_zok_generator<ppT>(constraints, secrets);
     vk2json_file(keypair.vk, vk_file);
 
     auto pk = ProvingKeyT(keypair.pk);
@@ -87,16 +148,69 @@ int stub_genkeys_from_pb( ProtoboardT& pb, const char *pk_file, const char *vk_f
 }
 
 
+int stub_genkeys_from_compact( const CompactConstraintsT& constraints, const char *pk_file, const char *vk_file, const char *toxic_waste_file )
+{
+    const auto secrets = stub_genkeys_secrets(toxic_waste_file);
+
+    auto keypair = libsnark::r1cs_gg_ppzksnark_zok_generator<ppT>(constraints, secrets, libsnark::Config());
+    vk2json_file(keypair.vk, vk_file);
+
+    auto pk = ProvingKeyT(keypair.pk);
+    writeToFile<ProvingKeyT>(pk_file, pk);
+
+    return 0;
+}
+
+
+int stub_genkeys_incremental_from_pb( ProtoboardT& previous_pb, ProtoboardT& pb, const char *toxic_waste_file,
+                                      const char *previous_pk_file, const char *pk_file, const char *vk_file )
+{
+    const auto secrets = loadFromFile<ToxicWasteT>(toxic_waste_file);
+    const auto previous_pk = loadFromFile<ProvingKeyT>(previous_pk_file);
+
+    ProvingKeyT pk;
+    auto vk = libsnark::r1cs_gg_ppzksnark_zok_generator_incremental<ppT>(previous_pb.constraint_system, previous_pk,
+                                                                         pb.constraint_system, secrets, pk, libsnark::Config());
+    vk2json_file(vk, vk_file);
+    writeToFile<ProvingKeyT>(pk_file, pk);
+
+    return 0;
+}
+
+
+int stub_genkeys_mapped_from_pb( ProtoboardT& pb, const char *pk_file, const char *vk_file, size_t memory_budget )
+{
+    libsnark::Config config;
+    config.stream_memory_budget = memory_budget;
+
+    auto vk = libsnark::r1cs_gg_ppzksnark_zok_generator_mapped<ppT>(pb.constraint_system, pk_file, config);
+    vk2json_file(vk, vk_file);
+
+    return 0;
+}
+
+
+int stub_genkeys_mapped_from_compact( const CompactConstraintsT& constraints, const char *pk_file, const char *vk_file, size_t memory_budget )
+{
+    libsnark::Config config;
+    config.stream_memory_budget = memory_budget;
+
+    auto vk = libsnark::r1cs_gg_ppzksnark_zok_generator_mapped<ppT>(constraints, pk_file, config);
+    vk2json_file(vk, vk_file);
+
+    return 0;
+}
+
+
 int stub_main_verify( const char *prog_name, int argc, const char **argv )
 {
     if( argc < 3 )
     {
-        std::cerr << "Usage: " << prog_name << " " << argv[0] << " <vk.json> <proof.json>" << std::endl;
+        std::cerr << "Usage: " << prog_name << " " << argv[0] << " <vk.json> <proof.json> [proof.json ...]" << std::endl;
         return 1;
     }
 
     auto vk_json_file = argv[1];
-    auto proof_json_file = argv[2];
 
     // Read verifying key file
     std::stringstream vk_stream;
@@ -108,27 +222,48 @@ int stub_main_verify( const char *prog_name, int argc, const char **argv )
     vk_stream << vk_input.rdbuf();
     vk_input.close();
 
-    // Read proof file
-    std::stringstream proof_stream;
-    std::ifstream proof_input(proof_json_file);
-    if( ! proof_input ) {
-        std::cerr << "Error: cannot open " << proof_json_file << std::endl;
-        return 2;
+    // Read proof files
+    std::vector<std::string> proof_strs;
+    for( int i = 2; i < argc; i++ )
+    {
+        std::stringstream proof_stream;
+        std::ifstream proof_input(argv[i]);
+        if( ! proof_input ) {
+            std::cerr << "Error: cannot open " << argv[i] << std::endl;
+            return 2;
+        }
+        proof_stream << proof_input.rdbuf();
+        proof_input.close();
+        proof_strs.emplace_back(proof_stream.str());
     }
-    proof_stream << proof_input.rdbuf();
-    proof_input.close();
 
     // Then verify if proof is correct
     auto vk_str = vk_stream.str();
-    auto proof_str = proof_stream.str();
-    if( stub_verify( vk_str.c_str(), proof_str.c_str() ) )
+    if( proof_strs.size() == 1 )
     {
-        return 0;
+        if( stub_verify( vk_str.c_str(), proof_strs[0].c_str() ) )
+        {
+            return 0;
+        }
+
+        std::cerr << "Error: failed to verify proof!" << std::endl;
+
+        return 1;
     }
 
-    std::cerr << "Error: failed to verify proof!" << std::endl;
+    // Several proofs are verified as one batch
+    const auto results = stub_verify_batch( vk_str.c_str(), proof_strs );
+    int status = 0;
+    for( size_t i = 0; i < results.size(); i++ )
+    {
+        if( ! results[i] )
+        {
+            std::cerr << "Error: failed to verify proof " << argv[2 + i] << std::endl;
+            status = 1;
+        }
+    }
 
-    return 1;
+    return status;
 }
 
 
@@ -139,8 +274,9 @@ bool stub_test_proof_verify( const ProtoboardT &in_pb )
 
     auto pk = ProvingKeyT(keypair.pk);
     ProverContextT context(pk);
-    // context.provingKey = keypair.pk;
     context.config = libsnark::Config();
+    context.constraint_system = const_cast<libsnark::r1cs_constraint_system<FieldT>*>(&constraints);
+    context.domain = get_domain(const_cast<ProtoboardT&>(in_pb), context.config);
 
     auto proof = libsnark::r1cs_gg_ppzksnark_zok_prover<ppT>(context, in_pb.values);
 
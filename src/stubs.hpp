@@ -9,16 +9,64 @@ namespace ethsnarks {
 
 bool stub_verify( const char *vk_json, const char *proof_json );
 
+/**
+* Verify several proofs for the same verification key as one batch,
+* returning whether each of them is valid
+*/
+std::vector<bool> stub_verify_batch( const char *vk_json, const std::vector<std::string> &proof_jsons );
+
 int stub_main_verify( const char *prog_name, int argc, const char **argv );
 
 bool stub_test_proof_verify( const ProtoboardT &in_pb );
 
-int stub_genkeys_from_pb( ProtoboardT& pb, const char *pk_file, const char *vk_file );
+/**
+* Generate keys for the protoboard. If `toxic_waste_file` is given the secrets
+* are written to it, so the keys can later be updated incrementally; only do
+* this for trusted development setups.
+*/
+int stub_genkeys_from_pb( ProtoboardT& pb, const char *pk_file, const char *vk_file, const char *toxic_waste_file = nullptr );
+
+/**
+* Generate keys for a constraint system in compact form, e.g. from a binary R1CS
+*/
+int stub_genkeys_from_compact( const CompactConstraintsT& constraints, const char *pk_file, const char *vk_file, const char *toxic_waste_file = nullptr );
+
+/**
+* Regenerate the keys of a modified circuit, reusing the entries of the previous
+* proving key for the variables which did not change.
+*/
+int stub_genkeys_incremental_from_pb( ProtoboardT& previous_pb, ProtoboardT& pb, const char *toxic_waste_file,
+                                      const char *previous_pk_file, const char *pk_file, const char *vk_file );
+
+/**
+* Generate keys, writing the proving key in the mapped format as it is computed.
+* At most `memory_budget` bytes (0 = default) of tables and buffers are used for the queries.
+*/
+int stub_genkeys_mapped_from_pb( ProtoboardT& pb, const char *pk_file, const char *vk_file, size_t memory_budget );
+
+int stub_genkeys_mapped_from_compact( const CompactConstraintsT& constraints, const char *pk_file, const char *vk_file, size_t memory_budget );
 
 ethsnarks::ProvingKeyT load_proving_key( const char *pk_file );
 std::string prove(ProverContextT& context, ProtoboardT& pb);
 
+/**
+* Load a proving key, either `.raw` or memory mapped, and prove the protoboard.
+* Precomputed tables next to the key are used if present.
+*/
+std::string stub_prove_from_pb( ProtoboardT& pb, const char *pk_file );
+
+/**
+* Prove the full assignment `values`, with the constant one first, of a
+* constraint system in compact form
+*/
+std::string stub_prove_from_compact( const CompactConstraintsT& constraints, const std::vector<FieldT>& values, const char *pk_file );
+
+size_t get_domain_size ( const ProtoboardT& pb );
+size_t get_domain_size ( const CompactConstraintsT& constraints );
+
 const std::shared_ptr<libfqfft::evaluation_domain<FieldT>> get_domain ( ProtoboardT& pb, const ethsnarks::ProvingKeyT& proving_key, const libsnark::Config& config );
+const std::shared_ptr<libfqfft::evaluation_domain<FieldT>> get_domain ( ProtoboardT& pb, const libsnark::Config& config );
+const std::shared_ptr<libfqfft::evaluation_domain<FieldT>> get_domain ( size_t domain_size, const libsnark::Config& config );
 
 template<class GadgetT>
 int stub_genkeys( const char *pk_file, const char *vk_file )
@@ -0,0 +1,76 @@
+#include <cstdlib>
+#include <memory>
+
+#include "ethsnarks.hpp"
+#include "r1cs_gg_ppzksnark_zok/stockham_domain.hpp"
+
+#include <libfqfft/evaluation_domain/get_evaluation_domain.hpp>
+
+using ethsnarks::FieldT;
+using ethsnarks::ppT;
+
+using namespace libff;
+
+
+/**
+* Compares the FFT of the basic radix 2, recursive and Stockham domains,
+* over 2^min_log to 2^max_log elements (default 2^16 to 2^26). Each domain
+* does a forward then an inverse transform of the same vector, which must
+* give back the input. The Stockham domain uses the same root of unity as
+* the basic radix 2 domain, so their forward transforms must match too.
+*/
+int main( int argc, char **argv )
+{
+	ppT::init_public_params();
+
+	const size_t min_log = argc > 1 ? atoi(argv[1]) : 16;
+	const size_t max_log = argc > 2 ? atoi(argv[2]) : 26;
+
+	libsnark::Config config;
+
+	for( size_t log_length = min_log; log_length <= max_log; log_length++ )
+	{
+		const size_t length = size_t(1) << log_length;
+		const std::string suffix = " 2^" + std::to_string(log_length);
+
+		std::vector<FieldT> input(length);
+		for( auto& x : input ) {
+			x = FieldT::random_element();
+		}
+
+		std::vector<std::pair<std::string, std::shared_ptr<libfqfft::evaluation_domain<FieldT>>>> domains;
+		domains.emplace_back("basic_radix2", std::make_shared<libfqfft::basic_radix2_domain<FieldT>>(length));
+		domains.emplace_back("recursive", std::make_shared<libfqfft::recursive_domain<FieldT>>(length, config));
+		domains.emplace_back("stockham", std::make_shared<libsnark::stockham_domain<FieldT>>(length, config));
+
+		std::vector<FieldT> expected;
+		for( auto& entry : domains )
+		{
+			std::vector<FieldT> values = input;
+
+			enter_block(entry.first + " FFT" + suffix);
+			entry.second->FFT(values);
+			leave_block(entry.first + " FFT" + suffix);
+
+			if( entry.first == "basic_radix2" ) {
+				expected = values;
+			}
+			else if( entry.first == "stockham" && values != expected ) {
+				std::cerr << "FFT mismatch for " << entry.first << " at 2^" << log_length << std::endl;
+				return 1;
+			}
+
+			enter_block(entry.first + " iFFT" + suffix);
+			entry.second->iFFT(values);
+			leave_block(entry.first + " iFFT" + suffix);
+
+			if( values != input ) {
+				std::cerr << "iFFT mismatch for " << entry.first << " at 2^" << log_length << std::endl;
+				return 1;
+			}
+		}
+	}
+
+	std::cout << "OK\n";
+	return 0;
+}
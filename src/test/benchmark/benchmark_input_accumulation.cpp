@@ -0,0 +1,74 @@
+#include <cstdlib>
+
+#include "ethsnarks.hpp"
+
+#include <libff/common/profiling.hpp>
+
+using ethsnarks::ppT;
+using ethsnarks::FieldT;
+using ethsnarks::G1T;
+
+using namespace libff;
+
+
+/**
+* Compares the input accumulation of the verifier with and without the
+* precomputed tables of the processed verification key, for keys with
+* `min_inputs` to `max_inputs` inputs (default 16 to 1024), doubling each
+* time, `iterations` accumulations each (default 100).
+*/
+int main( int argc, char **argv )
+{
+	ppT::init_public_params();
+
+	const size_t min_inputs = argc > 1 ? atoi(argv[1]) : 16;
+	const size_t max_inputs = argc > 2 ? atoi(argv[2]) : 1024;
+	const size_t iterations = argc > 3 ? atoi(argv[3]) : 100;
+
+	for( size_t num_inputs = min_inputs; num_inputs <= max_inputs; num_inputs *= 2 )
+	{
+		const std::string suffix = " " + std::to_string(num_inputs) + " inputs";
+
+		const auto vk = libsnark::r1cs_gg_ppzksnark_zok_verification_key<ppT>::dummy_verification_key(num_inputs);
+
+		enter_block("Process vk" + suffix);
+		auto pvk = libsnark::r1cs_gg_ppzksnark_zok_verifier_process_vk<ppT>(vk);
+		leave_block("Process vk" + suffix);
+
+		enter_block("Precompute input tables" + suffix);
+		libsnark::r1cs_gg_ppzksnark_zok_verifier_precompute_input_tables<ppT>(pvk);
+		leave_block("Precompute input tables" + suffix);
+
+		std::vector<std::vector<FieldT>> inputs(iterations);
+		for( auto& input : inputs ) {
+			for( size_t i = 0; i < num_inputs; i++ ) {
+				input.emplace_back(FieldT::random_element());
+			}
+		}
+
+		std::vector<G1T> expected;
+		expected.reserve(iterations);
+		enter_block("accumulate_chunk" + suffix);
+		for( const auto& input : inputs ) {
+			expected.emplace_back(vk.gamma_ABC_g1.template accumulate_chunk<FieldT>(input.begin(), input.end(), 0).first);
+		}
+		leave_block("accumulate_chunk" + suffix);
+
+		std::vector<G1T> results;
+		results.reserve(iterations);
+		enter_block("precomputed tables" + suffix);
+		for( const auto& input : inputs ) {
+			results.emplace_back(libsnark::r1cs_gg_ppzksnark_zok_accumulate_input<ppT>(pvk, input));
+		}
+		leave_block("precomputed tables" + suffix);
+
+		if( results != expected ) {
+			std::cerr << "Mismatch with " << num_inputs << " inputs" << std::endl;
+			return 1;
+		}
+	}
+
+	std::cout << "OK\n";
+
+	return 0;
+}
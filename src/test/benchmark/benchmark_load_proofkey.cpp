@@ -5,19 +5,31 @@ using ethsnarks::ppT;
 using ethsnarks::ProvingKeyT;
 using ethsnarks::loadFromFile;
 
+using MappedProvingKeyT = libsnark::r1cs_gg_ppzksnark_zok_proving_key_mapped<ppT>;
+
 
 int main( int argc, char **argv )
 {
 	ppT::init_public_params();
 
 	if( argc < 2 ) {
-		std::cerr << "Usage: " << argv[0] << " <proofkey.raw>\n";
+		std::cerr << "Usage: " << argv[0] << " <proofkey.raw|proofkey.map>\n";
 		return 1;
 	}
 
-	ProvingKeyT pk = loadFromFile<ProvingKeyT>(argv[1]);
+	if( libsnark::is_mapped_proving_key(argv[1]) )
+	{
+		libff::enter_block("Map proving key");
+		MappedProvingKeyT pk(argv[1]);
+		libff::leave_block("Map proving key");
+	}
+	else {
+		libff::enter_block("Load proving key");
+		ProvingKeyT pk = loadFromFile<ProvingKeyT>(argv[1]);
+		libff::leave_block("Load proving key");
+	}
 
     std::cout << "OK\n";
 
 	return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,98 @@
+#include <cstdlib>
+
+#include "ethsnarks.hpp"
+#include "r1cs_gg_ppzksnark_zok/multiexp.hpp"
+
+#include <libff/algebra/scalar_multiplication/multiexp.hpp>
+
+using ethsnarks::ppT;
+using ethsnarks::FieldT;
+using ethsnarks::G1T;
+
+using namespace libff;
+
+
+/**
+* Compares libff's BDLO12 multi-exp against the signed digit bucket method
+* for G1, with affine and projective buckets, over 2^min_log to 2^max_log
+* elements (default 2^20 to 2^24).
+*
+* The scalars are `random` (the default), `bits` (0 or 1, as most of a
+* witness is), or `repeated` (a few distinct values, so the same digits
+* land in the same buckets).
+*/
+int main( int argc, char **argv )
+{
+	ppT::init_public_params();
+
+	const size_t min_log = argc > 1 ? atoi(argv[1]) : 20;
+	const size_t max_log = argc > 2 ? atoi(argv[2]) : 24;
+	const std::string distribution = argc > 3 ? argv[3] : "random";
+	const size_t max_length = size_t(1) << max_log;
+
+	const FieldT repeated[] = {FieldT("3"), FieldT::random_element(), FieldT::random_element(), -FieldT::one()};
+
+	libsnark::Config config;
+
+	enter_block("Generate bases and scalars");
+	std::vector<G1T> bases;
+	std::vector<FieldT> scalars;
+	bases.reserve(max_length);
+	scalars.reserve(max_length);
+	G1T base = G1T::random_element();
+	for( size_t i = 0; i < max_length; i++ ) {
+		bases.emplace_back(base);
+		if( distribution == "bits" ) {
+			scalars.emplace_back(rand() % 2 ? FieldT::one() : FieldT::zero());
+		}
+		else if( distribution == "repeated" ) {
+			scalars.emplace_back(repeated[rand() % 4]);
+		}
+		else {
+			scalars.emplace_back(FieldT::random_element());
+		}
+		base = base + G1T::one();
+	}
+#ifdef USE_MIXED_ADDITION
+	batch_to_special(bases);
+#endif
+	leave_block("Generate bases and scalars");
+
+	std::vector<bigint<FieldT::num_limbs>> scratch_exponents;
+
+	for( size_t log_length = min_log; log_length <= max_log; log_length++ )
+	{
+		const size_t length = size_t(1) << log_length;
+		const std::string suffix = " 2^" + std::to_string(log_length) + ", " + distribution;
+
+		enter_block("BDLO12" + suffix);
+		const auto expected = multi_exp_with_mixed_addition<G1T, FieldT, multi_exp_method_BDLO12>(
+			bases.begin(), bases.begin() + length,
+			scalars.begin(), scalars.begin() + length,
+			scratch_exponents, config);
+		leave_block("BDLO12" + suffix);
+
+		enter_block("pippenger" + suffix);
+		const auto result = libsnark::multi_exp_array<G1T, FieldT>(
+			bases.data(), scalars.data(), length,
+			scratch_exponents, config);
+		leave_block("pippenger" + suffix);
+
+		config.multi_exp_batch_affine = false;
+		enter_block("pippenger, projective buckets" + suffix);
+		const auto result_projective = libsnark::multi_exp_array<G1T, FieldT>(
+			bases.data(), scalars.data(), length,
+			scratch_exponents, config);
+		leave_block("pippenger, projective buckets" + suffix);
+		config.multi_exp_batch_affine = true;
+
+		if( !(result == expected) || !(result_projective == expected) ) {
+			std::cerr << "Mismatch at 2^" << log_length << std::endl;
+			return 1;
+		}
+	}
+
+	std::cout << "OK\n";
+
+	return 0;
+}
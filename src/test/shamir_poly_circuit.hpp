@@ -0,0 +1,60 @@
+#ifndef ETHSNARKS_TEST_SHAMIR_POLY_CIRCUIT_HPP_
+#define ETHSNARKS_TEST_SHAMIR_POLY_CIRCUIT_HPP_
+
+// Copyright (c) 2018 HarryR
+// License: LGPL-3.0+
+
+#include "ethsnarks.hpp"
+#include "utils.hpp"
+
+#include "gadgets/shamir_poly.hpp"
+
+
+namespace ethsnarks {
+
+
+/**
+* The small circuit the prover, key and file format tests share: shamir_poly
+* of `input` with the coefficients `alpha`, the input being the only public
+* input. Without `with_witness` only the variables and constraints are made.
+* Returns the input variable.
+*/
+inline VariableT make_shamir_poly_circuit( ProtoboardT& pb, const FieldT& input, const std::vector<FieldT>& alpha, bool with_witness = true )
+{
+    const VariableT in_input = make_variable(pb, "in_input");
+    pb.set_input_sizes(1);
+
+    const VariableArrayT in_alpha = make_var_array(pb, alpha.size(), "in_alpha");
+
+    shamir_poly the_gadget(pb, in_input, in_alpha, "gadget");
+    the_gadget.generate_r1cs_constraints();
+
+    if( with_witness ) {
+        pb.val(in_input) = input;
+        in_alpha.fill_with_field_elements(pb, alpha);
+        the_gadget.generate_r1cs_witness();
+    }
+
+    return in_input;
+}
+
+
+/**
+* The same circuit with a random input and four random coefficients
+*/
+inline VariableT make_shamir_poly_circuit( ProtoboardT& pb )
+{
+    const std::vector<FieldT> alpha = {
+        FieldT::random_element(), FieldT::random_element(),
+        FieldT::random_element(), FieldT::random_element()
+    };
+
+    return make_shamir_poly_circuit(pb, FieldT::random_element(), alpha);
+}
+
+
+// namespace ethsnarks
+}
+
+// ETHSNARKS_TEST_SHAMIR_POLY_CIRCUIT_HPP_
+#endif
@@ -0,0 +1,92 @@
+// Copyright (c) 2018 HarryR
+// License: LGPL-3.0+
+
+#include "ethsnarks.hpp"
+#include "stubs.hpp"
+#include "r1cs_gg_ppzksnark_zok/r1cs_gg_ppzksnark_zok_batch_verifier.hpp"
+
+#include "shamir_poly_circuit.hpp"
+
+
+using ethsnarks::ppT;
+
+
+namespace ethsnarks {
+
+
+bool test_batch_verifier()
+{
+    const size_t n = 6;
+
+    ProtoboardT key_pb;
+    make_shamir_poly_circuit(key_pb);
+    auto keypair = libsnark::r1cs_gg_ppzksnark_zok_generator<ppT>(key_pb.constraint_system);
+    const ProvingKeyT pk(keypair.pk);
+
+    // Each proof is for different inputs and witness
+    std::vector<PrimaryInputT> primary_inputs;
+    std::vector<ProofT> proofs;
+    for( size_t i = 0; i < n; i++ )
+    {
+        ProtoboardT pb;
+        make_shamir_poly_circuit(pb);
+
+        ProverContextT context(pk);
+        context.constraint_system = &pb.constraint_system;
+        context.domain = get_domain(pb, context.config);
+
+        proofs.emplace_back(libsnark::r1cs_gg_ppzksnark_zok_prover<ppT>(context, pb.values));
+        primary_inputs.emplace_back(pb.primary_input());
+    }
+
+    const libsnark::Config config;
+    const auto all_valid = libsnark::r1cs_gg_ppzksnark_zok_batch_verifier_strong_IC<ppT>(keypair.vk, primary_inputs, proofs, config);
+    if( all_valid != std::vector<bool>(n, true) ) {
+        std::cerr << "Valid batch rejected\n";
+        return false;
+    }
+
+    // Break two proofs, one by its input and one by its C element, and give one the wrong number of inputs
+    std::vector<bool> expected(n, true);
+    primary_inputs[1][0] += FieldT::one();
+    expected[1] = false;
+    proofs[4].g_C = proofs[4].g_C + G1T::one();
+    expected[4] = false;
+    primary_inputs[5].emplace_back(FieldT::one());
+    expected[5] = false;
+
+    const auto results = libsnark::r1cs_gg_ppzksnark_zok_batch_verifier_strong_IC<ppT>(keypair.vk, primary_inputs, proofs, config);
+    if( results != expected ) {
+        std::cerr << "Batch verifier did not find the invalid proofs\n";
+        return false;
+    }
+
+    // Must agree with the single proof verifier
+    for( size_t i = 0; i < n; i++ )
+    {
+        if( libsnark::r1cs_gg_ppzksnark_zok_verifier_strong_IC<ppT>(keypair.vk, primary_inputs[i], proofs[i]) != expected[i] ) {
+            std::cerr << "Single verifier disagrees on proof " << i << "\n";
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// namespace ethsnarks
+}
+
+
+int main( int argc, char **argv )
+{
+    ppT::init_public_params();
+
+    if( ! ethsnarks::test_batch_verifier() )
+    {
+        std::cerr << "FAIL\n";
+        return 1;
+    }
+
+    std::cout << "OK\n";
+    return 0;
+}
@@ -0,0 +1,109 @@
+// Copyright (c) 2018 HarryR
+// License: LGPL-3.0+
+
+#include "ethsnarks.hpp"
+#include "stubs.hpp"
+#include "r1cs_gg_ppzksnark_zok/r1cs_gg_ppzksnark_zok_generator.hpp"
+
+#include "shamir_poly_circuit.hpp"
+
+
+using ethsnarks::ppT;
+
+
+namespace ethsnarks {
+
+
+static void make_circuit( ProtoboardT& pb, const FieldT& input, const std::vector<FieldT>& alpha, bool extended )
+{
+    const VariableT in_input = make_shamir_poly_circuit(pb, input, alpha);
+
+    // The modified circuit squares the input into a new variable
+    if( extended )
+    {
+        const VariableT square = make_variable(pb, input * input, "square");
+        pb.add_r1cs_constraint(ConstraintT(in_input, in_input, square), "input * input = square");
+    }
+}
+
+
+bool test_incremental_keygen()
+{
+    const FieldT input = FieldT::random_element();
+    std::vector<FieldT> alpha = {
+        FieldT::random_element(), FieldT::random_element(),
+        FieldT::random_element(), FieldT::random_element()
+    };
+
+    ProtoboardT previous_pb;
+    make_circuit(previous_pb, input, alpha, false);
+
+    ProtoboardT pb;
+    make_circuit(pb, input, alpha, true);
+    if( ! pb.is_satisfied() ) {
+        std::cerr << "Not satisfied!\n";
+        return false;
+    }
+
+    const auto secrets = ToxicWasteT::random();
+    auto previous_keypair = libsnark::r1cs_gg_ppzksnark_zok_generator<ppT>(previous_pb.constraint_system, secrets);
+    const auto previous_pk = ProvingKeyT(previous_keypair.pk);
+
+    ProvingKeyT pk;
+    auto vk = libsnark::r1cs_gg_ppzksnark_zok_generator_incremental<ppT>(previous_pb.constraint_system, previous_pk,
+                                                                         pb.constraint_system, secrets, pk, libsnark::Config());
+
+    // Must give the same keys as generating them from scratch with the same secrets
+    auto keypair = libsnark::r1cs_gg_ppzksnark_zok_generator<ppT>(pb.constraint_system, secrets);
+    const auto expected_pk = ProvingKeyT(keypair.pk);
+    if( !(vk == keypair.vk)
+     || !(pk.A_query == expected_pk.A_query)
+     || !(pk.B_query == expected_pk.B_query)
+     || pk.H_query != expected_pk.H_query
+     || pk.L_query != expected_pk.L_query
+     || pk.delta_g1 != expected_pk.delta_g1 ) {
+        std::cerr << "Incremental keys differ from full generation\n";
+        return false;
+    }
+
+    ProverContextT context(pk);
+    context.constraint_system = &pb.constraint_system;
+    context.domain = get_domain(pb, context.config);
+
+    auto proof = libsnark::r1cs_gg_ppzksnark_zok_prover<ppT>(context, pb.values);
+    if( ! libsnark::r1cs_gg_ppzksnark_zok_verifier_strong_IC<ppT>(vk, pb.primary_input(), proof) ) {
+        std::cerr << "Proof with incremental keys failed to verify\n";
+        return false;
+    }
+
+    // A key generated with other secrets must be rejected
+    try {
+        ProvingKeyT other_pk;
+        libsnark::r1cs_gg_ppzksnark_zok_generator_incremental<ppT>(previous_pb.constraint_system, previous_pk,
+                                                                   pb.constraint_system, ToxicWasteT::random(), other_pk, libsnark::Config());
+        std::cerr << "Accepted a key generated with other secrets\n";
+        return false;
+    }
+    catch( const std::runtime_error& ) {
+    }
+
+    return true;
+}
+
+// namespace ethsnarks
+}
+
+
+int main( int argc, char **argv )
+{
+    ppT::init_public_params();
+
+    if( ! ethsnarks::test_incremental_keygen() )
+    {
+        std::cerr << "FAIL\n";
+        return 1;
+    }
+
+    std::cout << "OK\n";
+    return 0;
+}
@@ -0,0 +1,81 @@
+// Copyright (c) 2018 HarryR
+// License: LGPL-3.0+
+
+#include "ethsnarks.hpp"
+
+#include <sstream>
+
+
+using ethsnarks::ppT;
+using ethsnarks::FieldT;
+using ethsnarks::G1T;
+using ethsnarks::PrimaryInputT;
+using ethsnarks::ProcessedVerificationKeyT;
+using ethsnarks::VerificationKeyT;
+
+
+static bool test_input_accumulation( size_t num_inputs, size_t table_expansion )
+{
+    const auto vk = VerificationKeyT::dummy_verification_key(num_inputs);
+    auto pvk = libsnark::r1cs_gg_ppzksnark_zok_verifier_process_vk<ppT>(vk);
+    if( ! pvk.gamma_ABC_g1_table.empty() ) {
+        std::cerr << "Tables built without being asked for\n";
+        return false;
+    }
+    libsnark::r1cs_gg_ppzksnark_zok_verifier_precompute_input_tables<ppT>(pvk, table_expansion);
+
+    const bool expect_tables = num_inputs >= libsnark::VERIFIER_INPUT_TABLE_MIN_INPUTS;
+    if( pvk.gamma_ABC_g1_table.empty() == expect_tables ) {
+        std::cerr << "Tables " << (expect_tables ? "missing" : "unexpected") << " for " << num_inputs << " inputs\n";
+        return false;
+    }
+
+    // All inputs, fewer inputs (weak input consistency), and zeros
+    for( size_t length : {num_inputs, num_inputs / 2} )
+    {
+        PrimaryInputT input;
+        for( size_t i = 0; i < length; i++ ) {
+            input.emplace_back(i % 5 == 0 ? FieldT::zero() : FieldT::random_element());
+        }
+        input[0] = -FieldT::one();
+
+        const G1T expected = vk.gamma_ABC_g1.template accumulate_chunk<FieldT>(input.begin(), input.end(), 0).first;
+        if( libsnark::r1cs_gg_ppzksnark_zok_accumulate_input<ppT>(pvk, input) != expected ) {
+            std::cerr << "Wrong accumulation of " << length << " of " << num_inputs << " inputs, expansion " << table_expansion << "\n";
+            return false;
+        }
+    }
+
+    // The tables are kept when the processed key is serialised
+    std::stringstream ss;
+    ss << pvk;
+    ProcessedVerificationKeyT loaded_pvk;
+    ss >> loaded_pvk;
+    if( ! (loaded_pvk == pvk) ) {
+        std::cerr << "Processed key differs after serialisation\n";
+        return false;
+    }
+
+    return true;
+}
+
+
+int main( int argc, char **argv )
+{
+    ppT::init_public_params();
+
+    const std::vector<std::pair<size_t, size_t>> cases = {
+        {4, 0}, {40, 0}, {40, 1}, {40, 3}, {300, 0}, {300, 7}
+    };
+    for( const auto& c : cases )
+    {
+        if( ! test_input_accumulation(c.first, c.second) )
+        {
+            std::cerr << "FAIL\n";
+            return 1;
+        }
+    }
+
+    std::cout << "OK\n";
+    return 0;
+}
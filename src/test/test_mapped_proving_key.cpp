@@ -0,0 +1,156 @@
+// Copyright (c) 2018 HarryR
+// License: LGPL-3.0+
+
+#include <cstdio>
+#include <stdexcept>
+
+#include "ethsnarks.hpp"
+#include "stubs.hpp"
+#include "r1cs_gg_ppzksnark_zok/r1cs_gg_ppzksnark_zok_generator.hpp"
+
+#include "shamir_poly_circuit.hpp"
+
+
+using ethsnarks::ppT;
+
+
+namespace ethsnarks {
+
+
+bool test_mapped_proving_key()
+{
+    ProtoboardT pb;
+    make_shamir_poly_circuit(pb);
+
+    if( ! pb.is_satisfied() ) {
+        std::cerr << "Not satisfied!\n";
+        return false;
+    }
+
+    auto keypair = libsnark::r1cs_gg_ppzksnark_zok_generator<ppT>(pb.constraint_system);
+    auto pk = ProvingKeyT(keypair.pk);
+
+    const char *pk_file = ".test_mapped_proving_key.map";
+    if( ! libsnark::write_proving_key_mapped<ppT>(pk, pk_file) ) {
+        std::cerr << "Cannot write mapped proving key\n";
+        return false;
+    }
+
+    bool ok = libsnark::is_mapped_proving_key(pk_file);
+    if( ok )
+    {
+        MappedProvingKeyT mapped_pk(pk_file);
+
+        ok = mapped_pk.A_query.size() == pk.A_query.size()
+          && mapped_pk.B_query.size() == pk.B_query.size()
+          && mapped_pk.H_query.size() == pk.H_query.size()
+          && mapped_pk.L_query.size() == pk.L_query.size()
+          && mapped_pk.alpha_g1 == pk.alpha_g1
+          && mapped_pk.delta_g2 == pk.delta_g2;
+
+        if( ok )
+        {
+            ProverContextT context(mapped_pk);
+            context.config = libsnark::Config();
+            context.constraint_system = &pb.constraint_system;
+            context.domain = get_domain(pb, context.config);
+
+            auto proof = libsnark::r1cs_gg_ppzksnark_zok_prover<ppT>(context, pb.values);
+            ok = libsnark::r1cs_gg_ppzksnark_zok_verifier_strong_IC<ppT>(keypair.vk, pb.primary_input(), proof);
+
+            // Precomputed tables must give the same proof
+            const auto tables_file = libsnark::precomputed_tables_path(pk_file);
+            if( ok && pk_precompute_tables(pk_file, 3) )
+            {
+                PrecomputedTablesT tables(tables_file);
+                context.precomputedTables = &tables;
+                auto tables_proof = libsnark::r1cs_gg_ppzksnark_zok_prover<ppT>(context, pb.values);
+                ok = tables_proof == proof && tables.matches(pk) && tables.matches(mapped_pk);
+
+                // Tables of another key are refused
+                auto other_pk = pk;
+                other_pk.L_query[0] = other_pk.L_query[0].dbl();
+                if( ok && tables.matches(other_pk) ) {
+                    std::cerr << "Tables match a different key\n";
+                    ok = false;
+                }
+                ProverContextT other_context(other_pk);
+                other_context.config = context.config;
+                other_context.constraint_system = context.constraint_system;
+                other_context.domain = context.domain;
+                other_context.precomputedTables = &tables;
+                try {
+                    libsnark::r1cs_gg_ppzksnark_zok_prover<ppT>(other_context, pb.values);
+                    std::cerr << "Prover accepted the tables of a different key\n";
+                    ok = false;
+                }
+                catch( const std::invalid_argument& ) { }
+
+                context.precomputedTables = nullptr;
+            }
+            else {
+                ok = false;
+            }
+            ::remove(tables_file.c_str());
+
+            // Streaming the key with a small budget reads it in many chunks
+            if( ok )
+            {
+                StreamProvingKeyT stream_pk(pk_file);
+                ProverContextT stream_context(stream_pk);
+                stream_context.config.stream_memory_budget = 4096;
+                stream_context.constraint_system = &pb.constraint_system;
+                stream_context.domain = context.domain;
+
+                auto stream_proof = libsnark::r1cs_gg_ppzksnark_zok_prover<ppT>(stream_context, pb.values);
+                ok = stream_proof == proof;
+            }
+        }
+    }
+
+    ::remove(pk_file);
+    if( ! ok ) {
+        return false;
+    }
+
+    // Generate a mapped key directly, a small budget gives many chunks per query
+    libsnark::Config config;
+    config.stream_memory_budget = 1 << 16;
+    auto vk = libsnark::r1cs_gg_ppzksnark_zok_generator_mapped<ppT>(pb.constraint_system, pk_file, config);
+    {
+        MappedProvingKeyT mapped_pk(pk_file);
+
+        ok = mapped_pk.A_query.size() == pk.A_query.size()
+          && mapped_pk.B_query.size() == pk.B_query.size()
+          && mapped_pk.H_query.size() == pk.H_query.size()
+          && mapped_pk.L_query.size() == pk.L_query.size();
+
+        ProverContextT context(mapped_pk);
+        context.constraint_system = &pb.constraint_system;
+        context.domain = get_domain(pb, context.config);
+
+        auto proof = libsnark::r1cs_gg_ppzksnark_zok_prover<ppT>(context, pb.values);
+        ok = ok && libsnark::r1cs_gg_ppzksnark_zok_verifier_strong_IC<ppT>(vk, pb.primary_input(), proof);
+    }
+
+    ::remove(pk_file);
+    return ok;
+}
+
+// namespace ethsnarks
+}
+
+
+int main( int argc, char **argv )
+{
+    ppT::init_public_params();
+
+    if( ! ethsnarks::test_mapped_proving_key() )
+    {
+        std::cerr << "FAIL\n";
+        return 1;
+    }
+
+    std::cout << "OK\n";
+    return 0;
+}
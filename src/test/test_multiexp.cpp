@@ -0,0 +1,88 @@
+// Copyright (c) 2018 HarryR
+// License: LGPL-3.0+
+
+#include "ethsnarks.hpp"
+#include "r1cs_gg_ppzksnark_zok/multiexp.hpp"
+
+
+using ethsnarks::ppT;
+using ethsnarks::FieldT;
+using ethsnarks::G1T;
+
+
+/**
+* Scalars as they come out of witnesses: random, only bits, and a few
+* values repeated, which put many bases into the same buckets
+*/
+static std::vector<FieldT> make_scalars( const std::string& distribution, size_t length )
+{
+    const FieldT repeated[] = {FieldT("3"), FieldT::random_element(), -FieldT::one(), FieldT::zero()};
+
+    std::vector<FieldT> scalars;
+    scalars.reserve(length);
+    for( size_t i = 0; i < length; i++ )
+    {
+        if( distribution == "bits" ) {
+            scalars.emplace_back(rand() % 2 ? FieldT::one() : FieldT::zero());
+        }
+        else if( distribution == "repeated" ) {
+            scalars.emplace_back(repeated[rand() % 4]);
+        }
+        else {
+            scalars.emplace_back(FieldT::random_element());
+        }
+    }
+    return scalars;
+}
+
+
+static bool test_multiexp( const std::vector<G1T>& bases, const std::string& distribution )
+{
+    const auto scalars = make_scalars(distribution, bases.size());
+
+    G1T expected = G1T::zero();
+    for( size_t i = 0; i < bases.size(); i++ ) {
+        expected = expected + (scalars[i] * bases[i]);
+    }
+
+    std::vector<libff::bigint<FieldT::num_limbs>> scratch_exponents;
+    for( const bool batch_affine : {true, false} )
+    {
+        libsnark::Config config;
+        config.multi_exp_batch_affine = batch_affine;
+
+        const auto result = libsnark::multi_exp_array<G1T, FieldT>(bases.data(), scalars.data(), bases.size(), scratch_exponents, config);
+        if( result != expected ) {
+            std::cerr << "Wrong result for " << distribution << " scalars, " << (batch_affine ? "affine" : "projective") << " buckets\n";
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+int main( int argc, char **argv )
+{
+    ppT::init_public_params();
+
+    std::vector<G1T> bases;
+    for( size_t i = 0; i < 4096; i++ ) {
+        bases.emplace_back(G1T::random_element());
+    }
+#ifdef USE_MIXED_ADDITION
+    libff::batch_to_special(bases);
+#endif
+
+    for( const auto& distribution : {"random", "bits", "repeated"} )
+    {
+        if( ! test_multiexp(bases, distribution) )
+        {
+            std::cerr << "FAIL\n";
+            return 1;
+        }
+    }
+
+    std::cout << "OK\n";
+    return 0;
+}
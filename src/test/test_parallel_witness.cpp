@@ -0,0 +1,84 @@
+// Copyright (c) 2019 HarryR
+// License: LGPL-3.0+
+
+#include "utils.hpp"
+#include "gadgets/poseidon.hpp"
+#include "gadgets/parallel_witness.hpp"
+
+using ethsnarks::ppT;
+using ethsnarks::FieldT;
+using ethsnarks::ProtoboardT;
+using ethsnarks::VariableArrayT;
+using ethsnarks::make_var_array;
+using ethsnarks::Poseidon128;
+
+using std::cout;
+using std::cerr;
+
+
+typedef Poseidon128<2,1> HashT;
+
+
+static void make_hashes( ProtoboardT& pb, const std::vector<FieldT>& values, std::vector<HashT>& hashes )
+{
+    const size_t n = values.size() / 2;
+    hashes.reserve(n);
+    for( size_t i = 0; i < n; i++ )
+    {
+        const auto inputs = make_var_array(pb, 2, FMT("input", "[%zu]", i));
+        pb.val(inputs[0]) = values[2*i];
+        pb.val(inputs[1]) = values[2*i + 1];
+        hashes.emplace_back(pb, inputs, FMT("hash", "[%zu]", i));
+    }
+    for( auto& hash : hashes ) {
+        hash.generate_r1cs_constraints();
+    }
+}
+
+
+static bool test_parallel_witness( size_t n )
+{
+    std::vector<FieldT> values(n * 2);
+    for( auto& value : values ) {
+        value = FieldT::random_element();
+    }
+
+    ProtoboardT expected_pb;
+    std::vector<HashT> expected_hashes;
+    make_hashes(expected_pb, values, expected_hashes);
+    for( auto& hash : expected_hashes ) {
+        hash.generate_r1cs_witness();
+    }
+
+    ProtoboardT pb;
+    std::vector<HashT> hashes;
+    make_hashes(pb, values, hashes);
+    ethsnarks::generate_r1cs_witness_parallel(hashes);
+
+    if( ! pb.is_satisfied() ) {
+        cerr << "Parallel witness not satisfied\n";
+        return false;
+    }
+
+    if( pb.full_variable_assignment() != expected_pb.full_variable_assignment() ) {
+        cerr << "Parallel witness differs from the serial one\n";
+        return false;
+    }
+
+    return true;
+}
+
+
+int main( int argc, char **argv )
+{
+    ppT::init_public_params();
+
+    if( ! test_parallel_witness(1) )
+        return 1;
+
+    if( ! test_parallel_witness(1000) )
+        return 2;
+
+    cout << "OK" << std::endl;
+    return 0;
+}
@@ -0,0 +1,87 @@
+// Copyright (c) 2018 HarryR
+// License: LGPL-3.0+
+
+#include "ethsnarks.hpp"
+#include "stubs.hpp"
+
+#include "shamir_poly_circuit.hpp"
+
+
+using ethsnarks::ppT;
+
+
+namespace ethsnarks {
+
+
+bool test_prover_batch( size_t batch_size )
+{
+    std::vector<ProtoboardT> pbs(batch_size);
+    std::vector<std::vector<FieldT>> assignments;
+    for( auto& pb : pbs )
+    {
+        make_shamir_poly_circuit(pb);
+        if( ! pb.is_satisfied() ) {
+            std::cerr << "Not satisfied!\n";
+            return false;
+        }
+        assignments.emplace_back(pb.values);
+    }
+
+    auto keypair = libsnark::r1cs_gg_ppzksnark_zok_generator<ppT>(pbs[0].constraint_system);
+    auto pk = ProvingKeyT(keypair.pk);
+
+    ProverContextT context(pk);
+    context.config = libsnark::Config();
+    context.constraint_system = &pbs[0].constraint_system;
+    context.domain = get_domain(pbs[0], context.config);
+
+    auto proofs = libsnark::r1cs_gg_ppzksnark_zok_prover_batch<ppT>(context, assignments);
+    if( proofs.size() != batch_size ) {
+        std::cerr << "Wrong number of proofs\n";
+        return false;
+    }
+
+    for( size_t i = 0; i < batch_size; i++ )
+    {
+        if( ! libsnark::r1cs_gg_ppzksnark_zok_verifier_strong_IC<ppT>(keypair.vk, pbs[i].primary_input(), proofs[i]) ) {
+            std::cerr << "Proof " << i << " of batch failed to verify\n";
+            return false;
+        }
+
+        // Must match the single proof prover
+        auto proof = libsnark::r1cs_gg_ppzksnark_zok_prover<ppT>(context, assignments[i]);
+        if( ! (proof == proofs[i]) ) {
+            std::cerr << "Proof " << i << " of batch differs from single proof\n";
+            return false;
+        }
+
+        // And the task scheduled prover
+        context.config.task_scheduler = true;
+        auto task_proof = libsnark::r1cs_gg_ppzksnark_zok_prover<ppT>(context, assignments[i]);
+        context.config.task_scheduler = false;
+        if( ! (task_proof == proofs[i]) ) {
+            std::cerr << "Proof " << i << " of batch differs from task scheduled proof\n";
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// namespace ethsnarks
+}
+
+
+int main( int argc, char **argv )
+{
+    ppT::init_public_params();
+
+    if( ! ethsnarks::test_prover_batch(1) || ! ethsnarks::test_prover_batch(4) )
+    {
+        std::cerr << "FAIL\n";
+        return 1;
+    }
+
+    std::cout << "OK\n";
+    return 0;
+}
@@ -0,0 +1,223 @@
+// Copyright (c) 2018 HarryR
+// License: LGPL-3.0+
+
+#include <cstdio>
+
+#include "ethsnarks.hpp"
+#include "stubs.hpp"
+#include "utils.hpp"
+#include "r1cs_binary.hpp"
+#include "prover_service.hpp"
+#include "r1cs_gg_ppzksnark_zok/r1cs_gg_ppzksnark_zok_generator.hpp"
+
+
+using ethsnarks::ppT;
+
+
+namespace ethsnarks {
+
+
+typedef libsnark::r1cs_compact_constraints<FieldT> CompactT;
+
+
+static const size_t LARGE_NUM_CONSTRAINTS = 6000;   // > 4096, the compact loader's block of constraints
+static const size_t LARGE_WIDTH = 12;               // A has 72000 terms, > 65536, the coefficient interning block
+static const size_t LARGE_NUM_INPUTS = 2;
+static const size_t LARGE_NUM_THREADS = 4;          // the task prover only chunks with more than one thread
+
+
+/**
+* Row i is (sum_k c_ik * x_{i+k}) * x_i = y_i. Half of the coefficients come
+* from a small pool, so the same values appear in every block of terms and
+* must be merged into one id, the others are random.
+*/
+static void make_large_circuit( ProtoboardT& pb )
+{
+    const VariableArrayT inputs = make_var_array(pb, LARGE_NUM_INPUTS, "inputs");
+    pb.set_input_sizes(LARGE_NUM_INPUTS);
+
+    const VariableArrayT x = make_var_array(pb, LARGE_NUM_CONSTRAINTS + LARGE_WIDTH - LARGE_NUM_INPUTS, "x");
+    const VariableArrayT y = make_var_array(pb, LARGE_NUM_CONSTRAINTS, "y");
+
+    VariableArrayT terms;
+    terms.insert(terms.end(), inputs.begin(), inputs.end());
+    terms.insert(terms.end(), x.begin(), x.end());
+
+    for( const auto& var : terms ) {
+        pb.val(var) = FieldT::random_element();
+    }
+
+    const std::vector<FieldT> pool = {
+        FieldT::one(), FieldT(2), FieldT(3), -FieldT::one(),
+        FieldT::random_element(), FieldT::random_element()
+    };
+
+    for( size_t i = 0; i < LARGE_NUM_CONSTRAINTS; i++ )
+    {
+        libsnark::linear_combination<FieldT> a;
+        FieldT a_val = FieldT::zero();
+        for( size_t k = 0; k < LARGE_WIDTH; k++ )
+        {
+            const FieldT c = (k % 2 == 0) ? pool[(i + k) % pool.size()] : FieldT::random_element();
+            a.add_term(terms[i + k], c);
+            a_val += c * pb.val(terms[i + k]);
+        }
+
+        pb.add_r1cs_constraint(ConstraintT(a, terms[i], y[i]), "large");
+        pb.val(y[i]) = a_val * pb.val(terms[i]);
+    }
+}
+
+
+static libsnark::Config make_config( const std::string& multi_exp, bool task_scheduler )
+{
+    libsnark::Config config;
+    config.num_threads = LARGE_NUM_THREADS;
+    config.task_scheduler = task_scheduler;
+    config.multi_exp_A = multi_exp;
+    config.multi_exp_B = multi_exp;
+    config.multi_exp_H = multi_exp;
+    config.multi_exp_L = multi_exp;
+    return config;
+}
+
+
+// Every multi-exp engine and scheduler must give the same proof
+static bool test_prover_configs( ProtoboardT& pb, ProvingKeyT& pk, const VerificationKeyT& vk )
+{
+    const libsnark::Config configs[] = {
+        make_config("BDLO12", false),
+        make_config("pippenger", false),
+        make_config("BDLO12", true),
+        make_config("pippenger", true)
+    };
+
+    ProverContextT context(pk);
+    context.constraint_system = &pb.constraint_system;
+
+    bool have_expected = false;
+    ProofT expected;
+    for( const auto& config : configs )
+    {
+        context.config = config;
+        context.domain = get_domain(pb, context.config);
+
+        const auto proof = libsnark::r1cs_gg_ppzksnark_zok_prover<ppT>(context, pb.values);
+        if( ! libsnark::r1cs_gg_ppzksnark_zok_verifier_strong_IC<ppT>(vk, pb.primary_input(), proof) ) {
+            std::cerr << "Proof not verified with " << config << "\n";
+            return false;
+        }
+
+        if( ! have_expected ) {
+            expected = proof;
+            have_expected = true;
+        }
+        else if( ! (proof == expected) ) {
+            std::cerr << "Proof differs with " << config << "\n";
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+// The coefficient ids may be numbered differently, compare the coefficients
+static bool matrices_equal( const CompactT& a_cs, const libsnark::r1cs_compact_matrix<FieldT>& a,
+                            const CompactT& b_cs, const libsnark::r1cs_compact_matrix<FieldT>& b )
+{
+    if( a.row_offsets != b.row_offsets || a.indices != b.indices ) {
+        return false;
+    }
+    for( size_t k = 0; k < a.indices.size(); k++ ) {
+        if( a_cs.coeff(a, k) != b_cs.coeff(b, k) ) {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+// Loads the constraints in several blocks on several threads, then proves from them
+static bool test_prove_compact( const ProtoboardT& pb )
+{
+    const std::string path = "test_prover_large.r1cs";
+    const std::string pk_file = "test_prover_large.pk.map";
+
+    if( ! r1cs2binary(pb, path, true) ) {
+        std::cerr << "Cannot write " << path << "\n";
+        return false;
+    }
+
+    bool result = true;
+    {
+        const libsnark::Config config = make_config("pippenger", true);
+
+        CompactT expected;
+        expected.build(pb.constraint_system, make_config("BDLO12", false));
+
+        CompactT compact;
+        R1CSBinaryFile(path).load_compact(compact, config);
+        if( ! compact.matches(pb.constraint_system)
+         || ! matrices_equal(compact, compact.A, expected, expected.A)
+         || ! matrices_equal(compact, compact.B, expected, expected.B)
+         || ! matrices_equal(compact, compact.C, expected, expected.C) ) {
+            std::cerr << "Compact constraints differ\n";
+            result = false;
+        }
+        else {
+            const auto vk = libsnark::r1cs_gg_ppzksnark_zok_generator_mapped<ppT>(compact, pk_file, config);
+
+            ProverService service(config);
+            const auto proof = service.prove(pk_file, compact, pb.values);
+            if( ! libsnark::r1cs_gg_ppzksnark_zok_verifier_strong_IC<ppT>(vk, pb.primary_input(), proof) ) {
+                std::cerr << "Proof from compact constraints not verified\n";
+                result = false;
+            }
+        }
+    }
+
+    ::remove(path.c_str());
+    ::remove(pk_file.c_str());
+
+    return result;
+}
+
+
+bool test_prover_large()
+{
+    ProtoboardT pb;
+    make_large_circuit(pb);
+
+    if( ! pb.is_satisfied() ) {
+        std::cerr << "Not satisfied!\n";
+        return false;
+    }
+
+    auto keypair = libsnark::r1cs_gg_ppzksnark_zok_generator<ppT>(pb.constraint_system);
+    auto pk = ProvingKeyT(keypair.pk);
+
+    if( ! test_prover_configs(pb, pk, keypair.vk) ) {
+        return false;
+    }
+
+    return test_prove_compact(pb);
+}
+
+// namespace ethsnarks
+}
+
+
+int main( int argc, char **argv )
+{
+    ppT::init_public_params();
+
+    if( ! ethsnarks::test_prover_large() )
+    {
+        std::cerr << "FAIL\n";
+        return 1;
+    }
+
+    std::cout << "OK\n";
+    return 0;
+}
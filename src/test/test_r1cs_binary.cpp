@@ -0,0 +1,162 @@
+// Copyright (c) 2018 HarryR
+// License: LGPL-3.0+
+
+#include <cstdio>
+
+#include "ethsnarks.hpp"
+#include "utils.hpp"
+#include "r1cs_binary.hpp"
+#include "prover_service.hpp"
+#include "r1cs_gg_ppzksnark_zok/r1cs_gg_ppzksnark_zok_generator.hpp"
+
+#include "shamir_poly_circuit.hpp"
+
+
+using ethsnarks::ppT;
+
+
+namespace ethsnarks {
+
+
+typedef libsnark::r1cs_compact_constraints<FieldT> CompactT;
+
+
+// The coefficient ids may be numbered differently, compare the coefficients
+static bool matrices_equal( const CompactT& a_cs, const libsnark::r1cs_compact_matrix<FieldT>& a,
+                            const CompactT& b_cs, const libsnark::r1cs_compact_matrix<FieldT>& b )
+{
+    if( a.row_offsets != b.row_offsets || a.indices != b.indices ) {
+        return false;
+    }
+    for( size_t k = 0; k < a.indices.size(); k++ ) {
+        if( a_cs.coeff(a, k) != b_cs.coeff(b, k) ) {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+// Keys and proofs from the compact constraints alone, without any constraint objects
+static bool test_prove_compact( const CompactT& compact, const ProtoboardT& pb )
+{
+    const std::string pk_file = "test_r1cs_binary.pk.map";
+    const libsnark::Config config;
+
+    const auto vk = libsnark::r1cs_gg_ppzksnark_zok_generator_mapped<ppT>(compact, pk_file, config);
+
+    bool result = true;
+    {
+        ProverService service(config);
+        const auto proof = service.prove(pk_file, compact, pb.values);
+        if( ! libsnark::r1cs_gg_ppzksnark_zok_verifier_strong_IC<ppT>(vk, pb.primary_input(), proof) ) {
+            std::cerr << "Proof from compact constraints not verified\n";
+            result = false;
+        }
+    }
+
+    ::remove(pk_file.c_str());
+
+    return result;
+}
+
+
+static bool test_r1cs_binary_roundtrip( const ProtoboardT& pb, bool compress )
+{
+    const std::string path = compress ? "test_r1cs_binary.compressed.r1cs" : "test_r1cs_binary.r1cs";
+
+    if( ! r1cs2binary(pb, path, compress) ) {
+        std::cerr << "Cannot write " << path << "\n";
+        return false;
+    }
+
+    bool result = true;
+    {
+        R1CSBinaryFile file(path);
+
+        ProtoboardT loaded_pb;
+        file.load(loaded_pb);
+        if( loaded_pb.num_constraints() != pb.num_constraints()
+         || loaded_pb.num_inputs() != pb.num_inputs()
+         || loaded_pb.num_variables() != pb.num_variables() ) {
+            std::cerr << "Loaded constraint system has different sizes\n";
+            result = false;
+        }
+        else {
+            // The original witness must satisfy the loaded constraints
+            for( size_t i = 0; i < pb.num_variables(); i++ ) {
+                loaded_pb.val(VariableT(i + 1)) = pb.val(VariableT(i + 1));
+            }
+            if( ! loaded_pb.is_satisfied() ) {
+                std::cerr << "Loaded constraint system not satisfied\n";
+                result = false;
+            }
+        }
+
+        const libsnark::Config config;
+        CompactT expected;
+        expected.build(pb.constraint_system, config);
+
+        CompactT compact;
+        file.load_compact(compact, config);
+        if( ! compact.matches(pb.constraint_system)
+         || ! matrices_equal(compact, compact.A, expected, expected.A)
+         || ! matrices_equal(compact, compact.B, expected, expected.B)
+         || ! matrices_equal(compact, compact.C, expected, expected.C) ) {
+            std::cerr << "Compact constraints differ\n";
+            result = false;
+        }
+        else if( compress && ! test_prove_compact(compact, pb) ) {
+            result = false;
+        }
+    }
+
+    ::remove(path.c_str());
+
+    return result;
+}
+
+
+bool test_r1cs_binary()
+{
+    ProtoboardT pb;
+    make_shamir_poly_circuit(pb);
+
+    if( ! pb.is_satisfied() ) {
+        std::cerr << "Not satisfied!\n";
+        return false;
+    }
+
+    if( ! test_r1cs_binary_roundtrip(pb, true) ) {
+        return false;
+    }
+
+    if( ! test_r1cs_binary_roundtrip(pb, false) ) {
+        return false;
+    }
+
+    if( is_r1cs_binary("test_r1cs_binary.missing") ) {
+        std::cerr << "Missing file detected as binary R1CS\n";
+        return false;
+    }
+
+    return true;
+}
+
+// namespace ethsnarks
+}
+
+
+int main( int argc, char **argv )
+{
+    ppT::init_public_params();
+
+    if( ! ethsnarks::test_r1cs_binary() )
+    {
+        std::cerr << "FAIL\n";
+        return 1;
+    }
+
+    std::cout << "OK\n";
+    return 0;
+}
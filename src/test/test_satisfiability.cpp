@@ -0,0 +1,79 @@
+// Copyright (c) 2018 HarryR
+// License: LGPL-3.0+
+
+#include "ethsnarks.hpp"
+#include "utils.hpp"
+
+#include "shamir_poly_circuit.hpp"
+
+
+using ethsnarks::ppT;
+
+
+namespace ethsnarks {
+
+
+bool test_satisfiability()
+{
+    ProtoboardT pb;
+    const VariableT in_input = make_shamir_poly_circuit(pb);
+
+    if( ! pb.is_satisfied() || ! check_satisfied(pb) || ! find_unsatisfied_constraints(pb).empty() ) {
+        std::cerr << "Satisfied protoboard reported as unsatisfied\n";
+        return false;
+    }
+
+    // Break the witness, the failures must be the same as a serial scan finds
+    pb.val(in_input) += FieldT::one();
+
+    std::vector<size_t> expected;
+    const auto& cs = pb.constraint_system;
+    for( size_t i = 0; i < cs.num_constraints(); i++ )
+    {
+        const auto& constraint = cs.constraints[i];
+        if( constraint->evaluateA(pb.values) * constraint->evaluateB(pb.values) != constraint->evaluateC(pb.values) ) {
+            expected.push_back(i);
+        }
+    }
+
+    if( expected.empty() || check_satisfied(pb) ) {
+        std::cerr << "Unsatisfied protoboard reported as satisfied\n";
+        return false;
+    }
+
+    for( size_t max_failures = 1; max_failures <= expected.size() + 1; max_failures++ )
+    {
+        const auto failures = find_unsatisfied_constraints(pb, max_failures);
+        if( failures.size() != std::min(max_failures, expected.size()) ) {
+            std::cerr << "Wrong number of failures\n";
+            return false;
+        }
+        for( size_t i = 0; i < failures.size(); i++ )
+        {
+            if( failures[i].index != expected[i] || failures[i].a * failures[i].b == failures[i].c ) {
+                std::cerr << "Wrong failure reported\n";
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+// namespace ethsnarks
+}
+
+
+int main( int argc, char **argv )
+{
+    ppT::init_public_params();
+
+    if( ! ethsnarks::test_satisfiability() )
+    {
+        std::cerr << "FAIL\n";
+        return 1;
+    }
+
+    std::cout << "OK\n";
+    return 0;
+}
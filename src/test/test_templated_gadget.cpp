@@ -0,0 +1,132 @@
+// Copyright (c) 2019 HarryR
+// License: LGPL-3.0+
+
+#include "utils.hpp"
+#include "gadgets/mimc.hpp"
+#include "gadgets/templated_gadget.hpp"
+#include "stubs.hpp"
+
+using ethsnarks::ppT;
+using ethsnarks::FieldT;
+using ethsnarks::ProtoboardT;
+using ethsnarks::VariableT;
+using ethsnarks::VariableArrayT;
+using ethsnarks::MiMC_e7_gadget;
+using ethsnarks::make_variable;
+using ethsnarks::stub_test_proof_verify;
+
+using std::cout;
+using std::cerr;
+
+
+typedef ethsnarks::templated_gadget<MiMC_e7_gadget> TemplatedMiMC;
+
+
+static MiMC_e7_gadget* build_mimc( ProtoboardT& pb, const VariableArrayT& inputs )
+{
+    return new MiMC_e7_gadget(pb, inputs[0], inputs[1], "mimc");
+}
+
+
+static bool test_templated_gadget( size_t n )
+{
+    ProtoboardT expected_pb;
+    ProtoboardT pb;
+
+    std::vector<MiMC_e7_gadget> expected;
+    std::vector<TemplatedMiMC> instances;
+    expected.reserve(n);
+    instances.reserve(n);
+
+    for( size_t i = 0; i < n; i++ )
+    {
+        const FieldT x = FieldT::random_element();
+        const FieldT k = FieldT::random_element();
+
+        const VariableT expected_x = make_variable(expected_pb, x, "x");
+        const VariableT expected_k = make_variable(expected_pb, k, "k");
+        expected.emplace_back(expected_pb, expected_x, expected_k, "mimc");
+
+        VariableArrayT inputs;
+        inputs.emplace_back(make_variable(pb, x, "x"));
+        inputs.emplace_back(make_variable(pb, k, "k"));
+        instances.emplace_back(pb, inputs, "MiMC_e7", build_mimc, "templated_mimc");
+    }
+
+    for( size_t i = 0; i < n; i++ )
+    {
+        expected[i].generate_r1cs_constraints();
+        expected[i].generate_r1cs_witness();
+        instances[i].generate_r1cs_constraints();
+        instances[i].generate_r1cs_witness();
+    }
+
+    if( pb.num_constraints() != expected_pb.num_constraints()
+     || pb.num_variables() != expected_pb.num_variables() ) {
+        cerr << "Templated instances have a different shape\n";
+        return false;
+    }
+
+    for( size_t i = 0; i < n; i++ )
+    {
+        const auto result = instances[i].variable(instances[i].master().result());
+        if( pb.val(result) != expected_pb.val(expected[i].result()) ) {
+            cerr << "Templated instance " << i << " has a different result\n";
+            return false;
+        }
+    }
+
+    // All instances share the master's constraints
+    if( &instances.front().master() != &instances.back().master() ) {
+        cerr << "Instances do not share the master\n";
+        return false;
+    }
+
+    if( ! pb.is_satisfied() ) {
+        cerr << "Not satisfied\n";
+        return false;
+    }
+
+    return stub_test_proof_verify(pb);
+}
+
+
+/**
+* A shape built from two inputs can't be reused with three
+*/
+static bool test_templated_gadget_inputs_mismatch()
+{
+    ProtoboardT pb;
+    VariableArrayT inputs;
+    for( size_t i = 0; i < 3; i++ ) {
+        inputs.emplace_back(make_variable(pb, FieldT::random_element(), "input"));
+    }
+
+    try {
+        TemplatedMiMC mimc(pb, inputs, "MiMC_e7", build_mimc, "templated_mimc");
+    }
+    catch( const std::invalid_argument& ) {
+        return true;
+    }
+
+    cerr << "Shape reused with another number of inputs\n";
+    return false;
+}
+
+
+int main( int argc, char **argv )
+{
+    ppT::init_public_params();
+
+    if( ! test_templated_gadget(1) )
+        return 1;
+
+    if( ! test_templated_gadget(8) )
+        return 2;
+
+    if( ! test_templated_gadget_inputs_mismatch() )
+        return 3;
+
+    cout << "OK" << std::endl;
+    return 0;
+}
@@ -0,0 +1,105 @@
+// Copyright (c) 2018 HarryR
+// License: LGPL-3.0+
+
+#include "ethsnarks.hpp"
+#include "stubs.hpp"
+#include "verifier_cache.hpp"
+
+#include "shamir_poly_circuit.hpp"
+
+#include <cstdio>
+
+
+using ethsnarks::ppT;
+
+
+namespace ethsnarks {
+
+
+bool test_verifier_cache()
+{
+    ProtoboardT pb;
+    make_shamir_poly_circuit(pb);
+
+    auto keypair = libsnark::r1cs_gg_ppzksnark_zok_generator<ppT>(pb.constraint_system);
+    ProvingKeyT pk(keypair.pk);
+    ProverContextT context(pk);
+    context.constraint_system = &pb.constraint_system;
+    context.domain = get_domain(pb, context.config);
+    auto proof = libsnark::r1cs_gg_ppzksnark_zok_prover<ppT>(context, pb.values);
+    auto primary_input = pb.primary_input();
+
+    const std::string cache_dir = "/tmp";
+    const auto hash = VerifierCache::key_hash(keypair.vk);
+    const std::string cache_file = cache_dir + "/" + hash + ".pvk";
+    ::remove(cache_file.c_str());
+
+    // The key is processed once, and written to the cache directory
+    VerifierCache cache(cache_dir);
+    const auto pvk = cache.get(keypair.vk);
+    if( cache.get(keypair.vk) != pvk || cache.num_loaded() != 1 ) {
+        std::cerr << "Key processed again\n";
+        return false;
+    }
+    if( ! std::ifstream(cache_file).good() ) {
+        std::cerr << "Processed key not written\n";
+        return false;
+    }
+
+    if( pvk->vk_alpha_g1_beta_g2 != ppT::reduced_pairing(keypair.vk.alpha_g1, keypair.vk.beta_g2) ) {
+        std::cerr << "Wrong e(alpha, beta)\n";
+        return false;
+    }
+
+    if( ! libsnark::r1cs_gg_ppzksnark_zok_online_verifier_strong_IC<ppT>(*pvk, primary_input, proof) ) {
+        std::cerr << "Proof rejected with the processed key\n";
+        return false;
+    }
+
+    // Another cache reads the processed key back from disk
+    VerifierCache other_cache(cache_dir);
+    const auto loaded_pvk = other_cache.get(keypair.vk);
+    if( ! (*loaded_pvk == *pvk) ) {
+        std::cerr << "Processed key differs after loading\n";
+        return false;
+    }
+
+    // And through the JSON interface
+    const auto vk_json = vk2json(keypair.vk);
+    if( ! other_cache.verify(vk_json, proof_to_json(proof, primary_input)) ) {
+        std::cerr << "JSON proof rejected\n";
+        return false;
+    }
+    if( other_cache.num_loaded() != 1 ) {
+        std::cerr << "JSON key processed again\n";
+        return false;
+    }
+
+    primary_input[0] += FieldT::one();
+    if( other_cache.verify(vk_json, proof_to_json(proof, primary_input)) ) {
+        std::cerr << "Invalid proof accepted\n";
+        return false;
+    }
+
+    ::remove(cache_file.c_str());
+
+    return true;
+}
+
+// namespace ethsnarks
+}
+
+
+int main( int argc, char **argv )
+{
+    ppT::init_public_params();
+
+    if( ! ethsnarks::test_verifier_cache() )
+    {
+        std::cerr << "FAIL\n";
+        return 1;
+    }
+
+    std::cout << "OK\n";
+    return 0;
+}
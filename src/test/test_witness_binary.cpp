@@ -0,0 +1,113 @@
+// Copyright (c) 2018 HarryR
+// License: LGPL-3.0+
+
+#include <cstdio>
+#include <fstream>
+
+#include "ethsnarks.hpp"
+#include "utils.hpp"
+#include "witness_binary.hpp"
+
+#include "shamir_poly_circuit.hpp"
+
+
+using ethsnarks::ppT;
+
+
+namespace ethsnarks {
+
+
+static bool test_witness_binary_roundtrip( const ProtoboardT& pb, const FieldT& input, const std::vector<FieldT>& alpha, bool canonical )
+{
+    const std::string path = canonical ? "test_witness_binary.canonical.witness" : "test_witness_binary.witness";
+
+    if( ! witness2binary(pb, path, canonical) ) {
+        std::cerr << "Cannot write " << path << "\n";
+        return false;
+    }
+
+    bool result = true;
+    {
+        WitnessBinaryFile file(path);
+
+        std::vector<FieldT> assignment;
+        file.load(assignment);
+        if( file.num_inputs() != pb.num_inputs() || assignment != pb.full_variable_assignment() ) {
+            std::cerr << "Loaded witness differs\n";
+            result = false;
+        }
+
+        // Load into the same circuit, built without a witness
+        ProtoboardT loaded_pb;
+        make_shamir_poly_circuit(loaded_pb, input, alpha, false);
+        file.load(loaded_pb);
+        if( ! loaded_pb.is_satisfied() ) {
+            std::cerr << "Loaded witness not satisfied\n";
+            result = false;
+        }
+    }
+
+    // Corrupt the last value, the checksum must catch it
+    {
+        std::fstream fh(path, std::ios::in | std::ios::out | std::ios::binary);
+        fh.seekp(-1, std::ios::end);
+        fh.put(0x5A);
+    }
+    try {
+        std::vector<FieldT> assignment;
+        WitnessBinaryFile(path).load(assignment);
+        std::cerr << "Corrupted witness was accepted\n";
+        result = false;
+    }
+    catch( const std::runtime_error& ) {
+    }
+
+    ::remove(path.c_str());
+
+    return result;
+}
+
+
+bool test_witness_binary()
+{
+    const FieldT input = FieldT::random_element();
+    const std::vector<FieldT> alpha = {
+        FieldT::random_element(), FieldT::random_element(),
+        FieldT::random_element(), FieldT::random_element()
+    };
+
+    ProtoboardT pb;
+    make_shamir_poly_circuit(pb, input, alpha);
+    if( ! pb.is_satisfied() ) {
+        std::cerr << "Not satisfied!\n";
+        return false;
+    }
+
+    if( ! test_witness_binary_roundtrip(pb, input, alpha, false) ) {
+        return false;
+    }
+
+    if( ! test_witness_binary_roundtrip(pb, input, alpha, true) ) {
+        return false;
+    }
+
+    return true;
+}
+
+// namespace ethsnarks
+}
+
+
+int main( int argc, char **argv )
+{
+    ppT::init_public_params();
+
+    if( ! ethsnarks::test_witness_binary() )
+    {
+        std::cerr << "FAIL\n";
+        return 1;
+    }
+
+    std::cout << "OK\n";
+    return 0;
+}
@@ -3,8 +3,11 @@
 
 #include <fstream>
 #include <iomanip>
+#include <iostream>
 
 #include "utils.hpp"
+#include "export.hpp"
+#include "r1cs_gg_ppzksnark_zok/witness_map.hpp"
 
 namespace ethsnarks {
 
@@ -368,5 +371,117 @@ void dump_pb_r1cs_constraints(const ProtoboardT& pb)
 }
 
 
+/**
+* The first `max_failures` of `n` constraints for which `evaluate(i, a, b, c)`
+* gives a * b != c, evaluated in blocks on `num_threads` threads (0 = all)
+*/
+template<typename EvaluateFn>
+static std::vector<unsatisfied_constraint> find_unsatisfied( size_t n, size_t max_failures, unsigned int num_threads, EvaluateFn evaluate )
+{
+    const size_t block = 4096;
+    max_failures = std::max<size_t>(max_failures, 1);
+
+    libsnark::Config config;
+    if( num_threads != 0 ) {
+        config.num_threads = num_threads;
+    }
+
+    // Each block keeps at most `max_failures` of its own, in order, so the
+    // first ones overall are the first ones of the first blocks
+    std::vector<std::vector<unsatisfied_constraint>> block_failures((n + block - 1) / block);
+    libsnark::witness_map_for_blocks(n, block, false, config, [&](size_t begin, size_t end) {
+        auto& failures = block_failures[begin / block];
+        for( size_t i = begin; i < end && failures.size() < max_failures; i++ )
+        {
+            FieldT a, b, c;
+            evaluate(i, a, b, c);
+            if( a * b != c ) {
+                failures.push_back({i, a, b, c, std::string()});
+            }
+        }
+    });
+
+    std::vector<unsatisfied_constraint> result;
+    for( auto& failures : block_failures )
+    {
+        for( auto& failure : failures )
+        {
+            if( result.size() == max_failures ) {
+                return result;
+            }
+            result.emplace_back(std::move(failure));
+        }
+    }
+    return result;
+}
+
+
+std::vector<unsatisfied_constraint> find_unsatisfied_constraints( const ProtoboardT& pb, size_t max_failures, unsigned int num_threads )
+{
+    const auto& cs = pb.constraint_system;
+    const auto& assignment = pb.values;
+
+    auto result = find_unsatisfied(cs.num_constraints(), max_failures, num_threads, [&](size_t i, FieldT& a, FieldT& b, FieldT& c) {
+        const auto& constraint = cs.constraints[i];
+        a = constraint->evaluateA(assignment);
+        b = constraint->evaluateB(assignment);
+        c = constraint->evaluateC(assignment);
+    });
+
+#ifdef DEBUG
+    for( auto& failure : result )
+    {
+        const auto it = cs.constraint_annotations.find(failure.index);
+        if( it != cs.constraint_annotations.end() ) {
+            failure.annotation = it->second;
+        }
+    }
+#endif
+    return result;
+}
+
+
+std::vector<unsatisfied_constraint> find_unsatisfied_constraints( const CompactConstraintsT& constraints, const std::vector<FieldT>& values, size_t max_failures, unsigned int num_threads )
+{
+    const FieldT *assignment = values.data();
+
+    return find_unsatisfied(constraints.num_constraints, max_failures, num_threads, [&](size_t i, FieldT& a, FieldT& b, FieldT& c) {
+        a = constraints.evaluate(constraints.A, i, assignment);
+        b = constraints.evaluate(constraints.B, i, assignment);
+        c = constraints.evaluate(constraints.C, i, assignment);
+    });
+}
+
+
+static bool print_unsatisfied( const std::vector<unsatisfied_constraint>& failures )
+{
+    for( const auto& failure : failures )
+    {
+        std::cerr << "Unsatisfied constraint " << failure.index;
+        if( ! failure.annotation.empty() ) {
+            std::cerr << " (" << failure.annotation << ")";
+        }
+        std::cerr << ": <a,(1,x)> * <b,(1,x)> != <c,(1,x)>" << std::endl;
+        std::cerr << "\t<a,(1,x)> = 0x" << HexStringFromBigint(failure.a.as_bigint()) << std::endl;
+        std::cerr << "\t<b,(1,x)> = 0x" << HexStringFromBigint(failure.b.as_bigint()) << std::endl;
+        std::cerr << "\t<c,(1,x)> = 0x" << HexStringFromBigint(failure.c.as_bigint()) << std::endl;
+        std::cerr << "\ta * b     = 0x" << HexStringFromBigint((failure.a * failure.b).as_bigint()) << std::endl;
+    }
+    return failures.empty();
+}
+
+
+bool check_satisfied( const ProtoboardT& pb, size_t max_failures )
+{
+    return print_unsatisfied(find_unsatisfied_constraints(pb, max_failures));
+}
+
+
+bool check_satisfied( const CompactConstraintsT& constraints, const std::vector<FieldT>& values, size_t max_failures )
+{
+    return print_unsatisfied(find_unsatisfied_constraints(constraints, values, max_failures));
+}
+
+
 // ethsnarks
 }
@@ -111,6 +111,37 @@ VariableArrayT VariableArray_from_bits( ProtoboardT &in_pb, const libff::bit_vec
 void dump_pb_r1cs_constraints(const ProtoboardT& pb);
 
 
+struct unsatisfied_constraint
+{
+    size_t index;
+    FieldT a;   // <A,(1,x)>
+    FieldT b;
+    FieldT c;
+    std::string annotation;     // only recorded in DEBUG builds
+};
+
+/**
+* Evaluates A*B-C for every constraint of the protoboard, in parallel, and
+* returns the first `max_failures` unsatisfied constraints in order. The
+* blocks of constraints are shared between `num_threads` threads (0 = all).
+*/
+std::vector<unsatisfied_constraint> find_unsatisfied_constraints( const ProtoboardT& pb, size_t max_failures = 10, unsigned int num_threads = 0 );
+
+/**
+* Like `pb.is_satisfied()`, but in parallel, printing the first `max_failures`
+* unsatisfied constraints to stderr, with their values of A, B and C
+*/
+bool check_satisfied( const ProtoboardT& pb, size_t max_failures = 10 );
+
+/**
+* The same for a full assignment `values`, with the constant one first, of
+* a constraint system in compact form
+*/
+std::vector<unsatisfied_constraint> find_unsatisfied_constraints( const CompactConstraintsT& constraints, const std::vector<FieldT>& values, size_t max_failures = 10, unsigned int num_threads = 0 );
+
+bool check_satisfied( const CompactConstraintsT& constraints, const std::vector<FieldT>& values, size_t max_failures = 10 );
+
+
 inline const VariableArrayT make_var_array( ProtoboardT &in_pb, size_t n, const std::string &annotation )
 {
     VariableArrayT x;
@@ -0,0 +1,52 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+#include "export.hpp"
+
+#include <cstdlib>
+
+using std::cerr;
+using std::endl;
+using std::string;
+
+
+int main( int argc, char **argv )
+{
+	ethsnarks::ppT::init_public_params();
+
+	const string progname(argv[0]);
+	if( argc < 2 ) {
+		cerr << "Usage: " << progname << " <map|tables> ..." << endl;
+		return 1;
+	}
+
+	const string cmd(argv[1]);
+
+	if( cmd == "map" ) {
+		if( argc < 4 ) {
+			cerr << "Usage: " << progname << " " << cmd << " <proving-key.raw> <proving-key.map>" << endl;
+			return 5;
+		}
+		if( ! ethsnarks::pk_nozk2mapped(argv[2], argv[3]) ) {
+			cerr << "Error: cannot write " << argv[3] << endl;
+			return 2;
+		}
+		return 0;
+	}
+	else if( cmd == "tables" ) {
+		if( argc < 3 ) {
+			cerr << "Usage: " << progname << " " << cmd << " <proving-key> [expansion=4] [window-bits]" << endl;
+			return 5;
+		}
+		const size_t expansion = argc > 3 ? atoi(argv[3]) : 4;
+		const size_t window_bits = argc > 4 ? atoi(argv[4]) : 0;
+		if( ! ethsnarks::pk_precompute_tables(argv[2], expansion, window_bits) ) {
+			cerr << "Error: cannot write precomputed tables for " << argv[2] << endl;
+			return 2;
+		}
+		return 0;
+	}
+
+	cerr << "Error: unknown command " << cmd << endl;
+	return 1;
+}
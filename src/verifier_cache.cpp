@@ -0,0 +1,163 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+#include <cstdio>
+#include <iostream>
+#include <sstream>
+
+#include "verifier_cache.hpp"
+#include "import.hpp"
+#include "utils.hpp"
+#include "crypto/sha256.h"
+
+#include "r1cs_gg_ppzksnark_zok/r1cs_gg_ppzksnark_zok.hpp"
+#include "r1cs_gg_ppzksnark_zok/r1cs_gg_ppzksnark_zok_batch_verifier.hpp"
+
+
+namespace ethsnarks {
+
+
+VerifierCache::VerifierCache( const std::string& cache_dir, const libsnark::Config& in_config ) :
+    m_cache_dir(cache_dir),
+    m_config(in_config)
+{ }
+
+
+std::string VerifierCache::key_hash( const VerificationKeyT& vk )
+{
+    std::stringstream ss;
+    ss << vk;
+    const std::string serialised = ss.str();
+
+    SHA256_CTX ctx;
+    uint8_t digest[SHA256_DIGEST_LENGTH];
+    SHA256_Init(&ctx);
+    SHA256_Update(&ctx, serialised.data(), serialised.size());
+    SHA256_Final(digest, &ctx);
+
+    static const char hex_digits[] = "0123456789abcdef";
+    std::string result;
+    result.reserve(SHA256_DIGEST_LENGTH * 2);
+    for( const auto byte : digest ) {
+        result.push_back(hex_digits[byte >> 4]);
+        result.push_back(hex_digits[byte & 0xF]);
+    }
+    return result;
+}
+
+
+VerifierCache::KeyPtr VerifierCache::load_or_process( const VerificationKeyT& vk, const std::string& hash ) const
+{
+    const std::string path = m_cache_dir.empty() ? "" : m_cache_dir + "/" + hash + ".pvk";
+
+    if( ! path.empty() )
+    {
+        std::ifstream fh(path, std::ios::binary);
+        if( fh.is_open() )
+        {
+            std::shared_ptr<ProcessedVerificationKeyT> pvk(new ProcessedVerificationKeyT);
+            fh >> *pvk;
+            if( fh ) {
+                return pvk;
+            }
+            // Unreadable, e.g. written by another build, process it again
+        }
+    }
+
+    // Kept for many verifications, so the input tables pay off
+    std::shared_ptr<ProcessedVerificationKeyT> processed(new ProcessedVerificationKeyT(libsnark::r1cs_gg_ppzksnark_zok_verifier_process_vk<ppT>(vk)));
+    libsnark::r1cs_gg_ppzksnark_zok_verifier_precompute_input_tables<ppT>(*processed);
+    KeyPtr pvk = processed;
+
+    if( ! path.empty() )
+    {
+        // Written aside then renamed, so other processes never read a partial file
+        const std::string tmp_path = path + ".tmp";
+        writeToFile<const ProcessedVerificationKeyT>(tmp_path, *pvk);
+        if( 0 != ::rename(tmp_path.c_str(), path.c_str()) ) {
+            std::cerr << "Warning: cannot write " << path << std::endl;
+            ::remove(tmp_path.c_str());
+        }
+    }
+
+    return pvk;
+}
+
+
+VerifierCache::KeyPtr VerifierCache::get( const VerificationKeyT& vk )
+{
+    const auto hash = key_hash(vk);
+
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        auto it = m_keys.find(hash);
+        if( it != m_keys.end() ) {
+            return it->second;
+        }
+    }
+
+    // Processed without holding the lock, if another thread got there first its key is kept
+    auto pvk = load_or_process(vk, hash);
+
+    std::lock_guard<std::mutex> guard(m_lock);
+    return m_keys.emplace(hash, pvk).first->second;
+}
+
+
+VerifierCache::KeyPtr VerifierCache::get_json( const std::string& vk_json )
+{
+    std::stringstream vk_stream;
+    vk_stream << vk_json;
+    return get(vk_from_json(vk_stream));
+}
+
+
+bool VerifierCache::verify( const std::string& vk_json, const std::string& proof_json )
+{
+    const auto pvk = get_json(vk_json);
+
+    std::stringstream proof_stream;
+    proof_stream << proof_json;
+    const auto proof_pair = proof_from_json(proof_stream);
+
+    return libsnark::r1cs_gg_ppzksnark_zok_online_verifier_strong_IC<ppT>(*pvk, proof_pair.first, proof_pair.second);
+}
+
+
+std::vector<bool> VerifierCache::verify_batch( const std::string& vk_json, const std::vector<std::string>& proof_jsons )
+{
+    const auto pvk = get_json(vk_json);
+
+    std::vector<PrimaryInputT> primary_inputs;
+    std::vector<ProofT> proofs;
+    primary_inputs.reserve(proof_jsons.size());
+    proofs.reserve(proof_jsons.size());
+    for( const auto& proof_json : proof_jsons )
+    {
+        std::stringstream proof_stream;
+        proof_stream << proof_json;
+        auto proof_pair = proof_from_json(proof_stream);
+        primary_inputs.emplace_back(std::move(proof_pair.first));
+        proofs.emplace_back(std::move(proof_pair.second));
+    }
+
+    return libsnark::r1cs_gg_ppzksnark_zok_batch_verifier_strong_IC<ppT>(*pvk, primary_inputs, proofs, m_config);
+}
+
+
+void VerifierCache::clear()
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+    m_keys.clear();
+}
+
+
+size_t VerifierCache::num_loaded() const
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+    return m_keys.size();
+}
+
+
+// namespace ethsnarks
+}
@@ -0,0 +1,74 @@
+#ifndef ETHSNARKS_VERIFIER_CACHE_HPP_
+#define ETHSNARKS_VERIFIER_CACHE_HPP_
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "ethsnarks.hpp"
+
+
+namespace ethsnarks {
+
+
+/**
+* Keeps processed verification keys between verifications.
+*
+* A processed key holds the Miller loop precomputations of gamma and delta
+* and the pairing e(alpha, beta), so each verification only computes the
+* pairings involving the proof and one final exponentiation. Keys with many
+* inputs also get precomputed input tables, which only pay off over many
+* verifications, so the one-shot verifiers don't build them. Keys are
+* identified by the SHA-256 hash of their serialised form, so the same key
+* is processed once however it was loaded.
+*
+* If `cache_dir` is given the processed keys are also written there, as
+* `<hash>.pvk`, and read back by later processes instead of being processed
+* again. The files use the libff serialisation, they are only valid for the
+* build which wrote them.
+*
+* Thread-safe, the processed keys are shared by concurrent verifications.
+*/
+class VerifierCache
+{
+public:
+    typedef std::shared_ptr<const ProcessedVerificationKeyT> KeyPtr;
+
+    VerifierCache( const std::string& cache_dir = "", const libsnark::Config& in_config = libsnark::Config() );
+
+    /** Hex encoded SHA-256 of the serialised verification key */
+    static std::string key_hash( const VerificationKeyT& vk );
+
+    /** The processed key for `vk`, processing it if necessary */
+    KeyPtr get( const VerificationKeyT& vk );
+
+    /** As above, for a verification key in the JSON format */
+    KeyPtr get_json( const std::string& vk_json );
+
+    /** Verify a proof in the JSON format, with strong input consistency */
+    bool verify( const std::string& vk_json, const std::string& proof_json );
+
+    /** Verify several proofs for the same key as one batch, see r1cs_gg_ppzksnark_zok_batch_verifier.hpp */
+    std::vector<bool> verify_batch( const std::string& vk_json, const std::vector<std::string>& proof_jsons );
+
+    /** Release all the processed keys, the files in `cache_dir` are kept */
+    void clear();
+
+    size_t num_loaded() const;
+
+protected:
+    KeyPtr load_or_process( const VerificationKeyT& vk, const std::string& hash ) const;
+
+    const std::string m_cache_dir;
+    const libsnark::Config m_config;
+    mutable std::mutex m_lock;
+    std::map<std::string, KeyPtr> m_keys;
+};
+
+
+// namespace ethsnarks
+}
+
+#endif
@@ -1,10 +1,233 @@
-#include "stubs.hpp"
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <gmp.h>
+
+#include "ethsnarks_verify.h"
+#include "import.hpp"
+#include "verifier_cache.hpp"
+
+#include "r1cs_gg_ppzksnark_zok/r1cs_gg_ppzksnark_zok_batch_verifier.hpp"
+
+
+using ethsnarks::FieldT;
+using ethsnarks::FqT;
+using ethsnarks::ppT;
+
+
+struct ethsnarks_vk
+{
+    ethsnarks::VerifierCache::KeyPtr pvk;
+};
+
+
+namespace {
+
+
+/** The curve parameters are initialised once, not on every call */
+void init_once()
+{
+    static std::once_flag initialised;
+    std::call_once(initialised, [](){
+        ppT::init_public_params();
+    });
+}
+
+
+ethsnarks::VerifierCache& verifier_cache()
+{
+    static ethsnarks::VerifierCache cache;
+    return cache;
+}
+
+
+/**
+* Read a 32 byte big-endian number as an element of the field, it must be
+* less than the modulus so each element has one encoding
+*/
+template<typename T>
+bool read_element( const uint8_t *in_bytes, T& out )
+{
+    mpz_t value_mpz;
+    mpz_init(value_mpz);
+    mpz_import(value_mpz, ETHSNARKS_INPUT_SIZE, 1, 1, 1, 0, in_bytes);
+    const libff::bigint<T::num_limbs> value(value_mpz);
+    mpz_clear(value_mpz);
+
+    out = T(value);
+    return out.as_bigint() == value;
+}
+
+
+/** As above, hex encoded for create_G1 and create_G2 */
+bool read_Fq_hex( const uint8_t *in_bytes, std::string& out )
+{
+    FqT element;
+    if( ! read_element(in_bytes, element) ) {
+        return false;
+    }
+
+    static const char hex_digits[] = "0123456789abcdef";
+    out = "0x";
+    for( size_t i = 0; i < ETHSNARKS_INPUT_SIZE; i++ ) {
+        out.push_back(hex_digits[in_bytes[i] >> 4]);
+        out.push_back(hex_digits[in_bytes[i] & 0xF]);
+    }
+    return true;
+}
+
+
+bool read_proof( const uint8_t *in_bytes, ethsnarks::ProofT& out )
+{
+    std::string coords[8];
+    for( size_t i = 0; i < 8; i++ )
+    {
+        if( ! read_Fq_hex(&in_bytes[i * ETHSNARKS_INPUT_SIZE], coords[i]) ) {
+            return false;
+        }
+    }
+
+    out.g_A = ethsnarks::create_G1(coords[0], coords[1]);
+    out.g_B = ethsnarks::create_G2(coords[2], coords[3], coords[4], coords[5]);
+    out.g_C = ethsnarks::create_G1(coords[6], coords[7]);
+    return out.is_well_formed();
+}
+
+
+bool read_inputs( const uint8_t *in_bytes, size_t num_inputs, ethsnarks::PrimaryInputT& out )
+{
+    out.resize(num_inputs);
+    for( size_t i = 0; i < num_inputs; i++ )
+    {
+        if( ! read_element(&in_bytes[i * ETHSNARKS_INPUT_SIZE], out[i]) ) {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+// namespace
+}
+
 
 extern "C" {
 
 bool ethsnarks_verify( const char *vk_json, const char *proof_json )
 {
-    return ethsnarks::stub_verify( vk_json, proof_json );
+    init_once();
+
+    try {
+        return verifier_cache().verify(vk_json, proof_json);
+    }
+    catch( ... ) {
+        return false;
+    }
+}
+
+
+ethsnarks_vk *ethsnarks_load_vk( const char *vk_json )
+{
+    init_once();
+
+    try {
+        // Handles for the same key share the processed key
+        std::unique_ptr<ethsnarks_vk> vk(new ethsnarks_vk);
+        vk->pvk = verifier_cache().get_json(vk_json);
+        return vk.release();
+    }
+    catch( ... ) {
+        return nullptr;
+    }
+}
+
+
+size_t ethsnarks_vk_num_inputs( const ethsnarks_vk *vk )
+{
+    if( vk == nullptr ) {
+        return 0;
+    }
+    return vk->pvk->gamma_ABC_g1.domain_size();
+}
+
+
+bool ethsnarks_verify_proof( const ethsnarks_vk *vk, const uint8_t *proof, const uint8_t *inputs, size_t num_inputs )
+{
+    if( vk == nullptr ) {
+        return false;
+    }
+
+    try {
+        ethsnarks::ProofT parsed_proof;
+        ethsnarks::PrimaryInputT primary_input;
+        if( ! read_proof(proof, parsed_proof) || ! read_inputs(inputs, num_inputs, primary_input) ) {
+            return false;
+        }
+
+        return libsnark::r1cs_gg_ppzksnark_zok_online_verifier_strong_IC<ppT>(*vk->pvk, primary_input, parsed_proof);
+    }
+    catch( ... ) {
+        return false;
+    }
+}
+
+
+size_t ethsnarks_verify_batch( const ethsnarks_vk *vk, size_t num_proofs, const uint8_t *proofs, const uint8_t *inputs, uint8_t *out_valid )
+{
+    // Nothing is valid unless the batch verifier says so
+    std::fill(out_valid, out_valid + num_proofs, 0);
+    if( vk == nullptr ) {
+        return 0;
+    }
+
+    try {
+        const size_t num_inputs = ethsnarks_vk_num_inputs(vk);
+
+        // Proofs which can't be read are left out of the batch
+        std::vector<size_t> indices;
+        std::vector<ethsnarks::ProofT> parsed_proofs;
+        std::vector<ethsnarks::PrimaryInputT> primary_inputs;
+        indices.reserve(num_proofs);
+        parsed_proofs.reserve(num_proofs);
+        primary_inputs.reserve(num_proofs);
+        for( size_t i = 0; i < num_proofs; i++ )
+        {
+            ethsnarks::ProofT proof;
+            ethsnarks::PrimaryInputT primary_input;
+            if( read_proof(&proofs[i * ETHSNARKS_PROOF_SIZE], proof)
+             && read_inputs(&inputs[i * num_inputs * ETHSNARKS_INPUT_SIZE], num_inputs, primary_input) )
+            {
+                indices.emplace_back(i);
+                parsed_proofs.emplace_back(std::move(proof));
+                primary_inputs.emplace_back(std::move(primary_input));
+            }
+        }
+
+        const auto results = libsnark::r1cs_gg_ppzksnark_zok_batch_verifier_strong_IC<ppT>(*vk->pvk, primary_inputs, parsed_proofs, libsnark::Config());
+
+        size_t num_valid = 0;
+        for( size_t j = 0; j < indices.size(); j++ )
+        {
+            if( results[j] ) {
+                out_valid[indices[j]] = 1;
+                num_valid++;
+            }
+        }
+        return num_valid;
+    }
+    catch( ... ) {
+        std::fill(out_valid, out_valid + num_proofs, 0);
+        return 0;
+    }
+}
+
+
+void ethsnarks_free_vk( ethsnarks_vk *vk )
+{
+    delete vk;
 }
 
 }
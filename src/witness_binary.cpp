@@ -0,0 +1,227 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#include "witness_binary.hpp"
+#include "r1cs_gg_ppzksnark_zok/witness_map.hpp"
+
+namespace ethsnarks {
+
+
+static const size_t WITNESS_BINARY_ALIGN = 64;
+
+// Blocks converted and written at a time
+static const size_t WITNESS_BINARY_CHUNK_BLOCKS = 64;
+
+
+static inline uint64_t witness_binary_hash( uint64_t hash, uint64_t word )
+{
+    // FNV-1a
+    return (hash ^ word) * 1099511628211ULL;
+}
+
+
+static uint64_t witness_binary_block_hash( const uint8_t *data, size_t size )
+{
+    uint64_t hash = 14695981039346656037ULL;
+    size_t i = 0;
+    for( ; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t) )
+    {
+        uint64_t word;
+        ::memcpy(&word, data + i, sizeof(word));
+        hash = witness_binary_hash(hash, word);
+    }
+    for( ; i < size; i++ ) {
+        hash = witness_binary_hash(hash, data[i]);
+    }
+    return hash;
+}
+
+
+static uint64_t witness_binary_checksum( const std::vector<uint64_t> &block_hashes )
+{
+    uint64_t hash = 14695981039346656037ULL;
+    for( const auto block_hash : block_hashes ) {
+        hash = witness_binary_hash(hash, block_hash);
+    }
+    return hash;
+}
+
+
+static inline size_t witness_binary_element_size( bool canonical )
+{
+    return canonical ? sizeof(LimbT) : sizeof(FieldT);
+}
+
+
+bool write_witness_binary( const std::vector<FieldT> &assignment, size_t num_inputs, const std::string &path,
+                           bool canonical, const libsnark::Config &config )
+{
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if( ! out.is_open() ) {
+        return false;
+    }
+
+    const size_t n = assignment.size();
+    const size_t element_size = witness_binary_element_size(canonical);
+    const size_t block = WITNESS_BINARY_CHECKSUM_BLOCK;
+    const size_t chunk = block * WITNESS_BINARY_CHUNK_BLOCKS;
+
+    witness_binary_header header;
+    ::memset(&header, 0, sizeof(header));
+    ::memcpy(header.magic, WITNESS_BINARY_MAGIC, sizeof(WITNESS_BINARY_MAGIC));
+    header.version = WITNESS_BINARY_VERSION;
+    header.byte_order = libsnark::MAPPED_PK_BYTE_ORDER;
+    header.element_size = element_size;
+    header.flags = canonical ? WITNESS_BINARY_CANONICAL : 0;
+    header.num_inputs = num_inputs;
+    header.num_variables = n;
+    header.values_offset = (sizeof(header) + WITNESS_BINARY_ALIGN - 1) & ~uint64_t(WITNESS_BINARY_ALIGN - 1);
+
+    // Values in Montgomery form are written as they are, canonical ones are
+    // converted a chunk at a time
+    std::vector<LimbT> limbs(canonical ? std::min(n, chunk) : 0);
+    std::vector<uint64_t> block_hashes((n + block - 1) / block);
+
+    out.seekp(header.values_offset);
+    for( size_t start = 0; start < n; start += chunk )
+    {
+        const size_t count = std::min(chunk, n - start);
+        const uint8_t *data = canonical ? reinterpret_cast<const uint8_t*>(limbs.data())
+                                        : reinterpret_cast<const uint8_t*>(&assignment[start]);
+
+        libsnark::witness_map_for_blocks(count, block, false, config, [&](size_t begin, size_t end) {
+            if( canonical ) {
+                for( size_t i = begin; i < end; i++ ) {
+                    limbs[i] = assignment[start + i].as_bigint();
+                }
+            }
+            block_hashes[(start + begin) / block] = witness_binary_block_hash(data + (begin * element_size), (end - begin) * element_size);
+        });
+
+        out.write(reinterpret_cast<const char*>(data), count * element_size);
+    }
+
+    if( n == 0 ) {
+        // Extend the file to the aligned size
+        out.seekp(header.values_offset - 1);
+        out.put(0);
+    }
+
+    header.checksum = witness_binary_checksum(block_hashes);
+    out.seekp(0);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.flush();
+    return out.good();
+}
+
+
+bool witness2binary( const ProtoboardT &pb, const std::string &path, bool canonical )
+{
+    return write_witness_binary(pb.full_variable_assignment(), pb.num_inputs(), path, canonical);
+}
+
+
+bool is_witness_binary( const std::string &path )
+{
+    std::ifstream fh(path, std::ios::binary);
+    char magic[sizeof(WITNESS_BINARY_MAGIC)];
+    if( ! fh.read(magic, sizeof(magic)) ) {
+        return false;
+    }
+    return 0 == ::memcmp(magic, WITNESS_BINARY_MAGIC, sizeof(magic));
+}
+
+
+WitnessBinaryFile::WitnessBinaryFile( const std::string &path ) :
+    m_file(path)
+{
+    if( m_file.size() < sizeof(witness_binary_header) ) {
+        throw std::runtime_error("Binary witness: file too small");
+    }
+    m_header = m_file.at<witness_binary_header>(0, 1);
+
+    const auto &h = *m_header;
+    const bool canonical = (h.flags & WITNESS_BINARY_CANONICAL) != 0;
+    const char *error = nullptr;
+    if( 0 != ::memcmp(h.magic, WITNESS_BINARY_MAGIC, sizeof(WITNESS_BINARY_MAGIC)) ) {
+        error = "Binary witness: bad magic";
+    }
+    else if( h.version != WITNESS_BINARY_VERSION ) {
+        error = "Binary witness: unsupported version";
+    }
+    else if( h.byte_order != libsnark::MAPPED_PK_BYTE_ORDER ) {
+        error = "Binary witness: byte order mismatch";
+    }
+    else if( h.element_size != witness_binary_element_size(canonical) ) {
+        error = "Binary witness: field element size does not match this build";
+    }
+    else if( h.num_inputs > h.num_variables ) {
+        error = "Binary witness: bad variable counts";
+    }
+    if( error ) {
+        throw std::runtime_error(error);
+    }
+
+    // Check the values are within the file
+    if( canonical ) {
+        m_file.at<LimbT>(h.values_offset, h.num_variables);
+    }
+    else {
+        m_file.at<FieldT>(h.values_offset, h.num_variables);
+    }
+}
+
+
+void WitnessBinaryFile::load( std::vector<FieldT> &assignment, const libsnark::Config &config ) const
+{
+    libff::enter_block("Load the binary witness");
+
+    const auto &h = *m_header;
+    const bool canonical = (h.flags & WITNESS_BINARY_CANONICAL) != 0;
+    const size_t n = h.num_variables;
+    const size_t block = WITNESS_BINARY_CHECKSUM_BLOCK;
+    const uint8_t *data = m_file.data() + h.values_offset;
+
+    assignment.resize(n);
+    std::vector<uint64_t> block_hashes((n + block - 1) / block);
+
+    // Hash each block while it is copied, so the file is only read once
+    libsnark::witness_map_for_blocks(n, block, false, config, [&](size_t begin, size_t end) {
+        const uint8_t *block_data = data + (begin * h.element_size);
+        block_hashes[begin / block] = witness_binary_block_hash(block_data, (end - begin) * h.element_size);
+
+        if( canonical ) {
+            const LimbT *limbs = reinterpret_cast<const LimbT*>(block_data);
+            for( size_t i = begin; i < end; i++ ) {
+                assignment[i] = FieldT(limbs[i - begin]);
+            }
+        }
+        else {
+            ::memcpy(&assignment[begin], block_data, (end - begin) * sizeof(FieldT));
+        }
+    });
+
+    if( witness_binary_checksum(block_hashes) != h.checksum ) {
+        throw std::runtime_error("Binary witness: checksum mismatch");
+    }
+
+    libff::leave_block("Load the binary witness");
+}
+
+
+void WitnessBinaryFile::load( ProtoboardT &pb, const libsnark::Config &config ) const
+{
+    if( pb.num_variables() != num_variables() || pb.num_inputs() != num_inputs() ) {
+        throw std::runtime_error("Binary witness: variable counts do not match the circuit");
+    }
+
+    load(pb.values, config);
+}
+
+// namespace ethsnarks
+}
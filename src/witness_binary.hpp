@@ -0,0 +1,106 @@
+#ifndef ETHSNARKS_WITNESS_BINARY_HPP_
+#define ETHSNARKS_WITNESS_BINARY_HPP_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "ethsnarks.hpp"
+#include "prover_config.hpp"
+#include "r1cs_gg_ppzksnark_zok/r1cs_gg_ppzksnark_zok_mmap.hpp"
+
+namespace ethsnarks {
+
+/**
+* Binary witness format
+*
+* The full variable assignment (without the constant one) as fixed size
+* elements, so witness generation and proving can run in separate processes
+* without formatting every value as a decimal string.
+*
+*   header
+*   [values]    num_variables elements of element_size bytes each
+*
+* Elements are either the field element as it is in memory, i.e. in
+* Montgomery form, which loads with a plain copy, or with
+* WITNESS_BINARY_CANONICAL the limbs of its canonical integer value, least
+* significant limb first, which other tools can read without knowing the
+* Montgomery parameters. Limbs are in the byte order of the writer, which is
+* checked on load.
+*
+* The checksum is FNV-1a over the hashes of consecutive blocks of
+* WITNESS_BINARY_CHECKSUM_BLOCK elements, each of those being FNV-1a over
+* the block's 64-bit words, so it can be computed in parallel.
+*/
+
+static const char WITNESS_BINARY_MAGIC[8] = {'E', 'S', 'W', 'I', 'T', 'N', 'S', '\0'};
+static const uint32_t WITNESS_BINARY_VERSION = 1;
+static const uint32_t WITNESS_BINARY_CANONICAL = 1;
+static const size_t WITNESS_BINARY_CHECKSUM_BLOCK = size_t(1) << 15;
+
+struct witness_binary_header
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint32_t element_size;
+    uint32_t flags;
+    uint64_t num_inputs;
+    uint64_t num_variables;
+    uint64_t values_offset;
+    uint64_t checksum;
+};
+
+
+/**
+* Write a full variable assignment, of which the first `num_inputs` are the
+* primary input, returns false on any write error
+*/
+bool write_witness_binary( const std::vector<FieldT> &assignment, size_t num_inputs, const std::string &path,
+                           bool canonical = false, const libsnark::Config &config = libsnark::Config() );
+
+/**
+* Write the witness of the protoboard in the binary format
+*/
+bool witness2binary( const ProtoboardT &pb, const std::string &path, bool canonical = false );
+
+
+/**
+* A witness in the binary format, mapped from disk.
+*
+* Throws `std::runtime_error` if the file cannot be opened or is not a
+* binary witness written by a build with the same field.
+*/
+class WitnessBinaryFile
+{
+public:
+    explicit WitnessBinaryFile( const std::string &path );
+
+    const witness_binary_header &header() const { return *m_header; }
+    size_t num_inputs() const { return m_header->num_inputs; }
+    size_t num_variables() const { return m_header->num_variables; }
+
+    /**
+    * Decode the values into a full variable assignment, in parallel.
+    * Throws `std::runtime_error` if the checksum does not match.
+    */
+    void load( std::vector<FieldT> &assignment, const libsnark::Config &config = libsnark::Config() ) const;
+
+    /**
+    * Load the values into a protoboard which has the circuit's variables
+    * allocated, e.g. from the .arith circuit or a binary R1CS, but no witness
+    */
+    void load( ProtoboardT &pb, const libsnark::Config &config = libsnark::Config() ) const;
+
+private:
+    libsnark::mapped_file m_file;
+    const witness_binary_header *m_header;
+};
+
+
+bool is_witness_binary( const std::string &path );
+
+// namespace ethsnarks
+}
+
+#endif
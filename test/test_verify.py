@@ -26,6 +26,27 @@ class VerifyTests(unittest.TestCase):
         dll_path = native_lib_path('build/src/libethsnarks_verify')
         self.assertTrue(vk.verify(proof, dll_path))
 
+    def test_verify_native_prepared(self):
+        """The key is loaded once, then proofs are passed as bytes"""
+        vk = NativeVerifier.from_dict(VK_STATIC)
+        proof = Proof.from_dict(PROOF_STATIC)
+        dll_path = native_lib_path('build/src/libethsnarks_verify')
+        prepared = vk.prepare(dll_path)
+        self.assertEqual(prepared.num_inputs, len(proof.input))
+        self.assertTrue(prepared.verify(proof))
+        self.assertTrue(vk.prepare(dll_path) is prepared)
+
+        bad_proof = proof._replace(input=[proof.input[0], proof.input[1] + 1])
+        self.assertFalse(prepared.verify(bad_proof))
+
+    def test_verify_native_batch(self):
+        vk = NativeVerifier.from_dict(VK_STATIC)
+        proof = Proof.from_dict(PROOF_STATIC)
+        bad_proof = proof._replace(input=[proof.input[0], proof.input[1] + 1])
+        dll_path = native_lib_path('build/src/libethsnarks_verify')
+        results = vk.verify_batch([proof, bad_proof, proof], dll_path)
+        self.assertEqual(results, [True, False, True])
+
     def test_verify_python(self):
         # Verify using sloooow python implementation
         vk = VerifyingKey.from_dict(VK_STATIC)